@@ -0,0 +1,47 @@
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "StaticRoute.h"
+#include "RouteBackup.h"
+
+StaticRoute::StaticRoute()
+{
+    srand(time(NULL));
+    for (int i = 0;i < 3; ++i)
+        _views[i] = new BackupView();
+}
+
+StaticRoute::~StaticRoute()
+{
+    for (int i = 0;i < 3; ++i)
+        delete (BackupView*)_views[i];
+}
+
+int StaticRoute::getHost(int modid, int cmdid, uint32_t& ip, int& port)
+{
+    //[modid,cmdid]只会被第(modid+cmdid)%3个UDP Server线程落地
+    int index = (modid + cmdid) % 3;
+    BackupView* view = (BackupView*)_views[index];
+    if (!view->mapped())
+    {
+        char path[64];
+        snprintf(path, sizeof path, BACKUP_FILE_PREFIX "%d", index + 1);
+        if (!view->map(path))
+            return -1;
+    }
+    uint64_t key = ((uint64_t)modid << 32) + cmdid;
+    uint32_t count = 0;
+    const BackupHost* hosts = view->find(key, count);
+    if (!hosts || count == 0)
+        return -1;
+    const BackupHost& host = hosts[rand() % count];
+    ip = host.ip;
+    port = host.port;
+    return 0;
+}
+
+void StaticRoute::freeData()
+{
+    for (int i = 0;i < 3; ++i)
+        ((BackupView*)_views[i])->unmap();
+}
@@ -1,26 +1,108 @@
 #include "cacheLayer.h"
-#include <arpa/inet.h>
 
-void CacheUnit::getHost(std::string& ip, int& port)
+void CacheUnit::getHost(uint32_t& ip, int& port)
 {
-    const pair<int, int> host = nodeList.front();
+    //近处的idle节点足够且过载比例不高时只在其中轮询，否则逐级放宽
+    list<pair<int, int> >* idle = &nodeList;
+    for (int t = 0;t < LOCAL_TIERS; ++t)
+    {
+        size_t n = localList[t].size();
+        if (n && (int)n >= localMin && n * 100 >= (size_t)localHosts[t] * spillPct)
+        {
+            idle = &localList[t];
+            break;
+        }
+    }
+    const pair<int, int> host = idle->front();
+    ip = host.first;
     port = host.second;
     //add to tail
-    nodeList.pop_front();
-    nodeList.push_back(host);
-    struct in_addr saddr;
-    saddr.s_addr = host.first;
-    ip = ::inet_ntoa(saddr);
+    idle->pop_front();
+    idle->push_back(host);
 }
 
-void CacheUnit::report(int ip, int port)
+int CacheUnit::getHostByState(uint32_t& ip, int& port)
+{
+    //与agent的调度一致：每probeNum次获取试探一次overload节点
+    if (probeNum > 0 && !downList.empty() && ++accessCnt >= probeNum)
+    {
+        accessCnt = 0;
+        const pair<int, int> host = downList.front();
+        ip = host.first;
+        port = host.second;
+        downList.pop_front();
+        downList.push_back(host);
+        return 0;
+    }
+    if (nodeList.empty())
+        return -10000;
+    getHost(ip, port);
+    return 0;
+}
+
+//跳过overload节点
+struct IdleNode
+{
+    IdleNode(const hash_set<uint64_t>& downs, const vector<uint64_t>& hosts): _downs(downs), _hosts(hosts) { }
+    bool operator()(int idx) const { return _downs.find(_hosts[idx]) == _downs.end(); }
+    const hash_set<uint64_t>& _downs;
+    const vector<uint64_t>& _hosts;
+};
+
+int CacheUnit::getHostByKey(uint64_t key, uint32_t& ip, int& port)
+{
+    if (nodeList.empty())
+        return getHostByState(ip, port);
+    if (!chash.built() || chash.policy() != hashPolicy || chash.param() != hashParam)
+    {
+        //全部节点：idle节点加上overload节点
+        vector<uint64_t> hosts;
+        for (list<pair<int, int> >::iterator it = nodeList.begin();it != nodeList.end(); ++it)
+            hosts.push_back(((uint64_t)it->first << 32) + it->second);
+        for (list<pair<int, int> >::iterator it = downList.begin();it != downList.end(); ++it)
+            hosts.push_back(((uint64_t)it->first << 32) + it->second);
+        chash.build(hashPolicy, hashParam, hosts);
+    }
+    IdleNode usable(downSet, chash.hosts());
+    int primary;
+    int idx = chash.pick(key, usable, primary);
+    if (idx != primary)
+    {
+        //与agent一致：首选节点overload时每probeNum次试探它一次
+        if (probeNum > 0 && ++accessCnt >= probeNum)
+        {
+            accessCnt = 0;
+            idx = primary;
+        }
+    }
+    uint64_t host = chash.hosts()[idx];
+    ip = (uint32_t)(host >> 32);
+    port = (int)(host & 0xffffffff);
+    return 0;
+}
+
+bool CacheUnit::report(int ip, int port, uint32_t tcost)
 {
     uint64_t key = ((uint64_t)ip << 32) + port;
-    if (succAccum.find(key) != succAccum.end())
+    hash_map<uint64_t, uint32_t>::iterator it = succAccum.find(key);
+    if (it == succAccum.end())
+        return false;
+    it->second += 1;
+    succCnt++;
+    if (tcost)
     {
-        succAccum[key] += 1;
-        succCnt++;
+        pair<uint64_t, uint32_t>& cost = costAccum[key];
+        cost.first += tcost;
+        cost.second++;
     }
+    return true;
+}
+
+CacheLayer::~CacheLayer()
+{
+    hash_map<uint64_t, CacheUnit*>::iterator it;
+    for (it = _cache.begin();it != _cache.end(); ++it)
+        delete it->second;
 }
 
 void CacheLayer::getAll(vector<CacheUnit*>& all)
@@ -5,37 +5,77 @@
 #include <string>
 #include <stdint.h>
 #include <ext/hash_map>
+#include <ext/hash_set>
+#include "consistentHash.h"
 
 using std::pair;
 using std::list;
 using std::vector;
 using std::string;
 using __gnu_cxx::hash_map;
+using __gnu_cxx::hash_set;
+
+#define LOCAL_TIERS 2//节点相对agent的位置：0同机架，1同机房，其余为其他
 
 //cache unit
 struct CacheUnit
 {
-    CacheUnit() { }
-    //get host
-    void getHost(string& ip, int& port);
-    //report 0 in cache for host[ip:port]
-    void report(int ip, int port);
+    CacheUnit(): pushSeq(0), succCnt(0), lstRptMs(0), probeNum(-1), accessCnt(0), hashPolicy(HASH_NONE), hashParam(0), localMin(0), spillPct(0)
+    {
+        for (int t = 0;t < LOCAL_TIERS; ++t)
+            localHosts[t] = 0;
+    }
+    //get host, ip为网络序；agent给出了节点位置时与agent一样优先同机架、同机房的idle节点
+    void getHost(uint32_t& ip, int& port);
+    //有overload节点时按agent给出的节点状态获取：每probeNum次试探一个overload节点，其余在idle节点中轮询
+    //idle节点为空且未到试探时返回-10000（过载）
+    int getHostByState(uint32_t& ip, int& port);
+    //按key做一致性哈希选取节点，与agent的建表方式一致：首选节点overload时顺延到下一个idle节点，每probeNum次试探首选节点
+    //节点全部overload时同getHostByState
+    int getHostByKey(uint64_t key, uint32_t& ip, int& port);
+    //report 0 in cache for host[ip:port]；节点不在路由中则返回false
+    //tcost: 调用耗时(ms)，0表示不知道耗时，不计入耗时统计
+    bool report(int ip, int port, uint32_t tcost);
 
     int modid;
     int cmdid;
     bool overload;
-    long lstUpdTs;
+    long lstUpdTs;//上次更新时刻，单调时钟,秒
+    long lstUseTs;//共享的路由快照：上次被线程同步的时刻，单调时钟,秒
+    bool pushed;//共享的路由快照：agent已接受订阅，变化会推送过来
+    uint32_t pushSeq;//共享的路由快照：已收到的agent推送序号
+    uint32_t syncGen;//线程的缓存条目：上次同步时的快照generation
     long version;
     uint64_t succCnt;
+    uint64_t lstRptMs;//上次批量上报的时刻，单调时钟,毫秒
 
+    //共享的路由快照：全部节点；线程的缓存条目：idle节点
     list<pair<int, int> > nodeList;
+    list<pair<int, int> > downList;//overload节点
+    int probeNum;//agent给出的试探周期，0表示agent主动探测、API不试探；-1表示agent未提供节点状态
+    int accessCnt;//距上次试探获取了几次节点
+    int hashPolicy;//agent给出的按key获取节点的策略(HASH_POLICY)，HASH_NONE表示不按key选取
+    int hashParam;
+    //线程的缓存条目：overload节点集合，及按key获取时建立的一致性哈希表（路由变化时清空）
+    hash_set<uint64_t> downSet;
+    ConsistentHash chash;
+    //共享的路由快照：agent给出的节点位置（只记录同机架、同机房的节点）及放宽条件；线程的缓存条目：按位置划分的idle节点
+    hash_map<uint64_t, int> localities;
+    int localMin;
+    int spillPct;
+    list<pair<int, int> > localList[LOCAL_TIERS];//位置不远于t的idle节点
+    uint32_t localHosts[LOCAL_TIERS];//位置不远于t的全部节点个数
     //key => success accumulator
     hash_map<uint64_t, uint32_t> succAccum;
+    //key => 知道耗时的成功调用的耗时之和(ms)、个数，随批量上报一起清空
+    hash_map<uint64_t, pair<uint64_t, uint32_t> > costAccum;
 };
 
 struct CacheLayer
 {
 public:
+    ~CacheLayer();
+
     CacheUnit* getCache(int modid, int cmdid);
 
     void addCache(int modid, int cmdid, CacheUnit* item);
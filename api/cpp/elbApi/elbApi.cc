@@ -1,27 +1,150 @@
 #include <time.h>
 #include <stdio.h>
+#include <errno.h>
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <unistd.h>
 #include <strings.h>
 #include <arpa/inet.h>
+#include <poll.h>
 #include <sys/time.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/eventfd.h>
 #include <netinet/in.h>
 #include "easy_reactor.h"
 #include "elbApi.h"
 #include "elb.pb.h"
 #include "HeartBeat.h"
+#include "fixedWire.h"
+#include "coarseClock.h"
 
-inline uint64_t getCurrMills()
+//共享路由快照的刷新周期，也是各线程缓存条目与快照同步、批量上报成功调用的周期，秒
+#define ROUTE_REFRESH_SEC 2
+//共享路由快照多久没有线程使用就不再刷新，秒
+#define ROUTE_IDLE_SEC 300
+//agent接受了订阅、会推送变化的快照，多久续订（同时校验）一次，秒；推送丢失且之后没有新的推送时，快照至多过时这么久
+//快照中有overload节点时节点状态变化频繁，仍按ROUTE_REFRESH_SEC续订
+#define ROUTE_PUSHED_REFRESH_SEC 10
+//mod有节点过载时，暂存的成功调用攒够此个数或此毫秒数即批量上报
+#define OVERLOAD_BATCH_CNT 64
+#define OVERLOAD_BATCH_MSEC 20
+//后台线程没有待补报的暂存时，等待订阅socket的最长时间，毫秒
+#define REFRESH_POLL_MSEC 100
+//编码协商未得到agent应答（如agent一时繁忙）时，先用protobuf，隔多久再协商，秒
+#define WIRE_RENEGO_SEC 10
+//seq的高位是线程的seq空间：同时存活的线程超过(1 << SEQ_SPACE_BITS)个才会有两个线程共用一个空间；线程退出后其空间回收复用
+#define SEQ_SPACE_BITS 12
+#define SEQ_COUNTER_MASK ((1u << (32 - SEQ_SPACE_BITS)) - 1)
+
+//每个线程私有的状态
+struct ThreadCtx
 {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return (uint64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+    //firstSeq: 线程seq空间的起始seq；复用已退出线程的seq空间时接着它的下一个seq，避免与其迟到的应答重复
+    ThreadCtx(elbClient* client, uint32_t firstSeq):
+        owner(client),
+        seqid(firstSeq),
+        agentOff(false),
+        tsget(0) {
+            ::pthread_mutex_init(&batchMutex, NULL);
+        }
+
+    ~ThreadCtx() { ::pthread_mutex_destroy(&batchMutex); }
+
+    //本线程的下一个seq：高SEQ_SPACE_BITS位是线程的seq空间，其余位自增
+    uint32_t nextSeq()
+    {
+        uint32_t seq = seqid;
+        seqid = (seqid & ~SEQ_COUNTER_MASK) | ((seqid + 1) & SEQ_COUNTER_MASK);
+        return seq;
+    }
+
+    elbClient* owner;
+    uint32_t seqid;
+    bool agentOff;
+    uint64_t tsget;//本线程最近一次获取到节点的时间戳，单调时钟,毫秒；只供字符串接口的上报使用
+    CacheLayer cache;//本线程的缓存条目：轮询位置与成功调用暂存
+    //保护缓存条目的增删与成功调用暂存：后台线程会补报本线程到时未报的暂存；获取节点只读节点列表，不加锁
+    pthread_mutex_t batchMutex;
+};
+
+//用agent给出的节点状态（CacheGetRouteRsp或CacheRouteNotify）更新路由快照，返回是否有变化；调用者持有_routeMutex
+template <typename Msg>
+static bool applyHostState(CacheUnit* cacheItem, const Msg& msg)
+{
+    list<pair<int, int> > downs;
+    //老agent不提供节点状态，有节点过载时只能整个mod走网络
+    int probeNum = msg.has_probenum()? msg.probenum(): -1;
+    for (int i = 0;i < msg.downs_size(); ++i)
+        downs.push_back(pair<int, int>(msg.downs(i).ip(), msg.downs(i).port()));
+    bool changed = cacheItem->overload != msg.overload() || cacheItem->probeNum != probeNum ||
+        cacheItem->downList != downs;
+    cacheItem->overload = msg.overload();
+    cacheItem->probeNum = probeNum;
+    cacheItem->downList.swap(downs);
+    return changed;
+}
+
+//用agent的应答更新路由快照，返回快照是否有变化（增删、版本或节点状态）；调用者持有_routeMutex
+static bool applyRoute(CacheLayer& routes, const elb::CacheGetRouteRsp& rsp, long ts)
+{
+    int modid = rsp.modid(), cmdid = rsp.cmdid();
+    CacheUnit* cacheItem = routes.getCache(modid, cmdid);
+    if (rsp.version() == -1)
+    {
+        //如果agent端此mod路由为空，则删除本地cache（如果有的话）
+        if (!cacheItem)
+            return false;
+        routes.rmCache(modid, cmdid);
+        return true;
+    }
+    bool changed = !cacheItem || cacheItem->version != rsp.version();
+    if (!cacheItem || rsp.version() != cacheItem->version)
+    {
+        //如果本地缓存不存在此mod，或者版本号与agent上此mod不同则更新本地路由
+        if (!cacheItem)
+        {
+            cacheItem = new CacheUnit();
+            if (!cacheItem)
+                ::exit(1);
+            //添加cacheItem到本地缓存
+            cacheItem->modid = modid;
+            cacheItem->cmdid = cmdid;
+            cacheItem->lstUseTs = ts;
+            routes.addCache(modid, cmdid, cacheItem);
+        }
+        cacheItem->version = rsp.version();
+        cacheItem->nodeList.clear();
+        cacheItem->localities.clear();
+        //添加路由信息
+        for (int i = 0;i < rsp.route_size(); ++i)
+        {
+            const elb::HostAddr& ha = rsp.route(i);
+            cacheItem->nodeList.push_back(pair<int, int>(ha.ip(), ha.port()));
+            //节点位置与route一一对应，老agent或未配置[locality]时不带
+            if (rsp.localities_size() == rsp.route_size() && rsp.localities(i) < LOCAL_TIERS)
+                cacheItem->localities[((uint64_t)ha.ip() << 32) + ha.port()] = rsp.localities(i);
+        }
+        cacheItem->localMin = rsp.localmin();
+        cacheItem->spillPct = rsp.spillpct();
+    }
+    if (applyHostState(cacheItem, rsp))
+        changed = true;
+    if (cacheItem->hashPolicy != rsp.hashpolicy() || cacheItem->hashParam != rsp.hashparam())
+    {
+        cacheItem->hashPolicy = rsp.hashpolicy();
+        cacheItem->hashParam = rsp.hashparam();
+        changed = true;
+    }
+    cacheItem->pushed = rsp.pushed();
+    if (rsp.has_pushseq())
+        cacheItem->pushSeq = rsp.pushseq();
+    cacheItem->lstUpdTs = ts;
+    return changed;
 }
 
-elbClient::elbClient(): _seqid(0), _tsget(0)
+elbClient::elbClient(): _staticUsed(false), _routeGen(0), _wireVer(-1), _wireRetryTs(0), _batchDue(0), _nextSeqSpace(0), _stop(false)
 {
     struct sockaddr_in servaddr;
     ::bzero(&servaddr, sizeof (servaddr));
@@ -43,6 +166,24 @@ elbClient::elbClient(): _seqid(0), _tsget(0)
             perror("connect()");
             ::exit(1);
         }
+        //后台线程专用：刷新路由、接收agent推送的订阅通知
+        _subfd[i] = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_UDP);
+        if (_subfd[i] == -1 || ::connect(_subfd[i], (const struct sockaddr*)&servaddr, sizeof servaddr) == -1)
+        {
+            perror("subscribe socket");
+            ::exit(1);
+        }
+        struct sockaddr_in local;
+        socklen_t len = sizeof local;
+        ::getsockname(_subfd[i], (struct sockaddr*)&local, &len);
+        _subPort[i] = ntohs(local.sin_port);
+    }
+    //有线程暂存了待补报的结果时唤醒后台线程
+    _wakefd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_wakefd == -1)
+    {
+        perror("eventfd()");
+        ::exit(1);
     }
     _hb = new HeartBeat();
     if (!_hb)
@@ -50,85 +191,524 @@ elbClient::elbClient(): _seqid(0), _tsget(0)
         fprintf(stderr, "no space to new HeartBeat\n");
         ::exit(1);
     }
+    for (int i = 0;i < 3; ++i)
+        ::pthread_mutex_init(&_sockMutex[i], NULL);
+    ::pthread_mutex_init(&_staticMutex, NULL);
+    ::pthread_mutex_init(&_routeMutex, NULL);
+    ::pthread_mutex_init(&_ctxMutex, NULL);
+    if (::pthread_key_create(&_ctxKey, releaseCtx))
+    {
+        fprintf(stderr, "pthread_key_create error\n");
+        ::exit(1);
+    }
+    if (::pthread_create(&_refresher, NULL, refreshMain, this))
+    {
+        fprintf(stderr, "pthread_create error\n");
+        ::exit(1);
+    }
 }
 
 elbClient::~elbClient()
 {
-    vector<CacheUnit*> all;
-    vector<CacheUnit*>::iterator it;
-    _cacheLayer.getAll(all);
-    for (it = all.begin();it != all.end(); ++it)
+    _stop = true;
+    ::pthread_join(_refresher, NULL);
+    ::pthread_key_delete(_ctxKey);
+    //上报各线程暂存的成功调用
+    for (size_t i = 0;i < _ctxs.size(); ++i)
     {
-        CacheUnit* cu = *it;
-        batchReportRes(cu);
+        vector<CacheUnit*> all;
+        _ctxs[i]->cache.getAll(all);
+        for (vector<CacheUnit*>::iterator it = all.begin();it != all.end(); ++it)
+            batchReportRes(*it);
+        delete _ctxs[i];
     }
+    _ctxs.clear();
     for (int i = 0;i < 3; ++i)
+    {
         ::close(_sockfd[i]);
+        ::close(_subfd[i]);
+        ::pthread_mutex_destroy(&_sockMutex[i]);
+    }
+    ::close(_wakefd);
+    ::pthread_mutex_destroy(&_staticMutex);
+    ::pthread_mutex_destroy(&_routeMutex);
+    ::pthread_mutex_destroy(&_ctxMutex);
     delete (HeartBeat*)_hb;
 }
 
+ThreadCtx* elbClient::threadCtx()
+{
+    ThreadCtx* ctx = (ThreadCtx*)::pthread_getspecific(_ctxKey);
+    if (!ctx)
+    {
+        ::pthread_mutex_lock(&_ctxMutex);
+        uint32_t firstSeq;
+        if (!_freeSeqs.empty())
+        {
+            firstSeq = _freeSeqs.back();
+            _freeSeqs.pop_back();
+        }
+        else
+            firstSeq = (_nextSeqSpace++ % (1u << SEQ_SPACE_BITS)) << (32 - SEQ_SPACE_BITS);
+        ctx = new ThreadCtx(this, firstSeq);
+        _ctxs.push_back(ctx);
+        ::pthread_mutex_unlock(&_ctxMutex);
+        ::pthread_setspecific(_ctxKey, ctx);
+    }
+    return ctx;
+}
+
+void elbClient::releaseCtx(void* ctx)
+{
+    ThreadCtx* tc = (ThreadCtx*)ctx;
+    tc->owner->dropCtx(tc);
+}
+
+void elbClient::dropCtx(ThreadCtx* ctx)
+{
+    vector<CacheUnit*> all;
+    ::pthread_mutex_lock(&ctx->batchMutex);
+    ctx->cache.getAll(all);
+    for (vector<CacheUnit*>::iterator it = all.begin();it != all.end(); ++it)
+        batchReportRes(*it);
+    ::pthread_mutex_unlock(&ctx->batchMutex);
+    ::pthread_mutex_lock(&_ctxMutex);
+    for (size_t i = 0;i < _ctxs.size(); ++i)
+    {
+        if (_ctxs[i] == ctx)
+        {
+            _ctxs[i] = _ctxs.back();
+            _ctxs.pop_back();
+            break;
+        }
+    }
+    //回收此线程的seq空间
+    _freeSeqs.push_back(ctx->seqid);
+    ::pthread_mutex_unlock(&_ctxMutex);
+    delete ctx;
+}
+
+void elbHost::toSockaddr(struct sockaddr_in& addr) const
+{
+    ::bzero(&addr, sizeof addr);
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = ip;
+    addr.sin_port = htons(port);
+}
+
+std::string elbHost::ipStr() const
+{
+    struct in_addr inaddr;
+    inaddr.s_addr = ip;
+    char buf[INET_ADDRSTRLEN];
+    ::inet_ntop(AF_INET, &inaddr, buf, sizeof buf);
+    return buf;
+}
+
 int elbClient::apiGetHost(int modid, int cmdid, int timo, std::string& ip, int& port)
 {
+    elbHost host;
+    int ret = apiGetHost(modid, cmdid, timo, host);
+    if (ret == 0)
+    {
+        ip = host.ipStr();
+        port = host.port;
+    }
+    return ret;
+}
+
+int elbClient::apiGetHost(int modid, int cmdid, int timo, elbHost& host)
+{
+    return getHostImpl(modid, cmdid, timo, false, 0, host);
+}
+
+int elbClient::apiGetHostByKey(int modid, int cmdid, uint64_t key, int timo, elbHost& host)
+{
+    return getHostImpl(modid, cmdid, timo, true, key, host);
+}
+
+int elbClient::apiGetHostByKey(int modid, int cmdid, const std::string& key, int timo, elbHost& host)
+{
+    return getHostImpl(modid, cmdid, timo, true, hashKey(key.data(), key.size()), host);
+}
+
+int elbClient::getHostImpl(int modid, int cmdid, int timo, bool byKey, uint64_t key, elbHost& host)
+{
+    ThreadCtx* ctx = threadCtx();
     if (((HeartBeat*)_hb)->die())
     {
-        _agentOff = true;
-        int ret = _staticRoute.getHost(modid, cmdid, ip, port);
+        ctx->agentOff = true;
+        //agent重启后可能换了版本，需要重新协商编码方式
+        setWireVer(-1);
+        ::pthread_mutex_lock(&_staticMutex);
+        _staticUsed = true;
+        //静态路由不按key选取
+        int ret = _staticRoute.getHost(modid, cmdid, host.ip, host.port);
+        ::pthread_mutex_unlock(&_staticMutex);
         if (ret == -1)
         {
             fprintf(stderr, "[%d,%d] is not exist!\n", modid, cmdid);
             return -9998;// = lbagent's NOEXIST
         }
+        host.tsget = ctx->tsget = MONO_MSEC();
         return 0;
     }
-    _agentOff = false;
-    _staticRoute.freeData();
+    ctx->agentOff = false;
+    if (_staticUsed)
+    {
+        ::pthread_mutex_lock(&_staticMutex);
+        _staticRoute.freeData();
+        _staticUsed = false;
+        ::pthread_mutex_unlock(&_staticMutex);
+    }
     //get host from cache
-    long currTs = time(NULL);
-    CacheUnit* cacheItem = _cacheLayer.getCache(modid, cmdid);
+    long currTs = MONO_SEC();
+    CacheUnit* cacheItem = ctx->cache.getCache(modid, cmdid);
 
-    //此mod不在缓存中，则向agent获取
-    if (!cacheItem)
+    //此mod不在本线程缓存中，或上次同步是ROUTE_REFRESH_SEC前，或有快照发生了变化，则从共享的路由快照同步（只是内存拷贝，快照由后台线程刷新）
+    //顺便先把暂存的上报信息报上去（如果有的话）
+    if (!cacheItem || currTs - cacheItem->lstUpdTs >= ROUTE_REFRESH_SEC || cacheItem->syncGen != _routeGen)
     {
-        int ret = getRoute4Cache(modid, cmdid, currTs);
-        if (ret) return ret;
-        //从缓存中获取刚拉到的此mod条目
-        cacheItem = _cacheLayer.getCache(modid, cmdid);
+        bool first = !cacheItem;
+        if (cacheItem)
+        {
+            ::pthread_mutex_lock(&ctx->batchMutex);
+            batchReportRes(cacheItem);
+            ::pthread_mutex_unlock(&ctx->batchMutex);
+        }
+        int ret = syncRoute(ctx, modid, cmdid, currTs);
+        if (first && ret)
+            return ret;
+        //从缓存中获取刚同步的此mod条目
+        cacheItem = ctx->cache.getCache(modid, cmdid);
     }
     if (!cacheItem)
     {
         //说明agent端不存在此mod，返回不存在错误
         return -9998;
     }
-    //检查此mod的缓存条目是否超时：
-    //如果上次更新是2s前，则重拉取一次
-    //顺便先把暂存的上报信息报上去（如果有的话）
-    if (currTs - cacheItem->lstUpdTs >= 2)
-    {
-        batchReportRes(cacheItem);
-        getRoute4Cache(modid, cmdid, currTs);
-        //从缓存中获取刚拉到的此mod条目
-        cacheItem = _cacheLayer.getCache(modid, cmdid);
-    }
-    if (!cacheItem)
+
+    //按key获取：agent给出了策略，且（没有overload节点或给出了各节点状态）时在本地按同样的哈希表选取
+    if (byKey && cacheItem->hashPolicy != HASH_NONE && (!cacheItem->overload || cacheItem->probeNum >= 0))
     {
-        //说明agent端已经不存在此mod了，返回不存在错误
-        return -9998;
+        int ret = cacheItem->getHostByKey(key, host.ip, host.port);
+        if (ret == 0)
+            host.tsget = ctx->tsget = MONO_MSEC();
+        return ret;
     }
-
-    //如果此mod在API端没有overload节点，则从缓存中获取节点，否则走网络
+    //如果此mod在API端没有overload节点，则从缓存中获取节点
     if (!cacheItem->overload)
     {
-        cacheItem->getHost(ip, port);
-        _tsget = getCurrMills();
+        cacheItem->getHost(host.ip, host.port);
+        host.tsget = ctx->tsget = MONO_MSEC();
         return 0;
     }
+    //有overload节点，但agent给出了各节点状态：在idle节点中轮询，按agent的试探周期试探overload节点
+    if (cacheItem->probeNum >= 0)
+    {
+        int ret = cacheItem->getHostByState(host.ip, host.port);
+        if (ret == 0)
+            host.tsget = ctx->tsget = MONO_MSEC();
+        return ret;
+    }
 
     //get host from local network
-    uint32_t seq = _seqid++;
+    int index = (modid + cmdid) % 3;
+    ::pthread_mutex_lock(&_sockMutex[index]);
+    if (wireVer() < 0)
+        negotiateWire(index);
+    int ret;
+    int wire = wireVer();
+    //按key获取需要定长编码版本2，否则用protobuf带上key
+    if (wire > 0 && (!byKey || wire >= 2))
+        ret = getHostFixed(ctx, modid, cmdid, timo, byKey, key, host);
+    else
+        ret = getHostProto(ctx, modid, cmdid, timo, byKey, key, host);
+    ::pthread_mutex_unlock(&_sockMutex[index]);
+    if (ret == 0)
+        host.tsget = ctx->tsget = MONO_MSEC();
+    return ret;
+}
+
+int elbClient::syncRoute(ThreadCtx* ctx, int modid, int cmdid, long ts)
+{
+    int ret = 0;
+    ::pthread_mutex_lock(&_routeMutex);
+    uint32_t gen = _routeGen;
+    CacheUnit* shared = _routes.getCache(modid, cmdid);
+    if (!shared)
+    {
+        //还没有此mod的快照，只能由本线程向agent获取；已有快照时由后台线程负责刷新，请求路径不等待agent
+        ::pthread_mutex_unlock(&_routeMutex);
+        ret = getRoute4Cache(modid, cmdid, ts);
+        ::pthread_mutex_lock(&_routeMutex);
+        gen = _routeGen;
+        shared = _routes.getCache(modid, cmdid);
+    }
+    ::pthread_mutex_lock(&ctx->batchMutex);
+    CacheUnit* local = ctx->cache.getCache(modid, cmdid);
+    if (!shared)
+    {
+        //agent端不存在此mod
+        if (local)
+            ctx->cache.rmCache(modid, cmdid);
+    }
+    else
+    {
+        bool routeChanged = !local || local->version != shared->version;
+        if (!local)
+        {
+            local = new CacheUnit();
+            if (!local)
+                ::exit(1);
+            local->modid = modid;
+            local->cmdid = cmdid;
+            ctx->cache.addCache(modid, cmdid, local);
+        }
+        if (routeChanged)
+        {
+            //路由有变化，重建成功调用暂存（含overload节点，试探的结果也可能暂存）
+            local->succCnt = 0;
+            local->succAccum.clear();
+            local->costAccum.clear();
+            for (list<pair<int, int> >::iterator it = shared->nodeList.begin();it != shared->nodeList.end(); ++it)
+                local->succAccum[((uint64_t)it->first << 32) + it->second] = 0;
+            //节点集合变化，下次按key获取时重建一致性哈希表
+            local->chash.clear();
+        }
+        if (routeChanged || local->downList != shared->downList)
+        {
+            //本线程只在idle节点中轮询：复制节点列表并去掉overload节点，同时按节点位置划分
+            hash_set<uint64_t> downs;
+            for (list<pair<int, int> >::iterator it = shared->downList.begin();it != shared->downList.end(); ++it)
+                downs.insert(((uint64_t)it->first << 32) + it->second);
+            local->nodeList.clear();
+            for (int t = 0;t < LOCAL_TIERS; ++t)
+            {
+                local->localList[t].clear();
+                local->localHosts[t] = 0;
+            }
+            for (list<pair<int, int> >::iterator it = shared->nodeList.begin();it != shared->nodeList.end(); ++it)
+            {
+                uint64_t key = ((uint64_t)it->first << 32) + it->second;
+                bool idle = downs.find(key) == downs.end();
+                if (idle)
+                    local->nodeList.push_back(*it);
+                hash_map<uint64_t, int>::iterator lt = shared->localities.find(key);
+                for (int t = lt == shared->localities.end()? LOCAL_TIERS: lt->second;t < LOCAL_TIERS; ++t)
+                {
+                    ++local->localHosts[t];
+                    if (idle)
+                        local->localList[t].push_back(*it);
+                }
+            }
+            local->localMin = shared->localMin;
+            local->spillPct = shared->spillPct;
+            local->downList = shared->downList;
+            local->downSet.swap(downs);
+        }
+        local->overload = shared->overload;
+        local->probeNum = shared->probeNum;
+        local->hashPolicy = shared->hashPolicy;
+        local->hashParam = shared->hashParam;
+        local->version = shared->version;
+        local->lstUpdTs = ts;
+        local->syncGen = gen;
+        shared->lstUseTs = ts;
+    }
+    ::pthread_mutex_unlock(&ctx->batchMutex);
+    ::pthread_mutex_unlock(&_routeMutex);
+    return ret;
+}
+
+void* elbClient::refreshMain(void* args)
+{
+    elbClient* client = (elbClient*)args;
+    struct pollfd fds[4];
+    for (int i = 0;i < 3; ++i)
+    {
+        fds[i].fd = client->_subfd[i];
+        fds[i].events = POLLIN;
+    }
+    fds[3].fd = client->_wakefd;
+    fds[3].events = POLLIN;
+    long lstRefresh = 0;
+    while (!client->_stop)
+    {
+        //最多等REFRESH_POLL_MSEC，析构时能及时退出；有过载mod的暂存待补报时按OVERLOAD_BATCH_MSEC醒来
+        int timo = __atomic_load_n(&client->_batchDue, __ATOMIC_ACQUIRE)? OVERLOAD_BATCH_MSEC: REFRESH_POLL_MSEC;
+        int n = ::poll(fds, 4, timo);
+        for (int i = 0;i < 3 && n > 0; ++i)
+        {
+            if (fds[i].revents & POLLIN)
+                client->recvSubscribed(i);
+        }
+        if (n > 0 && (fds[3].revents & POLLIN))
+        {
+            uint64_t cnt;
+            if (::read(client->_wakefd, &cnt, sizeof cnt) == -1 && errno != EAGAIN)
+                perror("read eventfd");
+        }
+        long ts = MONO_SEC();
+        if (ts != lstRefresh)
+        {
+            lstRefresh = ts;
+            client->refreshRoutes(ts);
+        }
+        if (__atomic_load_n(&client->_batchDue, __ATOMIC_ACQUIRE))
+            client->flushOverdue();
+    }
+    return NULL;
+}
+
+void elbClient::flushOverdue()
+{
+    //先清标志再检查：检查期间新暂存的线程会重新置上
+    __atomic_store_n(&_batchDue, 0, __ATOMIC_RELEASE);
+    bool due = false;
+    uint64_t nowMs = MONO_MSEC();
+    ::pthread_mutex_lock(&_ctxMutex);
+    for (size_t i = 0;i < _ctxs.size(); ++i)
+    {
+        ThreadCtx* ctx = _ctxs[i];
+        vector<CacheUnit*> all;
+        ::pthread_mutex_lock(&ctx->batchMutex);
+        ctx->cache.getAll(all);
+        for (vector<CacheUnit*>::iterator it = all.begin();it != all.end(); ++it)
+        {
+            CacheUnit* item = *it;
+            if (!item->overload || !item->succCnt)
+                continue;
+            if (nowMs - item->lstRptMs >= OVERLOAD_BATCH_MSEC)
+                batchReportRes(item);
+            else
+                due = true;
+        }
+        ::pthread_mutex_unlock(&ctx->batchMutex);
+    }
+    ::pthread_mutex_unlock(&_ctxMutex);
+    if (due)
+        __atomic_store_n(&_batchDue, 1, __ATOMIC_RELEASE);
+}
+
+void elbClient::refreshRoutes(long ts)
+{
+    //agent宕机期间走静态路由，不刷新
+    if (((HeartBeat*)_hb)->die())
+        return ;
+    //上次协商没有得到应答，到时后让下一次走网络的请求重新协商
+    long retryTs = __atomic_load_n(&_wireRetryTs, __ATOMIC_ACQUIRE);
+    if (retryTs && ts >= retryTs && wireVer() == 0)
+    {
+        __atomic_store_n(&_wireRetryTs, 0, __ATOMIC_RELEASE);
+        setWireVer(-1);
+    }
+    vector<CacheUnit*> all;
+    vector<pair<uint64_t, long> > mods;//modid << 32 + cmdid, version
+    ::pthread_mutex_lock(&_routeMutex);
+    _routes.getAll(all);
+    for (vector<CacheUnit*>::iterator it = all.begin();it != all.end(); ++it)
+    {
+        CacheUnit* item = *it;
+        //订阅成功且没有overload节点的mod由agent推送变化，只需偶尔续订；否则按原周期轮询
+        long period = item->pushed && !item->overload? ROUTE_PUSHED_REFRESH_SEC: ROUTE_REFRESH_SEC;
+        //长期没有线程使用的mod不再刷新，再被使用时重新获取
+        if (ts - item->lstUseTs >= ROUTE_IDLE_SEC)
+        {
+            _routes.rmCache(item->modid, item->cmdid);
+        }
+        else if (ts - item->lstUpdTs >= period)
+        {
+            mods.push_back(pair<uint64_t, long>(((uint64_t)item->modid << 32) + item->cmdid, item->version));
+        }
+    }
+    ::pthread_mutex_unlock(&_routeMutex);
+    for (size_t i = 0;i < mods.size(); ++i)
+        subscribeRoute((int)(mods[i].first >> 32), (int)(mods[i].first & 0xffffffff), mods[i].second);
+}
+
+void elbClient::subscribeRoute(int modid, int cmdid, long version)
+{
+    //从订阅socket发出，应答与之后的推送都由后台线程异步接收，不等待
+    int index = (modid + cmdid) % 3;
+    elb::CacheGetRouteReq req;
+    req.set_modid(modid);
+    req.set_cmdid(cmdid);
+    req.set_version(version);
+    req.set_subport(_subPort[index]);
+    char wbuf[4096];
+    commu_head head;
+    head.length = req.ByteSize();
+    head.cmdid = elb::CacheGetRouteReqId;
+    ::memcpy(wbuf, &head, COMMU_HEAD_LENGTH);
+    req.SerializeToArray(wbuf + COMMU_HEAD_LENGTH, head.length);
+    int ret = ::sendto(_subfd[index], wbuf, head.length + COMMU_HEAD_LENGTH, 0, NULL, 0);
+    if (ret == -1)
+        perror("sendto()");
+}
+
+void elbClient::recvSubscribed(int index)
+{
+    char rbuf[81920];
+    int pkgLen;
+    while ((pkgLen = ::recv(_subfd[index], rbuf, sizeof rbuf, 0)) >= COMMU_HEAD_LENGTH)
+    {
+        commu_head head;
+        ::memcpy(&head, rbuf, COMMU_HEAD_LENGTH);
+        long ts = MONO_SEC();
+        if (head.cmdid == elb::CacheGetRouteRspId)
+        {
+            elb::CacheGetRouteRsp rsp;
+            if (!rsp.ParseFromArray(rbuf + COMMU_HEAD_LENGTH, pkgLen - COMMU_HEAD_LENGTH))
+                continue;
+            ::pthread_mutex_lock(&_routeMutex);
+            if (applyRoute(_routes, rsp, ts))
+                ++_routeGen;
+            ::pthread_mutex_unlock(&_routeMutex);
+        }
+        else if (head.cmdid == elb::CacheRouteNotifyId)
+        {
+            elb::CacheRouteNotify notify;
+            if (!notify.ParseFromArray(rbuf + COMMU_HEAD_LENGTH, pkgLen - COMMU_HEAD_LENGTH))
+                continue;
+            int modid = notify.modid(), cmdid = notify.cmdid();
+            long version = -1;
+            ::pthread_mutex_lock(&_routeMutex);
+            CacheUnit* item = _routes.getCache(modid, cmdid);
+            if (item && notify.version() == -1)
+            {
+                _routes.rmCache(modid, cmdid);
+                ++_routeGen;
+            }
+            else if (item)
+            {
+                //推送序号不连续，说明中间的推送丢失了：立即重新获取，不等到续订
+                bool lost = notify.has_pushseq() && notify.pushseq() != item->pushSeq + 1;
+                if (notify.has_pushseq())
+                    item->pushSeq = notify.pushseq();
+                //节点状态立即生效；版本变化时还需获取新路由，收到应答前沿用旧节点列表
+                if (applyHostState(item, notify))
+                    ++_routeGen;
+                if (item->version != notify.version() || lost)
+                    version = item->version;
+            }
+            ::pthread_mutex_unlock(&_routeMutex);
+            if (version != -1)
+                subscribeRoute(modid, cmdid, version);
+        }
+    }
+}
+
+int elbClient::getHostProto(ThreadCtx* ctx, int modid, int cmdid, int timo, bool byKey, uint64_t key, elbHost& host)
+{
+    int index = (modid + cmdid) % 3;
+    uint32_t seq = ctx->nextSeq();
     elb::GetHostReq req;
     req.set_seq(seq);
     req.set_modid(modid);
     req.set_cmdid(cmdid);
+    if (byKey)
+        req.set_hashkey(key);
     //send
     char wbuf[4096], rbuf[81920];
     commu_head head;
@@ -136,7 +716,6 @@ int elbClient::apiGetHost(int modid, int cmdid, int timo, std::string& ip, int&
     head.cmdid = elb::GetHostReqId;
     ::memcpy(wbuf, &head, COMMU_HEAD_LENGTH);
     req.SerializeToArray(wbuf + COMMU_HEAD_LENGTH, head.length);
-    int index = (modid + cmdid) % 3;
     int ret = ::sendto(_sockfd[index], wbuf, head.length + COMMU_HEAD_LENGTH , 0, NULL, 0);
     if (ret == -1)
     {
@@ -165,7 +744,8 @@ int elbClient::apiGetHost(int modid, int cmdid, int timo, std::string& ip, int&
             head.length, pkgLen, head.cmdid, elb::GetHostRspId);
         return -9999;
     }
-    while (rsp.seq() < seq)
+    //跳过之前超时请求（可能是其他线程的）的迟到应答
+    while (rsp.seq() != seq)
     {
         //recv again
         pkgLen = ::recvfrom(_sockfd[index], rbuf, sizeof rbuf, 0, NULL, NULL);
@@ -190,28 +770,151 @@ int elbClient::apiGetHost(int modid, int cmdid, int timo, std::string& ip, int&
 
     if (rsp.retcode() == 0)
     {
-        const elb::HostAddr host = rsp.host();
-        struct in_addr inaddr;
-        inaddr.s_addr = host.ip();
-        ip = ::inet_ntoa(inaddr);
-        port = host.port();
-
-        _tsget = getCurrMills();
+        host.ip = rsp.host().ip();
+        host.port = rsp.host().port();
     }
     return rsp.retcode();
 }
 
+void elbClient::negotiateWire(int index)
+{
+    //默认回退到protobuf：老版本agent不认识WireNegoReqId，会直接丢弃请求；没有得到应答时稍后重试，不作为最终结果
+    setWireVer(0);
+    __atomic_store_n(&_wireRetryTs, MONO_SEC() + WIRE_RENEGO_SEC, __ATOMIC_RELEASE);
+    char wbuf[64], rbuf[64];
+    commu_head head;
+    FixWireNego req;
+    req.version = FIXED_WIRE_VERSION;
+    head.length = sizeof req;
+    head.cmdid = elb::WireNegoReqId;
+    ::memcpy(wbuf, &head, COMMU_HEAD_LENGTH);
+    ::memcpy(wbuf + COMMU_HEAD_LENGTH, &req, sizeof req);
+    int ret = ::sendto(_sockfd[index], wbuf, head.length + COMMU_HEAD_LENGTH, 0, NULL, 0);
+    if (ret == -1)
+    {
+        perror("sendto");
+        return ;
+    }
+    //协商等待时间为20ms
+    struct timeval tv;
+    tv.tv_sec = 0;
+    tv.tv_usec = 20000;
+    ::setsockopt(_sockfd[index], SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    FixWireNego rsp;
+    do
+    {
+        //跳过之前超时请求的迟到应答
+        int pkgLen = ::recvfrom(_sockfd[index], rbuf, sizeof rbuf, 0, NULL, NULL);
+        if (pkgLen < COMMU_HEAD_LENGTH)
+            return ;
+        ::memcpy(&head, rbuf, COMMU_HEAD_LENGTH);
+        if (head.cmdid != elb::WireNegoRspId)
+            continue;
+        if (!fixedDecode(rbuf + COMMU_HEAD_LENGTH, pkgLen - COMMU_HEAD_LENGTH, rsp))
+            return ;
+        break;
+    } while (true);
+    //agent明确应答了，不再重试；应答0表示agent关闭了定长编码
+    __atomic_store_n(&_wireRetryTs, 0, __ATOMIC_RELEASE);
+    if (rsp.version <= FIXED_WIRE_VERSION)
+        setWireVer(rsp.version);
+}
+
+int elbClient::getHostFixed(ThreadCtx* ctx, int modid, int cmdid, int timo, bool byKey, uint64_t key, elbHost& host)
+{
+    uint32_t seq = ctx->nextSeq();
+    char wbuf[64], rbuf[4096];
+    commu_head head;
+    if (byKey)
+    {
+        FixGetHostKeyReq req;
+        req.seq = seq;
+        req.modid = modid;
+        req.cmdid = cmdid;
+        req.keyHigh = (uint32_t)(key >> 32);
+        req.keyLow = (uint32_t)key;
+        head.length = sizeof req;
+        head.cmdid = elb::FixGetHostKeyReqId;
+        ::memcpy(wbuf + COMMU_HEAD_LENGTH, &req, sizeof req);
+    }
+    else
+    {
+        FixGetHostReq req;
+        req.seq = seq;
+        req.modid = modid;
+        req.cmdid = cmdid;
+        head.length = sizeof req;
+        head.cmdid = elb::FixGetHostReqId;
+        ::memcpy(wbuf + COMMU_HEAD_LENGTH, &req, sizeof req);
+    }
+    ::memcpy(wbuf, &head, COMMU_HEAD_LENGTH);
+    int index = (modid + cmdid) % 3;
+    int ret = ::sendto(_sockfd[index], wbuf, head.length + COMMU_HEAD_LENGTH , 0, NULL, 0);
+    if (ret == -1)
+    {
+        perror("sendto");
+        return -9999;
+    }
+
+    struct timeval tv;
+    tv.tv_sec = timo / 1000;
+    tv.tv_usec = (timo % 1000) * 1000;
+    ::setsockopt(_sockfd[index], SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    FixGetHostRsp rsp;
+    do
+    {
+        //跳过之前超时请求的迟到应答
+        int pkgLen = ::recvfrom(_sockfd[index], rbuf, sizeof rbuf, 0, NULL, NULL);
+        if (pkgLen == -1)
+        {
+            perror("recvfrom");
+            return -9999;
+        }
+        if (pkgLen < COMMU_HEAD_LENGTH)
+        {
+            fprintf(stderr, "package format error: pkgLen is %d\n", pkgLen);
+            return -9999;
+        }
+        ::memcpy(&head, rbuf, COMMU_HEAD_LENGTH);
+        if (head.cmdid != elb::FixGetHostRspId)
+            continue;
+        if (!fixedDecode(rbuf + COMMU_HEAD_LENGTH, pkgLen - COMMU_HEAD_LENGTH, rsp))
+        {
+            fprintf(stderr, "package format error: head.length is %d, pkgLen is %d\n", head.length, pkgLen);
+            return -9999;
+        }
+        if (rsp.seq == seq)
+            break;
+    } while (true);
+
+    if (rsp.seq != seq || rsp.modid != modid || rsp.cmdid != cmdid)
+    {
+        fprintf(stderr, "package content error\n");
+        return -9999;
+    }
+
+    if (rsp.retcode == 0)
+    {
+        host.ip = rsp.ip;
+        host.port = rsp.port;
+    }
+    return rsp.retcode;
+}
+
 int elbClient::getRoute4Cache(int modid, int cmdid, long ts)
 {
-    CacheUnit* cacheItem = _cacheLayer.getCache(modid, cmdid);
     elb::CacheGetRouteReq req;
     req.set_modid(modid);
     req.set_cmdid(cmdid);
     ////首次获取时，version=-1
+    ::pthread_mutex_lock(&_routeMutex);
+    CacheUnit* cacheItem = _routes.getCache(modid, cmdid);
     if (cacheItem)
         req.set_version(cacheItem->version);
     else
         req.set_version(-1);
+    ::pthread_mutex_unlock(&_routeMutex);
     //api向agent发起获取\更新路由请求
     char wbuf[4096], rbuf[81920];
     commu_head head;
@@ -220,9 +923,11 @@ int elbClient::getRoute4Cache(int modid, int cmdid, long ts)
     ::memcpy(wbuf, &head, COMMU_HEAD_LENGTH);
     req.SerializeToArray(wbuf + COMMU_HEAD_LENGTH, head.length);
     int index = (modid + cmdid) % 3;
+    ::pthread_mutex_lock(&_sockMutex[index]);
     int ret = ::sendto(_sockfd[index], wbuf, head.length + COMMU_HEAD_LENGTH , 0, NULL, 0);
     if (ret == -1)
     {
+        ::pthread_mutex_unlock(&_sockMutex[index]);
         perror("sendto");
         return -9999;
     }
@@ -231,70 +936,36 @@ int elbClient::getRoute4Cache(int modid, int cmdid, long ts)
     tv.tv_sec = 0;
     tv.tv_usec = 50000;
     ::setsockopt(_sockfd[index], SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-    int pkgLen = ::recvfrom(_sockfd[index], rbuf, sizeof rbuf, 0, NULL, NULL);
-    if (pkgLen == -1)
-    {
-        perror("recvfrom");
-        return -9999;
-    }
-    ::memcpy(&head, rbuf, COMMU_HEAD_LENGTH);
     elb::CacheGetRouteRsp rsp;
-    if (head.cmdid != elb::CacheGetRouteRspId ||
-        !rsp.ParseFromArray(rbuf + COMMU_HEAD_LENGTH, pkgLen - COMMU_HEAD_LENGTH))
+    while (true)
     {
-        fprintf(stderr, "package format error: head.length is %d, pkgLen is %d, head.cmdid is %d, target cmdid is %d\n",
-            head.length, pkgLen, head.cmdid, elb::GetHostRspId);
-        return -9999;
-    }
-    if (rsp.modid() != modid || rsp.cmdid() != cmdid)
-    {
-        fprintf(stderr, "package content error\n");
-        return -9999;
-    }
-    //已经拿到了正确的路由
-    if (rsp.version() == -1)
-    {
-        //如果agent端此mod路由为空，则删除本地cache（如果有的话）
-        _cacheLayer.rmCache(modid, cmdid);
-    }
-    else if (!cacheItem || rsp.version() != cacheItem->version)
-    {
-        //如果本地缓存不存在此mod，或者版本号与agent上此mod不同则更新本地路由
-        if (!cacheItem)
+        int pkgLen = ::recvfrom(_sockfd[index], rbuf, sizeof rbuf, 0, NULL, NULL);
+        if (pkgLen == -1)
         {
-            cacheItem = new CacheUnit();
-            if (!cacheItem)
-                ::exit(1);
-            //添加cacheItem到本地缓存
-            cacheItem->modid = modid;
-            cacheItem->cmdid = cmdid;
-            _cacheLayer.addCache(modid, cmdid, cacheItem);
+            ::pthread_mutex_unlock(&_sockMutex[index]);
+            perror("recvfrom");
+            return -9999;
         }
-        cacheItem->overload = rsp.overload();
-        cacheItem->version = rsp.version();
-        cacheItem->succCnt = 0;
-        cacheItem->lstUpdTs = ts;
-        cacheItem->nodeList.clear();
-        cacheItem->succAccum.clear();
-        //添加路由信息
-        for (int i = 0;i < rsp.route_size(); ++i)
+        ::memcpy(&head, rbuf, COMMU_HEAD_LENGTH);
+        //跳过之前超时请求（可能是其他线程的）的迟到应答
+        if (head.cmdid != elb::CacheGetRouteRspId)
+            continue;
+        if (!rsp.ParseFromArray(rbuf + COMMU_HEAD_LENGTH, pkgLen - COMMU_HEAD_LENGTH))
         {
-            const elb::HostAddr& ha = rsp.route(i);
-            pair<int, int> hd;
-            hd.first = ha.ip();
-            hd.second = ha.port();
-            cacheItem->nodeList.push_back(hd);
-            uint64_t key = ((uint64_t)hd.first << 32) + hd.second;
-            cacheItem->succAccum[key] = 0;
+            ::pthread_mutex_unlock(&_sockMutex[index]);
+            fprintf(stderr, "package format error: head.length is %d, pkgLen is %d, head.cmdid is %d, target cmdid is %d\n",
+                head.length, pkgLen, head.cmdid, elb::CacheGetRouteRspId);
+            return -9999;
         }
+        if (rsp.modid() == modid && rsp.cmdid() == cmdid)
+            break;
     }
-    else
-    {
-        //版本一致
-        cacheItem->overload = rsp.overload();
-        cacheItem->succCnt = 0;
-        cacheItem->lstUpdTs = ts;
-    }
+    ::pthread_mutex_unlock(&_sockMutex[index]);
+    //已经拿到了正确的路由，网络交互期间不持有_routeMutex，此时重新查找快照
+    ::pthread_mutex_lock(&_routeMutex);
+    if (applyRoute(_routes, rsp, ts))
+        ++_routeGen;
+    ::pthread_mutex_unlock(&_routeMutex);
     return 0;
 }
 
@@ -303,6 +974,7 @@ void elbClient::batchReportRes(CacheUnit* cacheItem)
     if (cacheItem && cacheItem->succCnt)
     {
         cacheItem->succCnt = 0;//清空调用信息
+        cacheItem->lstRptMs = MONO_MSEC();
         elb::CacheBatchRptReq req;
         req.set_modid(cacheItem->modid);
         req.set_cmdid(cacheItem->cmdid);
@@ -316,21 +988,28 @@ void elbClient::batchReportRes(CacheUnit* cacheItem)
                 cr.set_ip((int)(it->first >> 32));
                 cr.set_port((int)it->first);
                 cr.set_succcnt(it->second);
+                //成功调用的耗时按节点汇总，老版本agent忽略这两个字段
+                hash_map<uint64_t, pair<uint64_t, uint32_t> >::iterator cit = cacheItem->costAccum.find(it->first);
+                if (cit != cacheItem->costAccum.end())
+                {
+                    cr.set_costsum(cit->second.first);
+                    cr.set_costcnt(cit->second.second);
+                }
                 req.add_results()->CopyFrom(cr);
             }
             //reset accumulator to 0
             it->second = 0;
         }
-        //send to agent
-        char wbuf[4096];
+        cacheItem->costAccum.clear();
+        //send to agent：节点多时消息可能超过栈上缓冲，序列化到string
         commu_head head;
         head.length = req.ByteSize();
         head.cmdid = elb::CacheBatchRptReqId;
-        ::memcpy(wbuf, &head, COMMU_HEAD_LENGTH);
-        req.SerializeToArray(wbuf + COMMU_HEAD_LENGTH, head.length);
+        std::string wbuf((const char*)&head, COMMU_HEAD_LENGTH);
+        req.AppendToString(&wbuf);
 
         int index = (cacheItem->modid + cacheItem->cmdid) % 3;
-        int ret = ::sendto(_sockfd[index], wbuf, head.length + COMMU_HEAD_LENGTH , 0, NULL, 0);
+        int ret = ::sendto(_sockfd[index], wbuf.data(), wbuf.size(), 0, NULL, 0);
         if (ret == -1)
             perror("sendto()");
     }
@@ -338,32 +1017,81 @@ void elbClient::batchReportRes(CacheUnit* cacheItem)
 
 void elbClient::apiReportRes(int modid, int cmdid, const std::string& ip, int port, int retcode)
 {
-    if (_agentOff) return ;
     struct in_addr inaddr;
     ::inet_aton(ip.c_str(), &inaddr);
-    int ipn = inaddr.s_addr;//ip number
+    elbHost host;
+    host.ip = inaddr.s_addr;
+    host.port = port;
+    //字符串接口没有携带获取时刻，只能以本线程最近一次获取为准
+    host.tsget = threadCtx()->tsget;
+    apiReportRes(modid, cmdid, host, retcode);
+}
+
+void elbClient::apiReportRes(int modid, int cmdid, const elbHost& host, int retcode)
+{
+    ThreadCtx* ctx = threadCtx();
+    if (ctx->agentOff) return ;
+    int ipn = host.ip;//ip number
+    int port = host.port;
 
-    //调用成功，且此mod无节点过载
-    CacheUnit* cacheItem = _cacheLayer.getCache(modid, cmdid);
-    //此mod无节点过载
-    if (cacheItem && !cacheItem->overload)
+    //本次调用的耗时(ms)，以获取到此节点的时刻为起点；不知道获取时刻时为0，不足1ms按1ms计
+    uint32_t tcost = host.tsget? (uint32_t)(MONO_MSEC() - host.tsget): 0;
+    if (host.tsget && !tcost)
+        tcost = 1;
+    ::pthread_mutex_lock(&ctx->batchMutex);
+    CacheUnit* cacheItem = ctx->cache.getCache(modid, cmdid);
+    if (cacheItem)
     {
         if (retcode == 0)
         {
-            //上报到缓存即可
-            cacheItem->report(ipn, port);
-            return ;
+            //调用成功：暂存到缓存即可，耗时按节点汇总后随批量上报带给agent
+            if (cacheItem->report(ipn, port, tcost))
+            {
+                //此mod有节点过载时agent需要尽快看到调用结果（overload节点的恢复靠连续成功），暂存够一定个数或时长就批量上报
+                //之后没有新的上报时，由后台线程补报到时的暂存
+                if (cacheItem->overload)
+                {
+                    if (cacheItem->succCnt >= OVERLOAD_BATCH_CNT || MONO_MSEC() - cacheItem->lstRptMs >= OVERLOAD_BATCH_MSEC)
+                        batchReportRes(cacheItem);
+                    else if (!__atomic_exchange_n(&_batchDue, 1, __ATOMIC_ACQ_REL))
+                    {
+                        //后台线程可能正在按REFRESH_POLL_MSEC等待，唤醒它改按OVERLOAD_BATCH_MSEC补报
+                        uint64_t one = 1;
+                        if (::write(_wakefd, &one, sizeof one) == -1 && errno != EAGAIN)
+                            perror("write eventfd");
+                    }
+                }
+                ::pthread_mutex_unlock(&ctx->batchMutex);
+                return ;
+            }
+            //节点不在此mod的路由中（路由刚变化），走网络上报
         }
         else
         {
             //retcode != 0
-            //立即将之前暂存的report状态上报予agent，如果有的话
+            //立即将之前暂存的report状态上报予agent，如果有的话，保证成功、失败的先后顺序
             batchReportRes(cacheItem);//将之前暂存的此mod的report状态上报予agent
             //然后需要通过网络上报本次状态, so don't return
         }
     }
-    
+    ::pthread_mutex_unlock(&ctx->batchMutex);
+
     //通过网络上报本次状态
+    int index = (modid + cmdid) % 3;
+    if (wireVer() < 0)
+    {
+        //协商是一问一答，需独占此socket
+        ::pthread_mutex_lock(&_sockMutex[index]);
+        if (wireVer() < 0)
+            negotiateWire(index);
+        ::pthread_mutex_unlock(&_sockMutex[index]);
+    }
+    //定长编码的agent都接受成功调用的耗时
+    if (wireVer() > 0)
+    {
+        reportResFixed(modid, cmdid, ipn, port, retcode, tcost);
+        return ;
+    }
     //report status by local network
     elb::ReportReq req;
     req.set_modid(modid);
@@ -374,11 +1102,9 @@ void elbClient::apiReportRes(int modid, int cmdid, const std::string& ip, int po
     hp->set_ip(ipn);
     hp->set_port(port);
 
-    if (retcode)//#如果对节点的调用是失败的，则也需要上报调用消耗的毫秒级时间
-    {
-        uint32_t tcost = (uint32_t)(getCurrMills() - _tsget);
+    //protobuf编码只有失败调用带耗时：老版本agent收到带tcost的成功上报会断言失败
+    if (retcode != 0 && tcost)
         req.set_tcost(tcost);
-    }
     //send
     char wbuf[4096];
     commu_head head;
@@ -387,6 +1113,28 @@ void elbClient::apiReportRes(int modid, int cmdid, const std::string& ip, int po
     ::memcpy(wbuf, &head, COMMU_HEAD_LENGTH);
     req.SerializeToArray(wbuf + COMMU_HEAD_LENGTH, head.length);
 
+    int ret = ::sendto(_sockfd[index], wbuf, head.length + COMMU_HEAD_LENGTH , 0, NULL, 0);
+    if (ret == -1)
+        perror("sendto()");
+}
+
+void elbClient::reportResFixed(int modid, int cmdid, int ipn, int port, int retcode, uint32_t tcost)
+{
+    FixReportReq req;
+    req.modid = modid;
+    req.cmdid = cmdid;
+    req.ip = ipn;
+    req.port = port;
+    req.retcode = retcode;
+    req.tcost = tcost;
+    //send
+    char wbuf[64];
+    commu_head head;
+    head.length = sizeof req;
+    head.cmdid = elb::FixReportReqId;
+    ::memcpy(wbuf, &head, COMMU_HEAD_LENGTH);
+    ::memcpy(wbuf + COMMU_HEAD_LENGTH, &req, sizeof req);
+
     int index = (modid + cmdid) % 3;
     int ret = ::sendto(_sockfd[index], wbuf, head.length + COMMU_HEAD_LENGTH , 0, NULL, 0);
     if (ret == -1)
@@ -406,17 +1154,19 @@ int elbClient::apiGetRoute(int modid, int cmdid, std::vector<std::pair<std::stri
     req.set_cmdid(cmdid);
     //send
     char wbuf[4096];
-    char* rbuf = new char[40960];
-    assert(rbuf);
+    char rbuf[40960];
     commu_head head;
     head.length = req.ByteSize();
     head.cmdid = elb::GetRouteByToolReqId;
     ::memcpy(wbuf, &head, COMMU_HEAD_LENGTH);
     req.SerializeToArray(wbuf + COMMU_HEAD_LENGTH, head.length);
     int index = (modid + cmdid) % 3;
+    //一问一答期间独占此socket，避免收到其他线程的回包
+    ::pthread_mutex_lock(&_sockMutex[index]);
     int ret = ::sendto(_sockfd[index], wbuf, head.length + COMMU_HEAD_LENGTH , 0, NULL, 0);
     if (ret == -1)
     {
+        ::pthread_mutex_unlock(&_sockMutex[index]);
         perror("sendto");
         return -1;
     }
@@ -426,17 +1176,23 @@ int elbClient::apiGetRoute(int modid, int cmdid, std::vector<std::pair<std::stri
     tv.tv_usec = 100000;
     ::setsockopt(_sockfd[index], SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
 
-    int pkgLen = ::recvfrom(_sockfd[index], rbuf, 40960, 0, NULL, NULL);
-    if (pkgLen == -1)
+    int pkgLen;
+    //跳过此前超时请求迟到的回包
+    do
     {
-        perror("recvfrom");
-        return -1;
-    }
+        pkgLen = ::recvfrom(_sockfd[index], rbuf, sizeof rbuf, 0, NULL, NULL);
+        if (pkgLen == -1)
+        {
+            ::pthread_mutex_unlock(&_sockMutex[index]);
+            perror("recvfrom");
+            return -1;
+        }
+        ::memcpy(&head, rbuf, COMMU_HEAD_LENGTH);
+    } while (head.cmdid != elb::GetRouteByToolRspId);
+    ::pthread_mutex_unlock(&_sockMutex[index]);
 
-    ::memcpy(&head, rbuf, COMMU_HEAD_LENGTH);
     elb::GetRouteRsp rsp;
-    if (head.cmdid != elb::GetRouteByToolRspId || 
-        !rsp.ParseFromArray(rbuf + COMMU_HEAD_LENGTH, pkgLen - COMMU_HEAD_LENGTH))
+    if (!rsp.ParseFromArray(rbuf + COMMU_HEAD_LENGTH, pkgLen - COMMU_HEAD_LENGTH))
     {
         fprintf(stderr, "receive data format error\n");
         return -1;
@@ -447,11 +1203,11 @@ int elbClient::apiGetRoute(int modid, int cmdid, std::vector<std::pair<std::stri
         const elb::HostAddr& host = rsp.hosts(i);
         struct in_addr inaddr;
         inaddr.s_addr = host.ip();
-        std::string ip = ::inet_ntoa(inaddr);
+        char ip[INET_ADDRSTRLEN];
+        ::inet_ntop(AF_INET, &inaddr, ip, sizeof ip);
         int port = host.port();
         route.push_back(std::pair<std::string, int>(ip, port));
     }
-    delete[] rbuf;
     return 0;
 }
 
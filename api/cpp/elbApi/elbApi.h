@@ -4,9 +4,32 @@
 #include <string>
 #include <vector>
 #include <stdint.h>
+#include <pthread.h>
+#include <netinet/in.h>
 #include "cacheLayer.h"
 #include "StaticRoute.h"
 
+//节点的紧凑表示：ip即网络序的s_addr，可直接填入sockaddr_in，需要字符串时才格式化
+//同时是一次调用的句柄：apiGetHost记下获取时刻，apiReportRes据此计算这一次调用的耗时
+struct elbHost
+{
+    elbHost(): ip(0), port(0), tsget(0) { }
+
+    void toSockaddr(struct sockaddr_in& addr) const;
+    std::string ipStr() const;
+
+    uint32_t ip;
+    int port;
+    uint64_t tsget;//apiGetHost获取到此节点的时刻，单调时钟,毫秒；0表示未知，上报时不带耗时
+};
+
+//每个使用elbClient的线程私有的状态，定义见elbApi.cc
+struct ThreadCtx;
+
+//elbClient可被多个线程共享：与agent的连接、路由快照、静态路由由所有线程共用；
+//每个线程有自己的缓存条目（轮询位置、成功调用暂存）与seq空间，缓存命中时的获取节点、上报成功都不加锁
+//路由快照由一个后台线程定期刷新，已有快照的mod获取节点时不会等待agent
+//须在所有使用它的线程不再调用API后再析构
 class elbClient
 {
 public:
@@ -15,26 +38,84 @@ public:
     ~elbClient();
 
     int apiGetHost(int modid, int cmdid, int timo, std::string& ip, int& port);
+    //同上，返回紧凑的节点表示，省去ip字符串的格式化与解析
+    int apiGetHost(int modid, int cmdid, int timo, elbHost& host);
+    //按key获取节点（缓存类服务）：agent为此mod配置了一致性哈希策略时，同一key总是得到同一节点，节点增删时只有少量key换节点，
+    //首选节点overload时顺延到下一个idle节点；策略为none、老agent、或agent宕机改用静态路由时忽略key，同apiGetHost
+    int apiGetHostByKey(int modid, int cmdid, uint64_t key, int timo, elbHost& host);
+    //字符串key先哈希为64位
+    int apiGetHostByKey(int modid, int cmdid, const std::string& key, int timo, elbHost& host);
 
+    //字符串接口以本线程最近一次apiGetHost的时刻计算耗时，同一线程交错多次调用时耗时不准
     void apiReportRes(int modid, int cmdid, const std::string& ip, int port, int retcode);
+    //host须是apiGetHost返回的那个，耗时按它自己的获取时刻计算，可跨线程、交错上报；成功、失败调用都带耗时
+    void apiReportRes(int modid, int cmdid, const elbHost& host, int retcode);
 
     int apiGetRoute(int modid, int cmdid, std::vector<std::pair<std::string, int> >& route);
 
     int apiRegister(int modid, int cmdid);//非必需使用的API
 
 private:
-    //向agent批量上报某mod
+    elbClient(const elbClient&);
+    elbClient& operator=(const elbClient&);
+
+    //取本线程的私有状态，首次调用时创建
+    ThreadCtx* threadCtx();
+    //线程退出时释放其私有状态
+    static void releaseCtx(void* ctx);
+    void dropCtx(ThreadCtx* ctx);
+    //apiGetHost、apiGetHostByKey的实现，byKey为false时忽略key
+    int getHostImpl(int modid, int cmdid, int timo, bool byKey, uint64_t key, elbHost& host);
+    //本线程缓存中此mod的条目不存在或已过期：从共享的路由快照同步，还没有快照时向agent获取
+    int syncRoute(ThreadCtx* ctx, int modid, int cmdid, long ts);
+    //后台线程：定期向agent刷新（并订阅）共享的路由快照，接收agent推送的变化，请求路径上不再等待agent
+    static void* refreshMain(void* args);
+    void refreshRoutes(long ts);
+    //后台线程：补报各线程中有过载节点的mod已暂存超过OVERLOAD_BATCH_MSEC的成功调用，不必等该线程的下一次上报
+    void flushOverdue();
+    //从订阅socket发出获取路由请求，同时订阅此mod的变化；不等待应答
+    void subscribeRoute(int modid, int cmdid, long version);
+    //处理订阅socket上的路由应答与变化推送
+    void recvSubscribed(int index);
+    //向agent批量上报某mod；调用者持有所属线程的batchMutex
     void batchReportRes(CacheUnit* cacheItem);
-    //向agent获取某mod的路由
+    //向agent获取某mod的路由，更新共享的路由快照；调用者不能持有_routeMutex
     int getRoute4Cache(int modid, int cmdid, long ts);
+    //与agent协商GetHost/Report消息的编码方式，结果存于_wireVer；调用者持有_sockMutex[index]
+    void negotiateWire(int index);
+    //经网络向agent获取节点（protobuf、定长编码两种）；调用者持有_sockMutex[index]
+    int getHostProto(ThreadCtx* ctx, int modid, int cmdid, int timo, bool byKey, uint64_t key, elbHost& host);
+    int getHostFixed(ThreadCtx* ctx, int modid, int cmdid, int timo, bool byKey, uint64_t key, elbHost& host);
+    void reportResFixed(int modid, int cmdid, int ipn, int port, int retcode, uint32_t tcost);
+    int wireVer() const { return __atomic_load_n(&_wireVer, __ATOMIC_ACQUIRE); }
+    void setWireVer(int ver) { __atomic_store_n(&_wireVer, ver, __ATOMIC_RELEASE); }
 
     int _sockfd[3];
-    uint32_t _seqid;
+    //同一时刻只有一个线程在_sockfd[i]上等待应答，保证收到的是自己请求的应答；只发不收的上报不加锁
+    pthread_mutex_t _sockMutex[3];
     void* _hb;
     StaticRoute _staticRoute;
-    bool _agentOff;
-    CacheLayer _cacheLayer;
-    uint64_t _tsget;//获取到节点的时间戳，毫秒
+    pthread_mutex_t _staticMutex;
+    volatile bool _staticUsed;//agent宕机期间用过静态路由，agent恢复后需释放
+    //所有线程共享的路由快照，各线程的缓存条目从这里同步
+    CacheLayer _routes;
+    pthread_mutex_t _routeMutex;
+    volatile uint32_t _routeGen;//任一快照有变化即递增，各线程据此立即同步，无需等到缓存条目过期
+    //后台线程专用的socket，及其本地端口（订阅时告知agent）
+    int _subfd[3];
+    int _subPort[3];
+    //多个线程读写，只经wireVer/setWireVer等原子访问
+    int _wireVer;//与agent协商出的定长编码版本：-1未协商，0只用protobuf
+    long _wireRetryTs;//协商未得到agent应答时，此时刻（单调时钟,秒）之后重新协商；0表示不重试
+    int _batchDue;//有线程暂存了有过载节点的mod的成功调用、尚未上报，后台线程需按时补报
+    int _wakefd;//eventfd：_batchDue由0变1时唤醒后台线程
+    pthread_key_t _ctxKey;
+    pthread_mutex_t _ctxMutex;
+    std::vector<ThreadCtx*> _ctxs;//所有线程的私有状态，析构时上报并释放
+    uint32_t _nextSeqSpace;
+    std::vector<uint32_t> _freeSeqs;//已退出线程的seq空间（连同它的下一个seq），新线程优先复用
+    pthread_t _refresher;
+    volatile bool _stop;
 };
 
 #endif
@@ -0,0 +1,95 @@
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/time.h>
+#include "coarseClock.h"
+
+//对比elbClient/lbagent热路径上每次请求的取时开销：
+//旧：apiGetHost一次time(NULL) + 一次gettimeofday；新：一次MONO_SEC + 一次MONO_MSEC
+
+static volatile uint64_t sink = 0;
+
+static uint64_t nowNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void oldPerRequest()
+{
+    long currTs = time(NULL);
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    sink += currTs + (uint64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+static void newPerRequest()
+{
+    long currTs = MONO_SEC();
+    sink += currTs + MONO_MSEC();
+}
+
+static void callTime() { sink += time(NULL); }
+
+static void callGettimeofday()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    sink += tv.tv_usec;
+}
+
+static void callMonotonic()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    sink += ts.tv_nsec;
+}
+
+static void callMonoSec() { sink += MONO_SEC(); }
+
+static void callMonoMsec() { sink += MONO_MSEC(); }
+
+static double bench(void (*fn)(), long n)
+{
+    //预热
+    for (long i = 0;i < n / 10; ++i)
+        fn();
+    uint64_t begin = nowNs();
+    for (long i = 0;i < n; ++i)
+        fn();
+    return (double)(nowNs() - begin) / n;
+}
+
+int main(int argc, char** argv)
+{
+    long n = 10000000;
+    for (int i = 1;i + 1 < argc; ++i)
+    {
+        if (!strcmp(argv[i], "-n"))
+            n = atol(argv[i + 1]);
+    }
+    if (n <= 0)
+    {
+        printf("./clockbench [-n iterations]\n");
+        return 1;
+    }
+
+    printf("iterations: %ld\n", n);
+    printf("%-36s %8.2f ns/op\n", "time(NULL)", bench(callTime, n));
+    printf("%-36s %8.2f ns/op\n", "gettimeofday", bench(callGettimeofday, n));
+    printf("%-36s %8.2f ns/op\n", "clock_gettime(MONOTONIC)", bench(callMonotonic, n));
+    printf("%-36s %8.2f ns/op\n", "MONO_SEC (MONOTONIC_COARSE)", bench(callMonoSec, n));
+    printf("%-36s %8.2f ns/op\n", "MONO_MSEC (MONOTONIC_COARSE)", bench(callMonoMsec, n));
+
+    double oldCost = bench(oldPerRequest, n);
+    double newCost = bench(newPerRequest, n);
+    printf("\nper apiGetHost request:\n");
+    printf("%-36s %8.2f ns\n", "old: time(NULL) + gettimeofday", oldCost);
+    printf("%-36s %8.2f ns\n", "new: MONO_SEC + MONO_MSEC", newCost);
+    printf("%-36s %8.2f ns (%.1f%%)\n", "saving", oldCost - newCost,
+        oldCost > 0? (oldCost - newCost) * 100 / oldCost: 0.0);
+    return 0;
+}
@@ -14,7 +14,21 @@ int main(int argc, char const *argv[])
     if (ret != 0)
         std::cout << "still not exist after register" << std::endl;
 
-    ret = client.apiGetHost(modid, cmdid, 10, ip, port);
+    if (argc > 3)
+    {
+        //./example modid cmdid key：按key获取节点，同一key总是得到同一节点
+        elbHost host;
+        ret = client.apiGetHostByKey(modid, cmdid, std::string(argv[3]), 10, host);
+        if (ret == 0)
+        {
+            ip = host.ipStr();
+            port = host.port;
+        }
+    }
+    else
+    {
+        ret = client.apiGetHost(modid, cmdid, 10, ip, port);
+    }
     if (ret == 0)
     {
         std::cout << "host is " << ip << ":" << port << std::endl;
@@ -1,32 +1,85 @@
+#include <time.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "elbApi.h"
+#include "latencyHist.h"
 #include <iostream>
 
+//./qpstest threadCnt [-r totalQps] [-a]
+//默认闭环：每个线程不停地获取节点，测最大吞吐
+//-r：开环，所有线程合计按totalQps/s的速率发请求，耗时从请求"应当发出"的时刻算起，落后时的排队时间也计入
+//-a：用apiGetRoute代替apiGetHost，每个请求都经UDP访问agent，测agent的耗时（apiGetHost多数命中API缓存）
+//每个线程每秒输出一行：[本秒成功次数] modid,cmdid: 本秒耗时分布
+
 struct Item
 {
+    elbClient* client;//所有线程共享一个elbClient
     int modid;
     int cmdid;
+    uint64_t intervalNs;//开环时本线程两次请求的间隔，0表示闭环
+    bool viaAgent;
 };
 
+static uint64_t nowNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void sleepUntil(uint64_t ts)
+{
+    uint64_t now = nowNs();
+    if (now >= ts)
+        return ;
+    struct timespec req;
+    req.tv_sec = (ts - now) / 1000000000;
+    req.tv_nsec = (ts - now) % 1000000000;
+    nanosleep(&req, NULL);
+}
+
 void* mockApi(void* args)
 {
     Item* item = (Item*)args;
     int modid = item->modid, cmdid = item->cmdid;
-    std::string ip;
-    int port;
+    elbHost host;
+    std::vector<std::pair<std::string, int> > route;
     int ret;
     long qps = 0;
-    elbClient client;
+    elbClient& client = *item->client;
+    LatencyHist hist;
     long lst = time(NULL);
+    uint64_t next = nowNs();
     while (1)
     {
-        ret = client.apiGetHost(modid, cmdid, 10, ip, port);
+        uint64_t begin;
+        if (item->intervalNs)
+        {
+            begin = next;
+            next += item->intervalNs;
+            sleepUntil(begin);
+        }
+        else
+        {
+            begin = nowNs();
+        }
+        if (item->viaAgent)
+        {
+            route.clear();
+            ret = client.apiGetRoute(modid, cmdid, route);
+        }
+        else
+        {
+            ret = client.apiGetHost(modid, cmdid, 10, host);
+        }
+        hist.record(nowNs() - begin);
         if (ret == 0 || ret == -9998)
         {
             ++qps;
-            if (ret == 0)
+            if (ret == 0 && !item->viaAgent)
             {
-                client.apiReportRes(modid, cmdid, ip, port, 0);
+                client.apiReportRes(modid, cmdid, host, 0);
             }
         }
         else
@@ -37,7 +90,10 @@ void* mockApi(void* args)
         if (curr - lst >= 1)
         {
             lst = curr;
-            printf("[%ld]\n", qps);
+            char name[64];
+            snprintf(name, sizeof name, "[%ld] %d,%d", qps, modid, cmdid);
+            hist.print(stdout, name, 1000, "us");
+            hist.reset();
             qps = 0;
         }
     }
@@ -46,17 +102,35 @@ void* mockApi(void* args)
 
 int main(int argc, char const *argv[])
 {
+    if (argc < 2 || atoi(argv[1]) <= 0)
+    {
+        printf("./qpstest threadCnt [-r totalQps] [-a]\n");
+        return 1;
+    }
     int cnt = atoi(argv[1]);
+    long rate = 0;
+    bool viaAgent = false;
+    for (int i = 2;i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "-r") && i + 1 < argc)
+            rate = atol(argv[++i]);
+        else if (!strcmp(argv[i], "-a"))
+            viaAgent = true;
+    }
     Item* items = new Item[cnt];
     pthread_t* tids = new pthread_t[cnt];
+    elbClient client;
     for (int i = 0;i < cnt; ++i)
     {
+        items[i].client = &client;
         items[i].modid = 10000 + i;
         items[i].cmdid = 1001;
+        items[i].intervalNs = rate > 0? (uint64_t)(1e9 * cnt / rate): 0;
+        items[i].viaAgent = viaAgent;
     }
     for (int i = 0;i < cnt; ++i)
         pthread_create(&tids[i], NULL, mockApi, &items[i]);
     for (int i = 0;i < cnt; ++i)
         pthread_join(tids[i], NULL);
     return 0;
-}
\ No newline at end of file
+}
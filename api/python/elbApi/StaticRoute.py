@@ -1,37 +1,105 @@
+import mmap
 import random
 import socket
 import struct
 
+#lbagent落地的二进制静态路由，格式见lbagent/include/RouteBackup.h
+BACKUP_FILE_PREFIX = '/tmp/backupRoute.bin.'
+BACKUP_MAGIC = 0x524c4245
+BACKUP_VERSION = 1
+JOURNAL_SUFFIX = '.journal'
+HEADER = struct.Struct('=IIIIIIq')
+MODULE = struct.Struct('=QqII')
+HOST = struct.Struct('=Ii')
+JHEADER = struct.Struct('=IIII')
+JRECORD = struct.Struct('=QqII')
+
+def checksum(buf, start, end, h = 2166136261):
+    for c in buf[start:end]:
+        h = ((h ^ ord(c)) * 16777619) & 0xffffffff
+    return h
+
 class StaticRoute:
     def __init__(self):
-        self.__route = None
+        self.__views = [None, None, None]
 
-    def getHost(self, modid, cmdid):
-        if not self.__route:
-            try:
-                self.__route = {}
-                for i in range(3):
-                    with open('/tmp/backupRoute.dat.%d' % (i + 1), 'r') as inf:
-                        for line in inf:
-                            attrs = line.strip().split()
-                            imodid, icmdid = int(attrs[0]), int(attrs[1])
-                            ip = int(attrs[2])
-                            port = int(attrs[3])
-                            key = (imodid, icmdid)
-                            if (imodid, icmdid) not in self.__route:
-                                self.__route[(imodid, icmdid)] = []
-                            self.__route[(imodid, icmdid)].append((ip, port))
+    def __map(self, index):
+        try:
+            with open(BACKUP_FILE_PREFIX + str(index + 1), 'rb') as inf:
+                buf = mmap.mmap(inf.fileno(), 0, access = mmap.ACCESS_READ)
+        except (IOError, ValueError, mmap.error), e:
+            return None
+        if len(buf) < HEADER.size:
+            return None
+        magic, version, modCnt, hostCnt, cksum, generation, _ = HEADER.unpack_from(buf, 0)
+        if magic != BACKUP_MAGIC or version != BACKUP_VERSION:
+            return None
+        if len(buf) != HEADER.size + modCnt * MODULE.size + hostCnt * HOST.size:
+            return None
+        if checksum(buf, HEADER.size, len(buf)) != cksum:
+            return None
+        return (buf, modCnt, self.__loadJournal(index, generation))
+
+    def __loadJournal(self, index, generation):
+        #两次全量落地之间的路由变化，同一模块以最后一条记录为准，空列表表示模块已删除
+        overlay = {}
+        try:
+            with open(BACKUP_FILE_PREFIX + str(index + 1) + JOURNAL_SUFFIX, 'rb') as inf:
+                data = inf.read()
+        except IOError, e:
+            return overlay
+        if len(data) < JHEADER.size:
+            return overlay
+        magic, version, jgen, _ = JHEADER.unpack_from(data, 0)
+        if magic != BACKUP_MAGIC or version != BACKUP_VERSION or jgen != generation:
+            return overlay
+        off = JHEADER.size
+        while off + JRECORD.size <= len(data):
+            key, _, count, cksum = JRECORD.unpack_from(data, off)
+            end = off + JRECORD.size + count * HOST.size
+            if end > len(data):
+                break
+            h = checksum(data, off, off + JRECORD.size - 4)
+            h = checksum(data, off + JRECORD.size, end, h)
+            if h != cksum:
+                break
+            overlay[key] = [HOST.unpack_from(data, off + JRECORD.size + i * HOST.size) for i in range(count)]
+            off = end
+        return overlay
 
-            except IOError, e:
+    def getHost(self, modid, cmdid):
+        #[modid,cmdid]只会被第(modid+cmdid)%3个UDP Server线程落地
+        index = (modid + cmdid) % 3
+        if not self.__views[index]:
+            self.__views[index] = self.__map(index)
+            if not self.__views[index]:
+                return -1
+        buf, modCnt, overlay = self.__views[index]
+        key = (modid << 32) + cmdid
+        if key in overlay:
+            if not overlay[key]:
                 return -1
-        if (modid, cmdid) not in self.__route:
+            ipn, port = random.choice(overlay[key])
+            return (socket.inet_ntoa(struct.pack('I', ipn)), port)
+        lo, hi = 0, modCnt
+        while lo < hi:
+            mid = (lo + hi) // 2
+            if MODULE.unpack_from(buf, HEADER.size + mid * MODULE.size)[0] < key:
+                lo = mid + 1
+            else:
+                hi = mid
+        if lo == modCnt:
+            return -1
+        mkey, _, first, count = MODULE.unpack_from(buf, HEADER.size + lo * MODULE.size)
+        if mkey != key or count == 0:
             return -1
-        host = random.choice(self.__route[(modid, cmdid)])
-        ipn = host[0]
-        if ipn < 0:
-            ipn += 2 ** 32
+        hostsOff = HEADER.size + modCnt * MODULE.size
+        ipn, port = HOST.unpack_from(buf, hostsOff + (first + random.randrange(count)) * HOST.size)
         ips = socket.inet_ntoa(struct.pack('I', ipn))
-        return (ips, host[1])
+        return (ips, port)
 
     def freeData(self):
-        self.__route = None
\ No newline at end of file
+        for view in self.__views:
+            if view:
+                view[0].close()
+        self.__views = [None, None, None]
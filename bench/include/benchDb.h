@@ -0,0 +1,23 @@
+#ifndef __BENCH_DB_H__
+#define __BENCH_DB_H__
+
+#include <stdint.h>
+
+//bench用的MySQL替身（src/mysqlStub.cc）与压测程序之间的约定
+//
+//dnsserver/reporter的ini中[mysql] db_name填一个本地路径，替身以它为"数据库"：
+//  DnsServerRoute：读db_name文件，每行"modid cmdid ip port [idc rack]"，ip为网络序s_addr的十进制，缺省的idc、rack按0返回
+//  RouteVersion：db_name文件的修改时间，改写文件即触发dnsserver重加载
+//  ChangeLog：始终为空
+//  其余语句（reporter的INSERT ... ON DUPLICATE KEY UPDATE等）只计数，不落地
+//计数写在db_name + BENCH_DB_STAT_SUFFIX文件的共享映射中，压测程序映射同一文件读取，跨进程、多连接共享
+
+#define BENCH_DB_STAT_SUFFIX ".stat"
+
+struct BenchDbStat
+{
+    uint64_t queries;//执行过的语句数
+    uint64_t inserts;//其中INSERT语句数，即reporter写入的调用结果条数
+};
+
+#endif
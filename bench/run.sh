@@ -0,0 +1,84 @@
+#!/bin/bash
+#在本机拉起dnsserver、reporter（MySQL换成替身）与lbagent，生成路由表后跑elb-bench.prog，结果JSON输出到-o指定的文件（默认标准输出）
+#用法：./run.sh [-m modules] [-s seed] [-o out.json] [-- elb-bench.prog run的其余参数]
+#例：./run.sh -m 1000 -o result.json -- -t 30 -c 8 -q 20000
+#注意：lbagent固定监听UDP 8888~8890并落地/tmp/backupRoute.bin.*，不能与正在运行的lbagent同机压测
+
+set -e
+
+BENCH=$(cd "$(dirname "$0")"; pwd)
+ROOT=$(cd "$BENCH/.."; pwd)
+MODULES=200
+SEED=1
+OUT=
+DNS_PORT=${DNS_PORT:-12315}
+RPT_PORT=${RPT_PORT:-12316}
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -m) MODULES=$2; shift 2;;
+        -s) SEED=$2; shift 2;;
+        -o) OUT=$2; shift 2;;
+        --) shift; break;;
+        *) echo "usage: $0 [-m modules] [-s seed] [-o out.json] [-- elb-bench args]"; exit 1;;
+    esac
+done
+
+make -C "$ROOT/lbagent" >/dev/null
+make -C "$BENCH" >/dev/null
+
+WORK=$(mktemp -d /tmp/elb-bench.XXXXXX)
+PIDS=
+cleanup()
+{
+    [ -n "$PIDS" ] && kill $PIDS 2>/dev/null || true
+    wait 2>/dev/null || true
+}
+trap cleanup EXIT
+
+"$BENCH/bin/elb-bench.prog" gen -o "$WORK/route.tbl" -m "$MODULES" -s "$SEED" >&2
+
+mkdir -p "$WORK/dnsserver" "$WORK/reporter" "$WORK/lbagent"
+cat > "$WORK/dnsserver/dnsserver.ini" <<EOF
+[mysql]
+db_name=$WORK/route.tbl
+load_interval=10
+[log]
+level=3
+[reactor]
+threadNum = 3
+maxConns = 1024
+ip=127.0.0.1
+port=$DNS_PORT
+EOF
+
+cat > "$WORK/reporter/reporter.ini" <<EOF
+[mysql]
+db_name=$WORK/reporter.db
+thread_cnt = 3
+[log]
+level=3
+[reactor]
+ip=127.0.0.1
+port=$RPT_PORT
+EOF
+
+#lbagent用仓库里的配置，只改reporter/dnsserver的地址，并关掉落地路由预热，每次从空路由开始
+sed -e "/^\[reporter\]/,/^\[/ { s/^ip=.*/ip=127.0.0.1/; s/^port=.*/port=$RPT_PORT/ }" \
+    -e "/^\[dnsserver\]/,/^\[/ { s/^ip=.*/ip=127.0.0.1/; s/^port=.*/port=$DNS_PORT/ }" \
+    -e "s/^warm_start=.*/warm_start=0/" \
+    "$ROOT/lbagent/conf/lbagent.ini" > "$WORK/lbagent/lbagent.ini"
+
+(cd "$WORK/dnsserver" && exec "$BENCH/bin/dnsserver-bench.prog" >/dev/null 2>&1) &
+PIDS="$PIDS $!"
+(cd "$WORK/reporter" && exec "$BENCH/bin/reporter-bench.prog" >/dev/null 2>&1) &
+PIDS="$PIDS $!"
+sleep 1
+(cd "$WORK/lbagent" && exec "$ROOT/lbagent/bin/lbagent.prog" "$WORK/lbagent/lbagent.ini" >/dev/null 2>&1) &
+PIDS="$PIDS $!"
+sleep 1
+
+"$BENCH/bin/elb-bench.prog" run -r "$WORK/route.tbl" -S "$WORK/reporter.db.stat" -D "$DNS_PORT" -P "$RPT_PORT" \
+    -s "$SEED" ${OUT:+-o "$OUT"} "$@"
+
+echo "logs in $WORK" >&2
@@ -0,0 +1,576 @@
+#include <math.h>
+#include <time.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <arpa/inet.h>
+#include <ext/hash_map>
+#include "elbApi.h"
+#include "elb.pb.h"
+#include "benchDb.h"
+#include "easy_reactor.h"
+#include "latencyHist.h"
+
+//端到端压测：本机上的dnsserver、lbagent、reporter（后两者的MySQL换成src/mysqlStub.cc）与N个API线程
+//gen：按对数正态的节点数分布生成路由表（即MySQL替身的DnsServerRoute）
+//run：按Zipf分布挑选模块，同时压各组件，预热后统计一段时间，以JSON输出各组件的吞吐与耗时分位数
+//  api_get_host / api_report：elbClient.apiGetHost / apiReportRes，多线程共享一个elbClient
+//  agent_get_route：elbClient.apiGetRoute，每次都经UDP问agent
+//  dnsserver_get_route：以agent的身份直连dnsserver，多个连接各自ping-pong
+//  reporter：以agent的身份向reporter定速上报，对比发出的与MySQL替身实际写入的调用结果条数
+
+#define REPORT_TICK_MS 10//向reporter发送上报的周期
+#define MAX_REPORT_HOSTS 8//一个上报请求最多带的节点个数
+
+struct Config
+{
+    Config(): mode(NULL), routeFile(NULL), outFile(NULL), statFile(NULL), modules(200), maxHosts(256),
+        seed(1), idcs(3), racks(8), duration(10), warmup(2), apiThreads(4), agentThreads(1), dnsPort(12315), dnsConns(8),
+        rptPort(12316), rptQps(5000), errRate(0.01), zipfS(1.0) {}
+    const char* mode;
+    const char* routeFile;
+    const char* outFile;
+    const char* statFile;//reporter的MySQL替身的计数文件
+    int modules;
+    int maxHosts;
+    uint64_t seed;
+    int idcs;//gen时节点分布的机房数，0表示不生成idc、rack两列
+    int racks;//gen时每个机房的机架数
+    int duration;
+    int warmup;
+    int apiThreads;
+    int agentThreads;
+    int dnsPort;
+    int dnsConns;
+    int rptPort;
+    int rptQps;
+    double errRate;//上报为失败的比例
+    double zipfS;
+};
+
+struct Module
+{
+    int modid;
+    int cmdid;
+    std::vector<std::pair<uint32_t, int> > hosts;
+};
+
+Config config;
+std::vector<Module> modules;
+volatile bool recording = false;
+volatile bool stopping = false;
+
+static uint64_t nowNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+//xorshift64*，每个线程自己的种子，同样的参数得到同样的请求序列
+static inline uint64_t nextRand(uint64_t& s)
+{
+    s ^= s >> 12;
+    s ^= s << 25;
+    s ^= s >> 27;
+    return s * 2685821657736338717ULL;
+}
+
+static inline double nextUniform(uint64_t& s)
+{
+    return (nextRand(s) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+//一类请求的计数与耗时分布
+struct LatStat
+{
+    LatStat(): errs(0) { }
+
+    void add(uint64_t ns, bool ok)
+    {
+        if (!ok)
+            ++errs;
+        hist.record(ns);
+    }
+
+    void merge(const LatStat& other)
+    {
+        errs += other.errs;
+        hist.merge(other.hist);
+    }
+
+    long errs;
+    LatencyHist hist;
+};
+
+//按Zipf分布挑选模块：热度排名与模块的对应关系由种子打乱，热门模块不总是modid最小的
+class ZipfPicker
+{
+public:
+    void init(int n, double s, uint64_t seed)
+    {
+        _order.resize(n);
+        for (int i = 0;i < n; ++i)
+            _order[i] = i;
+        for (int i = n - 1;i > 0; --i)
+            std::swap(_order[i], _order[nextRand(seed) % (i + 1)]);
+        _cdf.resize(n);
+        double sum = 0;
+        for (int i = 0;i < n; ++i)
+        {
+            sum += 1.0 / pow(i + 1, s);
+            _cdf[i] = sum;
+        }
+        for (int i = 0;i < n; ++i)
+            _cdf[i] /= sum;
+    }
+
+    const Module& pick(uint64_t& rng) const
+    {
+        double u = nextUniform(rng);
+        size_t rank = std::lower_bound(_cdf.begin(), _cdf.end(), u) - _cdf.begin();
+        if (rank >= _cdf.size())
+            rank = _cdf.size() - 1;
+        return modules[_order[rank]];
+    }
+
+private:
+    std::vector<int> _order;
+    std::vector<double> _cdf;
+};
+
+ZipfPicker picker;
+
+void usage()
+{
+    printf("./elb-bench.prog gen -o routeFile [-m modules] [-H maxHostsPerModule] [-s seed]\n");
+    printf("        [-i idcs] [-R racksPerIdc]\n");
+    printf("./elb-bench.prog run -r routeFile [-t seconds] [-w warmupSeconds] [-c apiThreads] [-a agentThreads]\n");
+    printf("        [-D dnsPort] [-d dnsConns] [-P reporterPort] [-q reportQps] [-S reporterStatFile]\n");
+    printf("        [-e errRate] [-z zipfS] [-s seed] [-o out.json]\n");
+    exit(1);
+}
+
+void parseOption(int argc, char** argv)
+{
+    if (argc < 2)
+        usage();
+    config.mode = argv[1];
+    for (int i = 2;i + 1 < argc; i += 2)
+    {
+        const char* opt = argv[i];
+        const char* val = argv[i + 1];
+        if (!strcmp(opt, "-o"))
+            config.outFile = val;
+        else if (!strcmp(opt, "-r"))
+            config.routeFile = val;
+        else if (!strcmp(opt, "-S"))
+            config.statFile = val;
+        else if (!strcmp(opt, "-m"))
+            config.modules = atoi(val);
+        else if (!strcmp(opt, "-H"))
+            config.maxHosts = atoi(val);
+        else if (!strcmp(opt, "-i"))
+            config.idcs = atoi(val);
+        else if (!strcmp(opt, "-R"))
+            config.racks = atoi(val);
+        else if (!strcmp(opt, "-s"))
+            config.seed = strtoull(val, NULL, 10);
+        else if (!strcmp(opt, "-t"))
+            config.duration = atoi(val);
+        else if (!strcmp(opt, "-w"))
+            config.warmup = atoi(val);
+        else if (!strcmp(opt, "-c"))
+            config.apiThreads = atoi(val);
+        else if (!strcmp(opt, "-a"))
+            config.agentThreads = atoi(val);
+        else if (!strcmp(opt, "-D"))
+            config.dnsPort = atoi(val);
+        else if (!strcmp(opt, "-d"))
+            config.dnsConns = atoi(val);
+        else if (!strcmp(opt, "-P"))
+            config.rptPort = atoi(val);
+        else if (!strcmp(opt, "-q"))
+            config.rptQps = atoi(val);
+        else if (!strcmp(opt, "-e"))
+            config.errRate = atof(val);
+        else if (!strcmp(opt, "-z"))
+            config.zipfS = atof(val);
+        else
+            usage();
+    }
+    if (!config.seed)
+        config.seed = 1;
+}
+
+//每个模块的节点数服从对数正态分布（中位数4，少数模块上百个节点），每个模块下分4个cmdid
+//节点按序号轮流落在各机房、机房内各机架（编号从1起），同一模块的节点分散在多个机房，以覆盖dnsserver的idc、rack下发
+int genRoute()
+{
+    if (!config.outFile || config.modules <= 0 || config.maxHosts <= 0 || config.idcs < 0 || config.racks <= 0)
+        usage();
+    FILE* fp = ::fopen(config.outFile, "w");
+    if (!fp)
+    {
+        perror("fopen");
+        return 1;
+    }
+    uint64_t rng = config.seed;
+    uint32_t hostSeq = 0;
+    long total = 0;
+    for (int m = 0;m < config.modules; ++m)
+    {
+        int modid = 10000 + m / 4;
+        int cmdid = 1001 + m % 4;
+        double u1 = nextUniform(rng), u2 = nextUniform(rng);
+        double gauss = sqrt(-2 * log(u1 + 1e-12)) * cos(2 * M_PI * u2);
+        int hosts = (int)(exp(log(4.0) + gauss) + 0.5);
+        hosts = std::max(1, std::min(config.maxHosts, hosts));
+        for (int h = 0;h < hosts; ++h)
+        {
+            ++hostSeq;
+            uint32_t ip = htonl((10u << 24) | (hostSeq & 0xffffff));
+            int port = 10000 + nextRand(rng) % 20000;
+            if (config.idcs)
+                fprintf(fp, "%d %d %u %d %u %u\n", modid, cmdid, ip, port,
+                    1 + hostSeq % config.idcs, 1 + hostSeq / config.idcs % config.racks);
+            else
+                fprintf(fp, "%d %d %u %d\n", modid, cmdid, ip, port);
+        }
+        total += hosts;
+    }
+    ::fclose(fp);
+    printf("%d modules, %ld hosts -> %s\n", config.modules, total, config.outFile);
+    return 0;
+}
+
+int loadRoute()
+{
+    FILE* fp = ::fopen(config.routeFile, "r");
+    if (!fp)
+    {
+        perror("fopen");
+        return -1;
+    }
+    __gnu_cxx::hash_map<uint64_t, size_t> index;
+    unsigned modid, cmdid, ip, port;
+    char line[256];
+    while (::fgets(line, sizeof line, fp))
+    {
+        if (::sscanf(line, "%u %u %u %u", &modid, &cmdid, &ip, &port) != 4)
+            continue;
+        uint64_t key = ((uint64_t)modid << 32) + cmdid;
+        __gnu_cxx::hash_map<uint64_t, size_t>::iterator it = index.find(key);
+        if (it == index.end())
+        {
+            it = index.insert(std::make_pair(key, modules.size())).first;
+            modules.push_back(Module());
+            modules.back().modid = modid;
+            modules.back().cmdid = cmdid;
+        }
+        modules[it->second].hosts.push_back(std::make_pair((uint32_t)ip, (int)port));
+    }
+    ::fclose(fp);
+    return modules.empty()? -1: 0;
+}
+
+struct ApiWorker
+{
+    ApiWorker(): client(NULL), rng(0) { }
+    elbClient* client;
+    uint64_t rng;
+    LatStat getHost;
+    LatStat report;
+};
+
+void* apiWorker(void* args)
+{
+    ApiWorker* w = (ApiWorker*)args;
+    elbHost host;
+    while (!stopping)
+    {
+        const Module& mod = picker.pick(w->rng);
+        uint64_t begin = nowNs();
+        int ret = w->client->apiGetHost(mod.modid, mod.cmdid, 10, host);
+        uint64_t end = nowNs();
+        if (recording)
+            w->getHost.add(end - begin, ret == 0);
+        if (ret != 0)
+            continue;
+        int retcode = nextUniform(w->rng) < config.errRate? 1: 0;
+        begin = nowNs();
+        w->client->apiReportRes(mod.modid, mod.cmdid, host, retcode);
+        end = nowNs();
+        if (recording)
+            w->report.add(end - begin, true);
+    }
+    return NULL;
+}
+
+void* agentWorker(void* args)
+{
+    ApiWorker* w = (ApiWorker*)args;
+    std::vector<std::pair<std::string, int> > route;
+    while (!stopping)
+    {
+        const Module& mod = picker.pick(w->rng);
+        route.clear();
+        uint64_t begin = nowNs();
+        int ret = w->client->apiGetRoute(mod.modid, mod.cmdid, route);
+        uint64_t end = nowNs();
+        if (recording)
+            w->getHost.add(end - begin, ret == 0);
+    }
+    return NULL;
+}
+
+//reactor线程内的状态，只由reactor线程读写，结束时主线程在stopping之后读取
+struct DnsConn
+{
+    uint64_t sentNs;
+    uint64_t rng;
+    LatStat* stat;
+};
+
+struct RptCtx
+{
+    RptCtx(): started(false), rng(0), sent(0), sentResults(0), remain(0) { }
+    bool started;
+    uint64_t rng;
+    long sent;
+    long sentResults;
+    double remain;//本周期未发完的配额
+};
+
+LatStat dnsStat;
+RptCtx rptCtx;
+
+static void sendGetRoute(net_commu* commu, DnsConn* conn)
+{
+    const Module& mod = picker.pick(conn->rng);
+    elb::GetRouteReq req;
+    req.set_modid(mod.modid);
+    req.set_cmdid(mod.cmdid);
+    std::string reqStr;
+    req.SerializeToString(&reqStr);
+    conn->sentNs = nowNs();
+    commu->send_data(reqStr.c_str(), reqStr.size(), elb::GetRouteByAgentReqId);
+}
+
+void onDnsRsp(const char* data, uint32_t len, int msgId, net_commu* commu, void* usr_data)
+{
+    DnsConn* conn = (DnsConn*)usr_data;
+    elb::GetRouteRsp rsp;
+    bool ok = rsp.ParseFromArray(data, len);
+    if (recording)
+        conn->stat->add(nowNs() - conn->sentNs, ok && rsp.hosts_size() > 0);
+    if (!stopping)
+        sendGetRoute(commu, conn);
+}
+
+void onDnsConnected(tcp_client* client, void* args)
+{
+    sendGetRoute(client, (DnsConn*)args);
+}
+
+void sendReports(event_loop* loop, void* usr_data)
+{
+    tcp_client* client = (tcp_client*)usr_data;
+    if (stopping)
+        return ;
+    rptCtx.remain += config.rptQps * REPORT_TICK_MS / 1000.0;
+    std::string reqStr;
+    while (rptCtx.remain >= 1)
+    {
+        rptCtx.remain -= 1;
+        const Module& mod = picker.pick(rptCtx.rng);
+        elb::ReportStatusReq req;
+        req.set_modid(mod.modid);
+        req.set_cmdid(mod.cmdid);
+        req.set_caller(1);
+        req.set_ts(time(NULL));
+        int n = std::min((int)mod.hosts.size(), MAX_REPORT_HOSTS);
+        for (int i = 0;i < n; ++i)
+        {
+            elb::HostCallResult* res = req.add_results();
+            res->set_ip(mod.hosts[i].first);
+            res->set_port(mod.hosts[i].second);
+            res->set_succ(100);
+            res->set_err(nextRand(rptCtx.rng) % 3);
+            res->set_overload(false);
+        }
+        req.SerializeToString(&reqStr);
+        client->send_data(reqStr.c_str(), reqStr.size(), elb::ReportStatusReqId);
+        if (recording)
+        {
+            ++rptCtx.sent;
+            rptCtx.sentResults += n;
+        }
+    }
+}
+
+void onRptConnected(tcp_client* client, void* args)
+{
+    if (rptCtx.started)
+        return ;
+    rptCtx.started = true;
+    client->loop()->run_every(sendReports, client, 0, REPORT_TICK_MS);
+}
+
+void* reactorMain(void* args)
+{
+    event_loop loop;
+    std::vector<DnsConn> conns(config.dnsConns);
+    for (int i = 0;i < config.dnsConns; ++i)
+    {
+        conns[i].rng = config.seed * 7919 + i + 1;
+        conns[i].stat = &dnsStat;
+        tcp_client* cli = new tcp_client(&loop, "127.0.0.1", config.dnsPort);
+        cli->add_msg_cb(elb::GetRouteByAgentRspId, onDnsRsp, &conns[i]);
+        cli->onConnection(onDnsConnected, &conns[i]);
+    }
+    if (config.rptQps > 0)
+    {
+        rptCtx.rng = config.seed * 104729 + 1;
+        tcp_client* cli = new tcp_client(&loop, "127.0.0.1", config.rptPort);
+        cli->onConnection(onRptConnected);
+    }
+    loop.process_evs();
+    return NULL;
+}
+
+static const BenchDbStat* mapStat(const char* path)
+{
+    int fd = ::open(path, O_RDONLY);
+    if (fd == -1)
+        return NULL;
+    void* base = ::mmap(NULL, sizeof(BenchDbStat), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    return base == MAP_FAILED? NULL: (const BenchDbStat*)base;
+}
+
+static void printStat(FILE* fp, const char* name, const LatStat& stat, double secs, bool last = false)
+{
+    const LatencyHist& h = stat.hist;
+    fprintf(fp, "  \"%s\": {\"ops\": %lu, \"errors\": %ld, \"qps\": %.1f, "
+        "\"p50_us\": %.3f, \"p90_us\": %.3f, \"p99_us\": %.3f, \"p999_us\": %.3f, \"max_us\": %.3f}%s\n",
+        name, (unsigned long)h.count(), stat.errs, h.count() / secs, h.percentile(50) / 1000.0,
+        h.percentile(90) / 1000.0, h.percentile(99) / 1000.0, h.percentile(99.9) / 1000.0, h.max() / 1000.0,
+        last? "": ",");
+}
+
+int runBench()
+{
+    if (!config.routeFile || config.duration <= 0 || config.apiThreads < 0 || config.agentThreads < 0 ||
+        config.dnsConns < 0 || config.rptQps < 0)
+        usage();
+    if (loadRoute() != 0)
+    {
+        fprintf(stderr, "no route in %s\n", config.routeFile);
+        return 1;
+    }
+    long hostCnt = 0;
+    for (size_t i = 0;i < modules.size(); ++i)
+        hostCnt += modules[i].hosts.size();
+    picker.init(modules.size(), config.zipfS, config.seed);
+
+    const BenchDbStat* rptDb = NULL;
+    if (config.statFile && !(rptDb = mapStat(config.statFile)))
+        fprintf(stderr, "can not map %s, reporter stored results unknown\n", config.statFile);
+
+    elbClient client;
+    std::vector<ApiWorker> apis(config.apiThreads), agents(config.agentThreads);
+    std::vector<pthread_t> tids;
+    for (int i = 0;i < config.apiThreads + config.agentThreads; ++i)
+    {
+        bool isApi = i < config.apiThreads;
+        ApiWorker& w = isApi? apis[i]: agents[i - config.apiThreads];
+        w.client = &client;
+        w.rng = config.seed * 31 + i + 1;
+        pthread_t tid;
+        if (::pthread_create(&tid, NULL, isApi? apiWorker: agentWorker, &w) != 0)
+        {
+            perror("pthread_create");
+            return 1;
+        }
+        tids.push_back(tid);
+    }
+    pthread_t reactorTid;
+    if (::pthread_create(&reactorTid, NULL, reactorMain, NULL) != 0)
+    {
+        perror("pthread_create");
+        return 1;
+    }
+    ::pthread_detach(reactorTid);
+
+    //预热：agent向dnsserver拉取路由、API建立路由快照，这段时间的请求不统计
+    ::sleep(config.warmup);
+    uint64_t storedBegin = rptDb? rptDb->inserts: 0;
+    uint64_t begin = nowNs();
+    recording = true;
+    ::sleep(config.duration);
+    recording = false;
+    double secs = (nowNs() - begin) / 1e9;
+    stopping = true;
+    for (size_t i = 0;i < tids.size(); ++i)
+        ::pthread_join(tids[i], NULL);
+    //reactor线程不再发请求，等已发出的上报被reporter写完
+    ::sleep(1);
+    __sync_synchronize();
+    uint64_t stored = rptDb? rptDb->inserts - storedBegin: 0;
+
+    LatStat getHost, report, getRoute;
+    for (size_t i = 0;i < apis.size(); ++i)
+    {
+        getHost.merge(apis[i].getHost);
+        report.merge(apis[i].report);
+    }
+    for (size_t i = 0;i < agents.size(); ++i)
+        getRoute.merge(agents[i].getHost);
+
+    FILE* fp = config.outFile? ::fopen(config.outFile, "w"): stdout;
+    if (!fp)
+    {
+        perror("fopen");
+        return 1;
+    }
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"config\": {\"modules\": %lu, \"hosts\": %ld, \"seconds\": %.3f, \"api_threads\": %d, "
+        "\"agent_threads\": %d, \"dns_conns\": %d, \"report_qps\": %d, \"err_rate\": %.4f, \"zipf_s\": %.2f, "
+        "\"seed\": %llu},\n", modules.size(), hostCnt, secs, config.apiThreads, config.agentThreads,
+        config.dnsConns, config.rptQps, config.errRate, config.zipfS, (unsigned long long)config.seed);
+    printStat(fp, "api_get_host", getHost, secs);
+    printStat(fp, "api_report", report, secs);
+    printStat(fp, "agent_get_route", getRoute, secs);
+    printStat(fp, "dnsserver_get_route", dnsStat, secs);
+    fprintf(fp, "  \"reporter\": {\"sent_reqs\": %ld, \"sent_results\": %ld, \"send_qps\": %.1f, ",
+        rptCtx.sent, rptCtx.sentResults, rptCtx.sentResults / secs);
+    if (rptDb)
+        fprintf(fp, "\"stored_results\": %llu, \"store_qps\": %.1f}\n", (unsigned long long)stored, stored / secs);
+    else
+        fprintf(fp, "\"stored_results\": null, \"store_qps\": null}\n");
+    fprintf(fp, "}\n");
+    if (fp != stdout)
+        ::fclose(fp);
+    //reactor线程的loop不会返回，直接退出
+    ::exit(0);
+}
+
+int main(int argc, char** argv)
+{
+    parseOption(argc, argv);
+    if (!strcmp(config.mode, "gen"))
+        return genRoute();
+    if (!strcmp(config.mode, "run"))
+        return runBench();
+    usage();
+    return 1;
+}
@@ -0,0 +1,161 @@
+#include <math.h>
+#include <stdio.h>
+#include <string>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+#include <arpa/inet.h>
+#include "consistentHash.h"
+
+//一致性哈希（common/base/include/consistentHash.h）的分布检查：对几组典型的节点集合，用两种策略建表，
+//统计大量key落到各节点的比例，任一节点偏离平均值超过容忍度即失败；再检查删除一个节点后换节点的key比例
+//节点组包括只差ip第三段、只差端口的节点，agent与API以ip << 32 + port（ip为网络序）表示节点，这些节点只差少数几位
+//以及上千、上万个节点的大模块：Maglev表须随节点数增大，节点过多时改用哈希环
+//任一检查不通过时退出码为1，bench/Makefile的hashcheck目标据此做回归
+
+#define CHECK_KEYS 1000000
+#define KEYS_PER_HOST 1000//节点多时按节点数增加key数，每节点平均至少这么多个key
+#define MAGLEV_TOLERANCE 0.1//Maglev每个节点的表项数几乎相同
+#define RING_TOLERANCE 0.5  //哈希环每节点160个虚节点，占比的波动在百分之十几
+#define MAGLEV_EXTRA_MOVED 0.005//Maglev删除节点后表项的认领顺序变化，另有少量key换节点，节点多时约千分之几
+
+struct AllUsable
+{
+    bool operator()(int idx) const { return true; }
+};
+
+//ip为点分字符串，转为与API、agent相同的网络序表示
+static uint64_t hostOf(const char* ip, int port)
+{
+    return ((uint64_t)inet_addr(ip) << 32) + port;
+}
+
+static std::vector<uint64_t> hostGroup(const std::string& name)
+{
+    std::vector<uint64_t> hosts;
+    char ip[32];
+    if (name == "last-octet")
+    {
+        for (int i = 1;i <= 10; ++i)
+        {
+            snprintf(ip, sizeof ip, "10.0.0.%d", i);
+            hosts.push_back(hostOf(ip, 80));
+        }
+    }
+    else if (name == "third-octet")
+    {
+        for (int i = 1;i <= 4; ++i)
+        {
+            snprintf(ip, sizeof ip, "10.0.%d.5", i);
+            hosts.push_back(hostOf(ip, 80));
+        }
+    }
+    else if (name == "third-octet-16")
+    {
+        for (int i = 0;i < 16; ++i)
+        {
+            snprintf(ip, sizeof ip, "10.1.%d.7", i * 16);
+            hosts.push_back(hostOf(ip, 6379));
+        }
+    }
+    else if (name == "large-2000" || name == "large-12000")
+    {
+        //大模块：节点遍布10.x.y.z，Maglev分别为随节点数增大的表、超出表大小上限改用哈希环
+        int n = name == "large-2000"? 2000: 12000;
+        for (int i = 0;i < n; ++i)
+        {
+            snprintf(ip, sizeof ip, "10.%d.%d.%d", i / 4000, i / 16 % 250, i % 16 + 1);
+            hosts.push_back(hostOf(ip, 8080));
+        }
+    }
+    else if (name == "port")
+    {
+        for (int i = 0;i < 8; ++i)
+            hosts.push_back(hostOf("10.0.0.1", 11211 + i));
+    }
+    return hosts;
+}
+
+//key落到各节点的个数
+static void distribute(const ConsistentHash& chash, uint64_t keys, std::vector<int>& counts)
+{
+    AllUsable usable;
+    counts.assign(chash.hosts().size(), 0);
+    for (uint64_t k = 0;k < keys; ++k)
+    {
+        int primary;
+        int idx = chash.pick(k, usable, primary);
+        if (idx >= 0)
+            ++counts[idx];
+    }
+}
+
+static bool checkGroup(const std::string& name, int policy, const char* policyName, double tolerance)
+{
+    std::vector<uint64_t> hosts = hostGroup(name);
+    ConsistentHash chash;
+    chash.build(policy, 0, hosts);
+    //maglev节点过多时改用哈希环，按哈希环的容忍度检查
+    if (chash.ringFallback())
+        tolerance = RING_TOLERANCE;
+    uint64_t keys = std::max((uint64_t)CHECK_KEYS, (uint64_t)hosts.size() * KEYS_PER_HOST);
+    std::vector<int> counts;
+    distribute(chash, keys, counts);
+    double mean = (double)keys / counts.size();
+    //抽样误差：每节点的key数近似泊松分布，所有节点中的最大偏差约4.5个标准差
+    tolerance += 4.5 / sqrt(mean);
+    //没有分到key的节点偏差为100%，必然失败
+    double worst = 0;
+    for (size_t i = 0;i < counts.size(); ++i)
+    {
+        double dev = counts[i] / mean - 1;
+        if (dev < 0)
+            dev = -dev;
+        if (dev > worst)
+            worst = dev;
+    }
+    //删除一个节点：只有原先落在它上面的key、加上少量被顺带挪动的key换节点
+    std::vector<uint64_t> fewer(hosts.begin() + 1, hosts.end());
+    ConsistentHash after;
+    after.build(policy, 0, fewer);
+    AllUsable usable;
+    int moved = 0;
+    for (uint64_t k = 0;k < keys; ++k)
+    {
+        int p1, p2;
+        uint64_t h1 = chash.hosts()[chash.pick(k, usable, p1)];
+        uint64_t h2 = after.hosts()[after.pick(k, usable, p2)];
+        if (h1 != h2)
+            ++moved;
+    }
+    double movedRate = (double)moved / keys;
+    double expectMoved = 1.0 / hosts.size();
+    double movedLimit = expectMoved * 1.5;
+    if (!chash.ringFallback() && policy == HASH_MAGLEV)
+        movedLimit += MAGLEV_EXTRA_MOVED;
+    bool ok = worst <= tolerance && movedRate <= movedLimit;
+    printf("%s %-7s %-15s hosts %5lu  max deviation %5.1f%%  moved after removing one %6.3f%% (ideal %6.3f%%)\n",
+        ok? "PASS": "FAIL", chash.ringFallback()? "ring*": policyName, name.c_str(), hosts.size(), worst * 100, movedRate * 100, expectMoved * 100);
+    if (!ok && counts.size() <= 16)
+    {
+        for (size_t i = 0;i < counts.size(); ++i)
+            printf("    host %lu: %d keys\n", i, counts[i]);
+    }
+    return ok;
+}
+
+int main()
+{
+    const char* groups[] = {"last-octet", "third-octet", "third-octet-16", "port", "large-2000", "large-12000"};
+    bool ok = true;
+    for (size_t i = 0;i < sizeof groups / sizeof groups[0]; ++i)
+    {
+        if (!checkGroup(groups[i], HASH_MAGLEV, "maglev", MAGLEV_TOLERANCE))
+            ok = false;
+        //maglev超出表大小上限的组已按哈希环检查过
+        if (strcmp(groups[i], "large-12000") && !checkGroup(groups[i], HASH_RING, "ring", RING_TOLERANCE))
+            ok = false;
+    }
+    return ok? 0: 1;
+}
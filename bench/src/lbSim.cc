@@ -0,0 +1,520 @@
+#include <math.h>
+#include <time.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "elb.pb.h"
+#include "Server.h"
+#include "RouteLb.h"
+#include "config_reader.h"
+
+//LB算法的离线模拟器：RouteLb.cc以-DELB_VIRTUAL_CLOCK编译，时钟由本程序推进（见coarseClock.h），不sleep
+//按场景脚本给每个节点安排行为（dead/slow/err/flap/recover/burst），以agent UDP线程的方式驱动RouteLB：
+//getHost -> 按节点此刻的行为决定调用结果 -> report，按fold_interval合并暂存结果，每秒tick推进时间轮
+//统计过载判定的收敛时间、漏到故障节点的调用、试探overload节点的代价、误判，以JSON输出
+//场景中的expect不满足时退出码为1，bench/Makefile的sim目标据此对scenarios/下所有场景做回归
+
+#define SIM_START_MS 1000000//虚拟时钟的起点，避开0值
+#define POLL_MS 10//多久采样一次各节点的idle/overload状态
+#define SIM_MODID 1
+#define SIM_CMDID 1
+#define HOST_IP_BASE ((10u << 24) + 1)
+
+thread_queue<elb::GetRouteReq>* pullQueue = NULL;
+thread_queue<elb::ReportStatusReq>* reptQueue = NULL;
+RouteLB* routeLB[3];
+
+uint64_t virtualClockMs = SIM_START_MS;
+
+enum BEHAVIOR
+{
+    DEAD,   //每次调用都失败
+    SLOW,   //每次调用都超时失败，上报带耗时
+    ERR,    //按比例失败
+    FLAP,   //周期性不可用
+    RECOVER,//失败率从1线性降到0
+    BURST   //按调用次序成段失败：每errs次失败后跟succs次成功
+};
+
+struct Event
+{
+    double from;
+    double to;
+    int host;
+    BEHAVIOR behavior;
+    double arg1;
+    double arg2;
+};
+
+struct RateSeg
+{
+    double from;
+    double to;
+    double qps;
+};
+
+struct Expect
+{
+    std::string metric;
+    std::string op;
+    double value;
+};
+
+struct Scenario
+{
+    Scenario(): hosts(0), duration(60), qps(1000), baseline(0), seed(1) {}
+    int hosts;
+    double duration;
+    double qps;
+    double baseline;
+    uint64_t seed;
+    std::vector<Event> events;
+    std::vector<RateSeg> rates;
+    std::vector<Expect> expects;
+};
+
+//每个节点的故障时段（episode）跟踪
+struct HostTrack
+{
+    HostTrack(): faulty(false), down(false), detected(false), awaitRecover(false), faultStartMs(0), faultEndMs(0), burstCalls(0) {}
+    bool faulty;//按场景，此刻是否处于故障
+    bool down;//最近一次采样时LB是否将其判为overload
+    bool detected;//本次故障是否已被判为overload
+    bool awaitRecover;//故障已结束、仍处于overload，等待恢复
+    uint64_t faultStartMs;
+    uint64_t faultEndMs;
+    uint64_t burstCalls;//burst时段内发往此节点的调用数，决定每次调用在失败、成功段中的位置
+};
+
+struct SimStat
+{
+    SimStat(): requests(0), errors(0), faultyCalls(0), rejected(0), probes(0), probeErrors(0), episodes(0),
+        undetected(0), falseOverloads(0), healthyDownMs(0) {}
+    long requests;
+    long errors;
+    long faultyCalls;//发往故障节点的调用
+    long rejected;//所有节点都overload，getHost直接返回OVERLOAD
+    long probes;//发往已被判为overload的节点的调用
+    long probeErrors;
+    long episodes;
+    long undetected;//故障期间始终未被判为overload的故障时段
+    long falseOverloads;//节点无故障时被判为overload的次数
+    uint64_t healthyDownMs;//节点无故障时处于overload的总时长，不含故障结束后等待恢复的时间
+    std::vector<double> detectSec;
+    std::vector<double> recoverSec;
+};
+
+Scenario scen;
+std::vector<HostTrack> tracks;
+SimStat simStat;
+
+static inline uint64_t nextRand(uint64_t& s)
+{
+    s ^= s >> 12;
+    s ^= s << 25;
+    s ^= s >> 27;
+    return s * 2685821657736338717ULL;
+}
+
+static inline double nextUniform(uint64_t& s)
+{
+    return (nextRand(s) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static uint64_t nowNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+//解析场景脚本，见bench/README.md
+bool loadScenario(const char* path)
+{
+    FILE* fp = ::fopen(path, "r");
+    if (!fp)
+    {
+        perror("fopen");
+        return false;
+    }
+    char line[512];
+    int lineNo = 0;
+    bool ok = true;
+    while (ok && ::fgets(line, sizeof line, fp))
+    {
+        ++lineNo;
+        char* hash = strchr(line, '#');
+        if (hash)
+            *hash = '\0';
+        char key[32], name[32], op[8];
+        double a, b, c, d;
+        if (::sscanf(line, "%31s", key) != 1)
+            continue;
+        if (!strcmp(key, "hosts"))
+            ok = ::sscanf(line, "%*s %d", &scen.hosts) == 1 && scen.hosts > 0;
+        else if (!strcmp(key, "duration"))
+            ok = ::sscanf(line, "%*s %lf", &scen.duration) == 1 && scen.duration > 0;
+        else if (!strcmp(key, "qps"))
+            ok = ::sscanf(line, "%*s %lf", &scen.qps) == 1 && scen.qps > 0;
+        else if (!strcmp(key, "baseline"))
+            ok = ::sscanf(line, "%*s %lf", &scen.baseline) == 1;
+        else if (!strcmp(key, "seed"))
+            ok = ::sscanf(line, "%*s %lf", &a) == 1 && (scen.seed = (uint64_t)a) != 0;
+        else if (!strcmp(key, "rate"))
+        {
+            RateSeg seg;
+            ok = ::sscanf(line, "%*s %lf %lf %lf", &seg.from, &seg.to, &seg.qps) == 3 && seg.qps > 0;
+            scen.rates.push_back(seg);
+        }
+        else if (!strcmp(key, "event"))
+        {
+            Event ev;
+            int n = ::sscanf(line, "%*s %lf %lf %d %31s %lf %lf", &a, &b, &ev.host, name, &c, &d);
+            ev.from = a;
+            ev.to = b;
+            ev.arg1 = n > 4? c: 0;
+            ev.arg2 = n > 5? d: 0;
+            ok = n >= 4 && ev.host >= 0 && ev.host < scen.hosts;
+            if (!strcmp(name, "dead"))
+                ev.behavior = DEAD;
+            else if (!strcmp(name, "slow"))
+                ok = ok && n >= 5, ev.behavior = SLOW;
+            else if (!strcmp(name, "err"))
+                ok = ok && n >= 5, ev.behavior = ERR;
+            else if (!strcmp(name, "flap"))
+                ok = ok && n >= 6 && c > 0, ev.behavior = FLAP;
+            else if (!strcmp(name, "recover"))
+                ev.behavior = RECOVER;
+            else if (!strcmp(name, "burst"))
+                ok = ok && n >= 6 && c >= 1 && d >= 0, ev.behavior = BURST;
+            else
+                ok = false;
+            scen.events.push_back(ev);
+        }
+        else if (!strcmp(key, "expect"))
+        {
+            Expect exp;
+            ok = ::sscanf(line, "%*s %31s %7s %lf", name, op, &exp.value) == 3;
+            exp.metric = name;
+            exp.op = op;
+            scen.expects.push_back(exp);
+        }
+        else
+        {
+            ok = false;
+        }
+        if (!ok)
+            fprintf(stderr, "%s:%d: bad line\n", path, lineNo);
+    }
+    ::fclose(fp);
+    if (ok && !scen.hosts)
+    {
+        fprintf(stderr, "%s: hosts is required\n", path);
+        ok = false;
+    }
+    return ok;
+}
+
+//t秒时节点host的失败概率，tcost为失败调用上报的耗时（毫秒）；burst按其失败调用的占比
+double failProb(int host, double t, uint32_t& tcost)
+{
+    double p = scen.baseline;
+    tcost = 0;
+    for (size_t i = 0;i < scen.events.size(); ++i)
+    {
+        const Event& ev = scen.events[i];
+        if (ev.host != host || t < ev.from || t >= ev.to)
+            continue;
+        double q = 0;
+        switch (ev.behavior)
+        {
+            case DEAD:
+                q = 1;
+                break;
+            case SLOW:
+                q = 1;
+                tcost = (uint32_t)ev.arg1;
+                break;
+            case ERR:
+                q = ev.arg1;
+                break;
+            case FLAP:
+                q = fmod(t - ev.from, ev.arg1) < ev.arg2? 1: 0;
+                break;
+            case RECOVER:
+                q = 1 - (t - ev.from) / (ev.to - ev.from);
+                break;
+            case BURST:
+                q = ev.arg1 / (ev.arg1 + ev.arg2);
+                break;
+        }
+        p = std::max(p, q);
+    }
+    return p;
+}
+
+//t秒时节点host处于burst时段则返回该事件，否则返回NULL
+const Event* burstOf(int host, double t)
+{
+    for (size_t i = 0;i < scen.events.size(); ++i)
+    {
+        const Event& ev = scen.events[i];
+        if (ev.host == host && ev.behavior == BURST && t >= ev.from && t < ev.to)
+            return &ev;
+    }
+    return NULL;
+}
+
+double currentQps(double t)
+{
+    for (size_t i = 0;i < scen.rates.size(); ++i)
+    {
+        if (t >= scen.rates[i].from && t < scen.rates[i].to)
+            return scen.rates[i].qps;
+    }
+    return scen.qps;
+}
+
+//采样各节点此刻的idle/overload状态，推进故障时段的跟踪
+void poll(RouteLB* lb, long& version)
+{
+    elb::CacheGetRouteRsp rsp;
+    lb->cacheGetRoute(SIM_MODID, SIM_CMDID, version, 0, rsp);
+    version = rsp.version();
+    std::vector<bool> down(scen.hosts, false);
+    for (int i = 0;i < rsp.downs_size(); ++i)
+    {
+        int idx = (int)((uint32_t)rsp.downs(i).ip() - HOST_IP_BASE);
+        if (idx >= 0 && idx < scen.hosts)
+            down[idx] = true;
+    }
+    uint64_t nowMs = virtualClockMs - SIM_START_MS;
+    double t = nowMs / 1000.0;
+    for (int i = 0;i < scen.hosts; ++i)
+    {
+        HostTrack& tr = tracks[i];
+        uint32_t tcost;
+        bool faulty = failProb(i, t, tcost) > scen.baseline;
+        if (faulty && !tr.faulty)
+        {
+            ++simStat.episodes;
+            tr.faultStartMs = nowMs;
+            tr.detected = false;
+            tr.awaitRecover = false;
+        }
+        if (faulty && !tr.detected && down[i])
+        {
+            tr.detected = true;
+            simStat.detectSec.push_back((nowMs - tr.faultStartMs) / 1000.0);
+        }
+        if (!faulty && tr.faulty)
+        {
+            if (!tr.detected)
+                ++simStat.undetected;
+            tr.awaitRecover = down[i];
+            tr.faultEndMs = nowMs;
+        }
+        if (!faulty)
+        {
+            if (tr.awaitRecover && !down[i])
+            {
+                tr.awaitRecover = false;
+                simStat.recoverSec.push_back((nowMs - tr.faultEndMs) / 1000.0);
+            }
+            if (down[i] && !tr.down && !tr.awaitRecover)
+                ++simStat.falseOverloads;
+            if (down[i] && !tr.awaitRecover)
+                simStat.healthyDownMs += POLL_MS;
+        }
+        tr.faulty = faulty;
+        tr.down = down[i];
+    }
+}
+
+static double quantile(std::vector<double>& v, double p)
+{
+    if (v.empty())
+        return 0;
+    std::sort(v.begin(), v.end());
+    size_t idx = std::min(v.size() - 1, (size_t)(p * v.size()));
+    return v[idx];
+}
+
+static bool check(double value, const std::string& op, double expect)
+{
+    if (op == "<=")
+        return value <= expect;
+    if (op == ">=")
+        return value >= expect;
+    if (op == "<")
+        return value < expect;
+    if (op == ">")
+        return value > expect;
+    if (op == "==")
+        return value == expect;
+    return false;
+}
+
+int main(int argc, char** argv)
+{
+    const char* scenFile = NULL;
+    const char* confFile = "../lbagent/conf/lbagent.ini";
+    const char* outFile = NULL;
+    for (int i = 1;i + 1 < argc; i += 2)
+    {
+        if (!strcmp(argv[i], "-f"))
+            scenFile = argv[i + 1];
+        else if (!strcmp(argv[i], "-c"))
+            confFile = argv[i + 1];
+        else if (!strcmp(argv[i], "-o"))
+            outFile = argv[i + 1];
+    }
+    if (!scenFile)
+    {
+        printf("./lb-sim.prog -f scenario [-c lbagent.ini] [-o out.json]\n");
+        return 1;
+    }
+    if (!loadScenario(scenFile))
+        return 1;
+    //未调用_init_log_，LB算法中的日志不输出，不干扰结果
+    FILE* out = outFile? ::fopen(outFile, "w"): stdout;
+    if (!out)
+    {
+        perror("open output");
+        return 1;
+    }
+
+    config_reader::setPath(confFile);
+    pullQueue = new thread_queue<elb::GetRouteReq>();
+    reptQueue = new thread_queue<elb::ReportStatusReq>();
+    RouteLB* lb = new RouteLB(1);
+    routeLB[0] = lb;
+
+    //首次访问创建模块，再以dnsserver应答的方式装入路由
+    elb::GetHostRsp first;
+    lb->getHost(SIM_MODID, SIM_CMDID, first);
+    elb::GetRouteRsp route;
+    route.set_modid(SIM_MODID);
+    route.set_cmdid(SIM_CMDID);
+    for (int i = 0;i < scen.hosts; ++i)
+    {
+        elb::HostAddr* host = route.add_hosts();
+        host->set_ip(HOST_IP_BASE + i);
+        host->set_port(8000 + i);
+    }
+    lb->update(SIM_MODID, SIM_CMDID, route);
+    tracks.resize(scen.hosts);
+
+    uint64_t rng = scen.seed;
+    int foldMs = lb->foldInterval();
+    uint64_t nextTick = virtualClockMs + 1000, nextFold = virtualClockMs + foldMs, nextPoll = virtualClockMs;
+    long version = -2;
+    double tUs = 0, endUs = scen.duration * 1e6;
+    uint64_t wallBegin = nowNs();
+    while (tUs < endUs)
+    {
+        virtualClockMs = SIM_START_MS + (uint64_t)(tUs / 1000);
+        while (virtualClockMs >= nextTick)
+        {
+            lb->tick();
+            nextTick += 1000;
+        }
+        while (foldMs > 0 && virtualClockMs >= nextFold)
+        {
+            lb->foldPending();
+            nextFold += foldMs;
+        }
+        if (virtualClockMs >= nextPoll)
+        {
+            poll(lb, version);
+            nextPoll += POLL_MS;
+        }
+
+        double t = tUs / 1e6;
+        elb::GetHostRsp rsp;
+        lb->getHost(SIM_MODID, SIM_CMDID, rsp);
+        ++simStat.requests;
+        if (rsp.retcode() == OVERLOAD)
+        {
+            ++simStat.rejected;
+        }
+        else if (rsp.retcode() == SUCCESS)
+        {
+            int idx = (int)((uint32_t)rsp.host().ip() - HOST_IP_BASE);
+            uint32_t tcost;
+            double p = failProb(idx, t, tcost);
+            const Event* burst = burstOf(idx, t);
+            bool fail = burst? tracks[idx].burstCalls++ % (uint64_t)(burst->arg1 + burst->arg2) < burst->arg1:
+                nextUniform(rng) < p;
+            if (p > scen.baseline)
+                ++simStat.faultyCalls;
+            if (tracks[idx].down)
+            {
+                ++simStat.probes;
+                if (fail)
+                    ++simStat.probeErrors;
+            }
+            if (fail)
+                ++simStat.errors;
+            lb->report(SIM_MODID, SIM_CMDID, rsp.host().ip(), rsp.host().port(), fail? 1: 0, fail? tcost: 0);
+        }
+        tUs += 1e6 / currentQps(t);
+    }
+    double wallSec = (nowNs() - wallBegin) / 1e9;
+    //LB实际跟踪的节点数：划分子集时只有子集内的节点
+    elb::CacheGetRouteRsp tracked;
+    lb->cacheGetRoute(SIM_MODID, SIM_CMDID, -2, 0, tracked);
+
+    double reqs = simStat.requests? simStat.requests: 1;
+    struct Metric
+    {
+        const char* name;
+        double value;
+    } metrics[] = {
+        {"requests", (double)simStat.requests},
+        {"errors", (double)simStat.errors},
+        {"err_rate", simStat.errors / reqs},
+        {"faulty_calls", (double)simStat.faultyCalls},
+        {"faulty_call_rate", simStat.faultyCalls / reqs},
+        {"rejected", (double)simStat.rejected},
+        {"probes", (double)simStat.probes},
+        {"probe_rate", simStat.probes / reqs},
+        {"probe_errors", (double)simStat.probeErrors},
+        {"episodes", (double)simStat.episodes},
+        {"undetected", (double)simStat.undetected},
+        {"detect_p50_s", quantile(simStat.detectSec, 0.5)},
+        {"detect_max_s", simStat.detectSec.empty()? 0: quantile(simStat.detectSec, 1)},
+        {"recover_p50_s", quantile(simStat.recoverSec, 0.5)},
+        {"recover_max_s", simStat.recoverSec.empty()? 0: quantile(simStat.recoverSec, 1)},
+        {"false_overloads", (double)simStat.falseOverloads},
+        {"healthy_down_s", simStat.healthyDownMs / 1000.0},
+        {"tracked_hosts", (double)tracked.route_size()},
+    };
+    int metricCnt = sizeof(metrics) / sizeof(metrics[0]);
+
+    fprintf(out, "{\n  \"scenario\": \"%s\",\n  \"sim_seconds\": %.1f,\n  \"wall_seconds\": %.3f,\n"
+        "  \"req_per_wall_sec\": %.0f,\n", scenFile, scen.duration, wallSec, simStat.requests / wallSec);
+    for (int i = 0;i < metricCnt; ++i)
+        fprintf(out, "  \"%s\": %.6g,\n", metrics[i].name, metrics[i].value);
+    fprintf(out, "  \"expect\": [");
+    int failed = 0;
+    for (size_t i = 0;i < scen.expects.size(); ++i)
+    {
+        const Expect& exp = scen.expects[i];
+        int m = 0;
+        while (m < metricCnt && exp.metric != metrics[m].name)
+            ++m;
+        bool pass = m < metricCnt && check(metrics[m].value, exp.op, exp.value);
+        if (!pass)
+            ++failed;
+        fprintf(out, "%s\n    {\"rule\": \"%s %s %g\", \"value\": %.6g, \"pass\": %s}", i? ",": "",
+            exp.metric.c_str(), exp.op.c_str(), exp.value, m < metricCnt? metrics[m].value: 0.0, pass? "true": "false");
+    }
+    fprintf(out, "%s]\n}\n", scen.expects.empty()? "": "\n  ");
+    ::fclose(out);
+    return failed? 1: 0;
+}
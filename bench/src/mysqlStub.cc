@@ -0,0 +1,260 @@
+#include "mysql.h"
+#include "benchDb.h"
+#include <stdio.h>
+#include <fcntl.h>
+#include <string>
+#include <vector>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+//替代libmysqlclient链接进bench版的dnsserver与reporter，只实现它们用到的接口，约定见benchDb.h
+//每个MYSQL连接的私有状态挂在MYSQL::extension上，结果集挂在MYSQL_RES::extension上
+
+struct StubConn
+{
+    StubConn(): stat(NULL), pending(NULL), cols(0) { }
+    std::string path;
+    BenchDbStat* stat;
+    std::vector<std::string>* pending;//最近一次SELECT的结果，按行优先存放
+    unsigned cols;
+};
+
+struct StubResult
+{
+    std::vector<std::string> cells;
+    std::vector<char*> row;
+    unsigned cols;
+    my_ulonglong rows;
+    my_ulonglong cursor;
+};
+
+static void setError(MYSQL* mysql, const char* msg)
+{
+    snprintf(mysql->net.last_error, sizeof(mysql->net.last_error), "%s", msg);
+}
+
+static bool startsWith(const char* q, const char* prefix)
+{
+    return !strncasecmp(q, prefix, strlen(prefix));
+}
+
+static bool loadRoutes(StubConn* conn, std::vector<std::string>& cells)
+{
+    FILE* fp = ::fopen(conn->path.c_str(), "r");
+    if (!fp)
+        return false;
+    long id = 0;
+    unsigned modid, cmdid, ip, port, idc, rack;
+    char line[256];
+    while (::fgets(line, sizeof line, fp))
+    {
+        idc = rack = 0;//老格式的行没有idc、rack两列，与表结构的默认值一致
+        if (::sscanf(line, "%u %u %u %u %u %u", &modid, &cmdid, &ip, &port, &idc, &rack) < 4)
+            continue;
+        char buf[32];
+        snprintf(buf, sizeof buf, "%ld", ++id);
+        cells.push_back(buf);
+        snprintf(buf, sizeof buf, "%u", modid);
+        cells.push_back(buf);
+        snprintf(buf, sizeof buf, "%u", cmdid);
+        cells.push_back(buf);
+        snprintf(buf, sizeof buf, "%u", ip);
+        cells.push_back(buf);
+        snprintf(buf, sizeof buf, "%u", port);
+        cells.push_back(buf);
+        snprintf(buf, sizeof buf, "%u", idc);
+        cells.push_back(buf);
+        snprintf(buf, sizeof buf, "%u", rack);
+        cells.push_back(buf);
+    }
+    ::fclose(fp);
+    return true;
+}
+
+int STDCALL mysql_server_init(int argc, char** argv, char** groups)
+{
+    return 0;
+}
+
+MYSQL* STDCALL mysql_init(MYSQL* mysql)
+{
+    if (!mysql)
+    {
+        mysql = (MYSQL*)::calloc(1, sizeof(MYSQL));
+        if (!mysql)
+            return NULL;
+        mysql->free_me = 1;
+    }
+    else
+    {
+        ::memset(mysql, 0, sizeof(MYSQL));
+    }
+    mysql->extension = new StubConn();
+    return mysql;
+}
+
+int STDCALL mysql_options(MYSQL* mysql, enum mysql_option option, const void* arg)
+{
+    return 0;
+}
+
+MYSQL* STDCALL mysql_real_connect(MYSQL* mysql, const char* host, const char* user, const char* passwd,
+    const char* db, unsigned int port, const char* unix_socket, unsigned long clientflag)
+{
+    StubConn* conn = (StubConn*)mysql->extension;
+    if (!db || !*db)
+    {
+        setError(mysql, "bench stub: db_name must be a local path");
+        return NULL;
+    }
+    conn->path = db;
+    std::string statPath = conn->path + BENCH_DB_STAT_SUFFIX;
+    int fd = ::open(statPath.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd == -1 || ::ftruncate(fd, sizeof(BenchDbStat)) == -1)
+    {
+        if (fd != -1)
+            ::close(fd);
+        setError(mysql, "bench stub: can not create stat file");
+        return NULL;
+    }
+    void* base = ::mmap(NULL, sizeof(BenchDbStat), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED)
+    {
+        setError(mysql, "bench stub: can not map stat file");
+        return NULL;
+    }
+    conn->stat = (BenchDbStat*)base;
+    return mysql;
+}
+
+int STDCALL mysql_ping(MYSQL* mysql)
+{
+    return 0;
+}
+
+int STDCALL mysql_real_query(MYSQL* mysql, const char* q, unsigned long length)
+{
+    StubConn* conn = (StubConn*)mysql->extension;
+    if (!conn->stat)
+    {
+        setError(mysql, "bench stub: not connected");
+        return 1;
+    }
+    __sync_fetch_and_add(&conn->stat->queries, 1);
+    delete conn->pending;
+    conn->pending = NULL;
+    conn->cols = 0;
+
+    if (startsWith(q, "SELECT * FROM DnsServerRoute"))
+    {
+        std::vector<std::string>* cells = new std::vector<std::string>();
+        if (!loadRoutes(conn, *cells))
+        {
+            delete cells;
+            setError(mysql, "bench stub: can not read route file");
+            return 1;
+        }
+        conn->pending = cells;
+        conn->cols = 7;
+    }
+    else if (startsWith(q, "SELECT version from RouteVersion"))
+    {
+        struct stat st;
+        if (::stat(conn->path.c_str(), &st) == -1)
+        {
+            setError(mysql, "bench stub: can not stat route file");
+            return 1;
+        }
+        char buf[32];
+        snprintf(buf, sizeof buf, "%ld", (long)st.st_mtime);
+        conn->pending = new std::vector<std::string>(1, buf);
+        conn->cols = 1;
+    }
+    else if (startsWith(q, "SELECT"))
+    {
+        //ChangeLog等：空结果
+        conn->pending = new std::vector<std::string>();
+        conn->cols = 2;
+    }
+    else if (startsWith(q, "INSERT"))
+    {
+        __sync_fetch_and_add(&conn->stat->inserts, 1);
+    }
+    return 0;
+}
+
+MYSQL_RES* STDCALL mysql_store_result(MYSQL* mysql)
+{
+    StubConn* conn = (StubConn*)mysql->extension;
+    if (!conn->pending)
+    {
+        setError(mysql, "bench stub: no result set");
+        return NULL;
+    }
+    MYSQL_RES* res = (MYSQL_RES*)::calloc(1, sizeof(MYSQL_RES));
+    StubResult* data = new StubResult();
+    data->cells.swap(*conn->pending);
+    delete conn->pending;
+    conn->pending = NULL;
+    data->cols = conn->cols;
+    data->rows = data->cells.size() / data->cols;
+    data->cursor = 0;
+    data->row.resize(data->cols, NULL);
+    res->row_count = data->rows;
+    res->field_count = data->cols;
+    res->extension = data;
+    return res;
+}
+
+my_ulonglong STDCALL mysql_num_rows(MYSQL_RES* res)
+{
+    return res->row_count;
+}
+
+unsigned int STDCALL mysql_num_fields(MYSQL_RES* res)
+{
+    return res->field_count;
+}
+
+MYSQL_ROW STDCALL mysql_fetch_row(MYSQL_RES* result)
+{
+    StubResult* data = (StubResult*)result->extension;
+    if (data->cursor >= data->rows)
+        return NULL;
+    for (unsigned i = 0;i < data->cols; ++i)
+        data->row[i] = (char*)data->cells[data->cursor * data->cols + i].c_str();
+    ++data->cursor;
+    return &data->row[0];
+}
+
+void STDCALL mysql_free_result(MYSQL_RES* result)
+{
+    if (!result)
+        return ;
+    delete (StubResult*)result->extension;
+    ::free(result);
+}
+
+const char* STDCALL mysql_error(MYSQL* mysql)
+{
+    return mysql->net.last_error;
+}
+
+void STDCALL mysql_close(MYSQL* sock)
+{
+    StubConn* conn = (StubConn*)sock->extension;
+    if (conn)
+    {
+        if (conn->stat)
+            ::munmap(conn->stat, sizeof(BenchDbStat));
+        delete conn->pending;
+        delete conn;
+    }
+    sock->extension = NULL;
+    if (sock->free_me)
+        ::free(sock);
+}
@@ -0,0 +1,47 @@
+#ifndef __COARSE_CLOCK_H__
+#define __COARSE_CLOCK_H__
+
+#include <time.h>
+#include <stdint.h>
+
+//单调粗粒度时钟：CLOCK_MONOTONIC_COARSE走vDSO，不陷入内核，精度为内核tick（1~4ms）
+//只用于计算时间间隔（窗口、超时、耗时），不受系统时间调整影响；需要绝对时间（上报时间戳等）仍用time(NULL)
+
+#ifdef ELB_VIRTUAL_CLOCK
+
+//离线模拟（bench/src/lbSim.cc）：以-DELB_VIRTUAL_CLOCK编译时，时钟由模拟器推进，不读系统时间
+extern uint64_t virtualClockMs;
+
+static inline long MONO_SEC(void)
+{
+    return virtualClockMs / 1000;
+}
+
+static inline uint64_t MONO_MSEC(void)
+{
+    return virtualClockMs;
+}
+
+#else
+
+#ifndef CLOCK_MONOTONIC_COARSE
+#define CLOCK_MONOTONIC_COARSE CLOCK_MONOTONIC
+#endif
+
+static inline long MONO_SEC(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return ts.tv_sec;
+}
+
+static inline uint64_t MONO_MSEC(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+#endif
+
+#endif
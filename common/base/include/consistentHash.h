@@ -0,0 +1,202 @@
+#ifndef __CONSISTENT_HASH_H__
+#define __CONSISTENT_HASH_H__
+
+#include <stdint.h>
+#include <vector>
+#include <algorithm>
+
+//按请求key选取节点的一致性哈希，agent与API共用：两端对同一节点集合建出的表完全相同，同一key选中同一节点
+//节点表示为ip << 32 + port；建表前先排序，与节点的插入顺序无关
+//节点集合变化（增删）时重新建表，只有少量key换到别的节点；节点过载不重新建表，选取时跳过，只影响落在它上面的key
+
+//一致性哈希策略，经CacheGetRouteRsp告知API
+enum HASH_POLICY
+{
+    HASH_NONE   = 0,//不按key选取，仍然轮询
+    HASH_MAGLEV = 1,//Maglev查找表：选取O(1)，表大小为质数
+    HASH_RING   = 2 //带虚节点的哈希环：选取O(log n)，每个节点若干虚节点
+};
+
+#define MAGLEV_DEFAULT_SIZE 5003  //Maglev查找表默认的最小大小，实际大小随节点数增大，取质数
+#define MAGLEV_SLOTS_PER_HOST 100 //表大小至少为节点数的这么多倍，各节点的表项数才接近（偏差约1/根号此值）
+#define MAGLEV_MAX_SIZE 1048573   //Maglev查找表大小上限（质数），节点数超过其1/MAGLEV_SLOTS_PER_HOST时改用哈希环
+#define RING_DEFAULT_VNODES 160   //哈希环默认的每节点虚节点数
+
+//64位混合函数（splitmix64的finalizer），key与节点都先经过它再取模
+static inline uint64_t hashMix(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+//字符串key转为64位（FNV-1a），API的字符串接口使用
+static inline uint64_t hashKey(const char* data, size_t len)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0;i < len; ++i)
+    {
+        h ^= (unsigned char)data[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+static inline bool isPrime(int n)
+{
+    if (n < 2)
+        return false;
+    for (int i = 2;i * i <= n; ++i)
+        if (n % i == 0)
+            return false;
+    return true;
+}
+
+class ConsistentHash
+{
+public:
+    ConsistentHash(): _policy(HASH_NONE), _param(0) { }
+
+    //按策略与参数（maglev：表的最小大小；ring：每节点虚节点数）为hosts建表
+    //maglev的表大小：参数按倍增到不小于节点数 * MAGLEV_SLOTS_PER_HOST，再取其后的第一个质数；
+    //表大小变化会让所有key重新分布，倍增使节点增删一两个时表大小不变，只有节点数跨过一档时才变；节点多到超出MAGLEV_MAX_SIZE时
+    //改用默认虚节点数的哈希环（policy()不变，ringFallback()为true），agent与API对同样的节点做出同样的选择
+    void build(int policy, int param, const std::vector<uint64_t>& hosts)
+    {
+        clear();
+        _policy = policy;
+        _param = param;
+        _hosts = hosts;
+        std::sort(_hosts.begin(), _hosts.end());
+        _hosts.erase(std::unique(_hosts.begin(), _hosts.end()), _hosts.end());
+        if (_hosts.empty())
+            return ;
+        if (policy == HASH_MAGLEV && _hosts.size() > MAGLEV_MAX_SIZE / MAGLEV_SLOTS_PER_HOST)
+            buildRing(RING_DEFAULT_VNODES);
+        else if (policy == HASH_MAGLEV)
+            buildMaglev();
+        else if (policy == HASH_RING)
+            buildRing(_param > 0? _param: RING_DEFAULT_VNODES);
+    }
+
+    void clear()
+    {
+        _policy = HASH_NONE;
+        _hosts.clear();
+        _table.clear();
+        _ring.clear();
+    }
+
+    bool built() const { return !_table.empty() || !_ring.empty(); }
+    int policy() const { return _policy; }
+    int param() const { return _param; }
+    //maglev策略因节点过多改用了哈希环
+    bool ringFallback() const { return _policy == HASH_MAGLEV && !_ring.empty(); }
+    //建表时的节点，已排序；pick返回其下标
+    const std::vector<uint64_t>& hosts() const { return _hosts; }
+
+    //key的首选节点下标存入primary，返回从首选节点起第一个usable(下标)为true的节点下标，都不可用返回-1
+    //Maglev沿查找表、ring沿哈希环顺序找下一个，被跳过节点上的key分散到其余节点
+    template <typename Usable>
+    int pick(uint64_t key, Usable& usable, int& primary) const
+    {
+        primary = -1;
+        if (!built())
+            return -1;
+        uint64_t h = hashMix(key);
+        size_t n, pos;
+        if (!_table.empty())
+        {
+            n = _table.size();
+            pos = h % n;
+            primary = _table[pos];
+        }
+        else
+        {
+            n = _ring.size();
+            pos = std::lower_bound(_ring.begin(), _ring.end(), std::make_pair(h, (uint32_t)0)) - _ring.begin();
+            if (pos == n)
+                pos = 0;
+            primary = _ring[pos].second;
+        }
+        if (usable(primary))
+            return primary;
+        //最多看一遍表：节点都不可用时返回-1；调用者应先确认有可用节点，避免扫全表
+        std::vector<char> seen(_hosts.size(), 0);
+        size_t left = _hosts.size();
+        for (size_t i = 0;i < n && left; ++i, pos = pos + 1 == n? 0: pos + 1)
+        {
+            int idx = !_table.empty()? _table[pos]: _ring[pos].second;
+            if (seen[idx])
+                continue;
+            if (usable(idx))
+                return idx;
+            seen[idx] = 1;
+            --left;
+        }
+        return -1;
+    }
+
+private:
+    void buildMaglev()
+    {
+        size_t n = _hosts.size();
+        int size = _param > 0? _param: MAGLEV_DEFAULT_SIZE;
+        while (size < (int)n * MAGLEV_SLOTS_PER_HOST && size <= MAGLEV_MAX_SIZE)
+            size *= 2;
+        //节点数在build中已限制，倍增后超出上限时取上限（质数），仍不小于节点数 * MAGLEV_SLOTS_PER_HOST
+        if (size > MAGLEV_MAX_SIZE)
+            size = MAGLEV_MAX_SIZE;
+        while (!isPrime(size))
+            ++size;
+        //每个节点按(offset + j * skip) % size的排列轮流认领空表项，认领满为止
+        std::vector<uint32_t> offset(n), skip(n), next(n, 0);
+        for (size_t i = 0;i < n; ++i)
+        {
+            offset[i] = hashMix(_hosts[i] ^ 0x6d61676c65760001ULL) % size;
+            skip[i] = hashMix(_hosts[i] ^ 0x6d61676c65760002ULL) % (size - 1) + 1;
+        }
+        std::vector<int> table(size, -1);
+        int filled = 0;
+        while (filled < size)
+        {
+            for (size_t i = 0;i < n && filled < size; ++i)
+            {
+                uint32_t c = (offset[i] + (uint64_t)next[i] * skip[i]) % size;
+                while (table[c] >= 0)
+                {
+                    ++next[i];
+                    c = (offset[i] + (uint64_t)next[i] * skip[i]) % size;
+                }
+                table[c] = i;
+                ++next[i];
+                ++filled;
+            }
+        }
+        _table.assign(table.begin(), table.end());
+    }
+
+    void buildRing(int vnodes)
+    {
+        _ring.reserve(_hosts.size() * vnodes);
+        for (size_t i = 0;i < _hosts.size(); ++i)
+        {
+            //虚节点序号加在节点的哈希值上，不能直接与节点的某些位异或：否则只差这些位的节点（如ip只差第三段）虚节点完全相同
+            uint64_t base = hashMix(_hosts[i] ^ 0x72696e6700000000ULL);
+            for (int v = 0;v < vnodes; ++v)
+                _ring.push_back(std::make_pair(hashMix(base + v), (uint32_t)i));
+        }
+        std::sort(_ring.begin(), _ring.end());
+    }
+
+    int _policy;
+    int _param;
+    std::vector<uint64_t> _hosts;
+    std::vector<uint32_t> _table;//maglev: 表项 -> 节点下标
+    std::vector<std::pair<uint64_t, uint32_t> > _ring;//ring: (虚节点哈希值, 节点下标)，按哈希值排序
+};
+
+#endif
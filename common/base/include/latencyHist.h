@@ -0,0 +1,124 @@
+#ifndef __LATENCY_HIST_H__
+#define __LATENCY_HIST_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+//HDR风格的耗时直方图：每个2的幂区间再等分2^HIST_SUB_BITS档，任意值的相对误差不超过1/2^HIST_SUB_BITS
+//记录是一次定位加一次自增，可以每个请求都记；不加锁，每个线程一个，结束时merge
+//值的单位由调用方决定（压测工具用纳秒），超过HIST_MAX_VALUE的按HIST_MAX_VALUE计
+
+#define HIST_SUB_BITS 7
+#define HIST_SUB_CNT (1 << HIST_SUB_BITS)
+#define HIST_MAX_SHIFT 30
+#define HIST_MAX_VALUE ((uint64_t)(2 * HIST_SUB_CNT - 1) << HIST_MAX_SHIFT)//纳秒时约274秒
+#define HIST_BUCKETS ((HIST_MAX_SHIFT + 2) * HIST_SUB_CNT)
+
+class LatencyHist
+{
+public:
+    LatencyHist() { reset(); }
+
+    void reset()
+    {
+        ::memset(_counts, 0, sizeof(_counts));
+        _total = 0;
+        _sum = 0;
+        _min = 0;
+        _max = 0;
+    }
+
+    void record(uint64_t value)
+    {
+        if (value > HIST_MAX_VALUE)
+            value = HIST_MAX_VALUE;
+        ++_counts[index(value)];
+        if (!_total || value < _min)
+            _min = value;
+        if (value > _max)
+            _max = value;
+        ++_total;
+        _sum += value;
+    }
+
+    void merge(const LatencyHist& other)
+    {
+        if (!other._total)
+            return ;
+        for (int i = 0;i < HIST_BUCKETS; ++i)
+            _counts[i] += other._counts[i];
+        if (!_total || other._min < _min)
+            _min = other._min;
+        if (other._max > _max)
+            _max = other._max;
+        _total += other._total;
+        _sum += other._sum;
+    }
+
+    uint64_t count() const { return _total; }
+    uint64_t min() const { return _min; }
+    uint64_t max() const { return _max; }
+    double mean() const { return _total? (double)_sum / _total: 0; }
+
+    //第p百分位（0 < p <= 100）所在档的中值，不超过实际最大值
+    uint64_t percentile(double p) const
+    {
+        if (!_total)
+            return 0;
+        uint64_t rank = (uint64_t)(p / 100.0 * _total + 0.5);
+        if (rank < 1)
+            rank = 1;
+        if (rank > _total)
+            rank = _total;
+        uint64_t seen = 0;
+        for (int i = 0;i < HIST_BUCKETS; ++i)
+        {
+            seen += _counts[i];
+            if (seen >= rank)
+            {
+                uint64_t mid = lowest(i) + (width(i) >> 1);
+                return mid > _max? _max: mid < _min? _min: mid;
+            }
+        }
+        return _max;
+    }
+
+    //一行摘要：count p50 p99 p999 max，值除以unit后输出（如纳秒值unit=1000输出微秒）
+    void print(FILE* fp, const char* name, double unit, const char* unitName) const
+    {
+        fprintf(fp, "%s: count %lu, p50 %.1f%s, p99 %.1f%s, p999 %.1f%s, max %.1f%s\n", name,
+            (unsigned long)_total, percentile(50) / unit, unitName, percentile(99) / unit, unitName,
+            percentile(99.9) / unit, unitName, _max / unit, unitName);
+    }
+
+private:
+    //[0, 2*HIST_SUB_CNT)一值一档；之后每个2的幂区间HIST_SUB_CNT档，档宽2^shift
+    static int index(uint64_t value)
+    {
+        int shift = 0;
+        if (value >= 2 * HIST_SUB_CNT)
+            shift = 63 - __builtin_clzll(value) - HIST_SUB_BITS;
+        return shift * HIST_SUB_CNT + (int)(value >> shift);
+    }
+
+    static uint64_t lowest(int idx)
+    {
+        int shift = idx < 2 * HIST_SUB_CNT? 0: idx / HIST_SUB_CNT - 1;
+        return (uint64_t)(idx - shift * HIST_SUB_CNT) << shift;
+    }
+
+    static uint64_t width(int idx)
+    {
+        int shift = idx < 2 * HIST_SUB_CNT? 0: idx / HIST_SUB_CNT - 1;
+        return (uint64_t)1 << shift;
+    }
+
+    uint64_t _counts[HIST_BUCKETS];
+    uint64_t _total;
+    uint64_t _sum;
+    uint64_t _min;
+    uint64_t _max;
+};
+
+#endif
@@ -32,6 +32,8 @@ extern void _init_log_stat_(void);
 extern void _set_log_level_(int);
 extern void _set_log_thread_name_(const char *n);
 extern void _write_log_ (int, const char*, const char *, int, const char *, ...) __attribute__((format(printf,5,6)));
+//因缓冲区满而丢弃的日志条数（所有线程累计）
+extern unsigned long _log_dropped_(void);
 
 #include <asm/unistd.h>
 #include <unistd.h>
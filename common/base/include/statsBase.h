@@ -0,0 +1,179 @@
+#ifndef __STATS_BASE_H__
+#define __STATS_BASE_H__
+
+#include <time.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <string>
+
+//各服务（lbagent、dnsserver、reporter）共用的运行指标基础设施：
+//计数器与耗时直方图每个线程一份，只由所属线程写（relaxed原子写，不加锁、不用lock前缀指令），
+//导出时由其他线程relaxed读出并汇总，可能与正在进行的写相差几次，但不会读到撕裂的值；导出格式为Prometheus文本
+
+#define STAT_HIST_BUCKETS 24//耗时直方图第i档的上界为2^i微秒（1us ~ 8s），最后一档之外记入+Inf
+
+//单写者的计数：只有所属线程调用
+static inline void statAdd(uint64_t& cnt, uint64_t n = 1)
+{
+    __atomic_store_n(&cnt, cnt + n, __ATOMIC_RELAXED);
+}
+
+//单写者的瞬时值
+static inline void statSet(uint64_t& value, uint64_t n)
+{
+    __atomic_store_n(&value, n, __ATOMIC_RELAXED);
+}
+
+static inline uint64_t statLoad(const uint64_t& cnt)
+{
+    return __atomic_load_n(&cnt, __ATOMIC_RELAXED);
+}
+
+static inline uint64_t statNowUs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+//指标查询只接受本机连接：对端是否为127.0.0.0/8
+static inline bool statPeerLocal(int fd)
+{
+    struct sockaddr_in addr;
+    socklen_t len = sizeof addr;
+    if (::getpeername(fd, (struct sockaddr*)&addr, &len) == -1 || addr.sin_family != AF_INET)
+        return false;
+    return (ntohl(addr.sin_addr.s_addr) >> 24) == 127;
+}
+
+//Prometheus风格的耗时直方图，档位固定为2的幂，汇总时逐档相加
+struct StatHist
+{
+    void record(uint64_t us)
+    {
+        int idx = us <= 1? 0: 64 - __builtin_clzll(us - 1);
+        if (idx > STAT_HIST_BUCKETS)
+            idx = STAT_HIST_BUCKETS;
+        statAdd(buckets[idx]);
+        statAdd(sumUs, us);
+    }
+
+    void merge(const StatHist& other)
+    {
+        for (int i = 0;i <= STAT_HIST_BUCKETS; ++i)
+            buckets[i] += statLoad(other.buckets[i]);
+        sumUs += statLoad(other.sumUs);
+    }
+
+    uint64_t buckets[STAT_HIST_BUCKETS + 1];//最后一档为+Inf
+    uint64_t sumUs;
+};
+
+//线程数事先未知时（如reactor的线程池）按线程分槽：线程首次调用mine()时领取一个槽，之后一直使用它
+//T须是只含计数的POD，按缓存行对齐；超过N个线程后多出的线程共用最后一个槽，计数可能丢失几次
+template <typename T, int N>
+class StatSlots
+{
+public:
+    StatSlots(): _used(0)
+    {
+        ::memset(_slots, 0, sizeof(_slots));
+        ::pthread_key_create(&_key, NULL);
+    }
+
+    T* mine()
+    {
+        T* slot = (T*)::pthread_getspecific(_key);
+        if (!slot)
+        {
+            int idx = __sync_fetch_and_add(&_used, 1);
+            slot = &_slots[idx < N? idx: N - 1];
+            ::pthread_setspecific(_key, slot);
+        }
+        return slot;
+    }
+
+    //已领取的槽数
+    int used() const
+    {
+        int used = __atomic_load_n(&_used, __ATOMIC_RELAXED);
+        return used < N? used: N;
+    }
+
+    const T& at(int idx) const { return _slots[idx]; }
+
+private:
+    StatSlots(const StatSlots&);
+    StatSlots& operator=(const StatSlots&);
+
+    T _slots[N];
+    int _used;
+    pthread_key_t _key;
+};
+
+//拼接Prometheus文本
+class StatText
+{
+public:
+    StatText(std::string& text): _text(text) {}
+
+    void head(const char* name, const char* type, const char* help)
+    {
+        line("# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+    }
+
+    void line(const char* fmt, ...) __attribute__((format(printf, 2, 3)))
+    {
+        char buf[256];
+        va_list args;
+        va_start(args, fmt);
+        int n = ::vsnprintf(buf, sizeof buf, fmt, args);
+        va_end(args);
+        if (n > 0)
+            _text.append(buf, n < (int)sizeof buf? n: sizeof buf - 1);
+    }
+
+    //labels为空时不带标签；hist可以是正在被所属线程写的那一份
+    void hist(const char* name, const char* labels, const StatHist& hist)
+    {
+        const char* sep = labels[0]? ",": "";
+        uint64_t cum = 0;
+        for (int i = 0;i < STAT_HIST_BUCKETS; ++i)
+        {
+            cum += statLoad(hist.buckets[i]);
+            line("%s_bucket{%s%sle=\"%g\"} %lu\n", name, labels, sep, (double)(1UL << i) / 1e6, (unsigned long)cum);
+        }
+        cum += statLoad(hist.buckets[STAT_HIST_BUCKETS]);
+        line("%s_bucket{%s%sle=\"+Inf\"} %lu\n", name, labels, sep, (unsigned long)cum);
+        if (labels[0])
+        {
+            line("%s_sum{%s} %.6f\n", name, labels, statLoad(hist.sumUs) / 1e6);
+            line("%s_count{%s} %lu\n", name, labels, (unsigned long)cum);
+        }
+        else
+        {
+            line("%s_sum %.6f\n", name, statLoad(hist.sumUs) / 1e6);
+            line("%s_count %lu\n", name, (unsigned long)cum);
+        }
+    }
+
+    //截断到limit字节以内，在行尾截断
+    void truncate(size_t limit)
+    {
+        if (_text.size() <= limit)
+            return ;
+        size_t end = _text.rfind('\n', limit - 1);
+        _text.resize(end == std::string::npos? 0: end + 1);
+    }
+
+private:
+    std::string& _text;
+};
+
+#endif
@@ -12,6 +12,11 @@
 #include "log.h"
 
 #define LOGSIZE 4096
+//异步写日志：每个线程一个环形缓冲区（单生产者单消费者，无锁），调用线程只格式化消息正文，
+//前缀（时间、线程、文件行号）由后台flush线程格式化并批量写出；缓冲区满时丢弃并计数
+#define LOG_RING_SIZE	(1 << 18)	//每个线程的环形缓冲区字节数，须为2的幂
+#define LOG_BATCH_SIZE	(1 << 16)	//flush线程一次write的最大字节数
+#define LOG_FLUSH_USEC	10000		//flush线程无日志可写时的休眠间隔
 
 int __log_level__ = 6;
 
@@ -35,6 +40,37 @@ void _set_log_thread_name_(const char *n) { pthread_setspecific(namekey, n); }
 #endif
 #endif
 
+//一条日志：定长头部后接消息正文，整条按8字节对齐；len为0表示此处到缓冲区末尾为空，从头继续
+struct log_rec {
+	unsigned int len;
+	unsigned short level;
+	unsigned short msglen;
+	int lineno;
+	time_t ts;
+	const char *filename;
+	const char *funcname;
+	const char *threadname;
+};
+
+//head、tail为累计字节数：tail只由所属线程写，head只由flush线程写
+struct log_ring {
+	char *buf;
+	unsigned long head;
+	unsigned long tail;
+	unsigned long dropped;
+	unsigned long reported;	//flush线程已报告过的丢弃数
+	int tid;
+	struct log_ring *next;	//发布后不再修改
+};
+
+static __thread struct log_ring *myring;
+static struct log_ring *rings;	//新线程的缓冲区插在表头，flush线程无锁遍历
+static pthread_mutex_t ringlock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t flushlock = PTHREAD_MUTEX_INITIALIZER;	//flush线程与进程退出时的flush互斥
+static int logsync = 1;	//flush线程启动前（或启动失败）由调用线程自己flush
+
+static void log_flush(void);
+
 #if HAS_STAT
 #include "StatTTC.h"
 static int statEnable;
@@ -42,6 +78,178 @@ CStatItemU32 statLogCount[8];
 static unsigned int localStatLogCnt[8];
 #endif
 
+static char filebuf[LOG_BATCH_SIZE];
+static char errbuf[LOG_BATCH_SIZE];
+static int fileoff, erroff;
+static time_t cachedsec = -1;
+static struct tm cachedtm;
+
+static void log_write_batch(void)
+{
+	int unused;
+	if(erroff > 0)
+		unused = fwrite(errbuf, 1, erroff, stderr);
+	if(logfd >= 0 && fileoff > 0)
+		unused = write(logfd, filebuf, fileoff);
+	(void)unused;
+	fileoff = erroff = 0;
+}
+
+//按需切换到当天的日志文件
+static void log_rotate(const struct tm *tm)
+{
+	char logfile[256];
+	int today = tm->tm_year*1000 + tm->tm_yday;
+	if(logfd >= 0 && today != logday)
+	{
+		int fd;
+
+		//前一天的日志先写到前一天的文件
+		log_write_batch();
+		logday = today;
+		snprintf (logfile, sizeof(logfile),
+				"%s/%s.error%04d%02d%02d.log", log_dir, appname,
+				tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday);
+		fd = open (logfile, O_CREAT | O_LARGEFILE | O_APPEND |O_WRONLY, 0644);
+		if(fd >= 0)
+		{
+			dup2(fd, logfd);
+			close(fd);
+			fcntl(logfd, F_SETFD, FD_CLOEXEC);
+		}
+	}
+}
+
+//格式化一行到批量缓冲区：文件中的行带"<level>"前缀，stderr的不带
+static void log_append(int level, time_t ts, const char *threadname, int tid,
+	const char *filename, int lineno, const char *funcname, const char *msg, int msglen)
+{
+	char buf[LOGSIZE];
+	int off;
+
+	//同一秒内的日志只调用一次localtime_r
+	if(ts != cachedsec)
+	{
+		localtime_r(&ts, &cachedtm);
+		cachedsec = ts;
+	}
+	log_rotate(&cachedtm);
+
+	if(threadname)
+	off = snprintf (buf, LOGSIZE,
+			"<%d>[%02d:%02d:%02d] %s: %s(%d)[%s]: ",
+			level,
+			cachedtm.tm_hour, cachedtm.tm_min, cachedtm.tm_sec,
+			threadname,
+			basename(filename), lineno, funcname
+		       );
+	else
+	off = snprintf (buf, LOGSIZE,
+			"<%d>[%02d:%02d:%02d] pid[%d]: %s(%d)[%s]: ",
+			level,
+			cachedtm.tm_hour, cachedtm.tm_min, cachedtm.tm_sec,
+			tid,
+			basename(filename), lineno, funcname
+		       );
+	if(off >= LOGSIZE)
+		off = LOGSIZE - 1;
+	if(msglen > LOGSIZE - 1 - off)
+		msglen = LOGSIZE - 1 - off;
+	memcpy(buf + off, msg, msglen);
+	off += msglen;
+	if(off == 0 || buf[off-1] != '\n')
+		buf[off++] = '\n';
+
+	if(fileoff + off > LOG_BATCH_SIZE)
+		log_write_batch();
+	memcpy(filebuf + fileoff, buf, off);
+	fileoff += off;
+	memcpy(errbuf + erroff, buf + 3, off - 3);
+	erroff += off - 3;
+}
+
+//取走所有线程缓冲区中的日志并写出；各线程之间不保证按时间排序
+static void log_flush(void)
+{
+	char msg[64];
+	struct log_ring *r;
+
+	pthread_mutex_lock(&flushlock);
+	for(r = __atomic_load_n(&rings, __ATOMIC_ACQUIRE); r; r = r->next)
+	{
+		unsigned long tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+		unsigned long head = r->head;
+		while(head != tail)
+		{
+			unsigned long pos = head & (LOG_RING_SIZE - 1);
+			struct log_rec *rec = (struct log_rec *)(r->buf + pos);
+			if(rec->len == 0)
+			{
+				head += LOG_RING_SIZE - pos;
+				continue;
+			}
+			log_append(rec->level, rec->ts, rec->threadname, r->tid,
+				rec->filename, rec->lineno, rec->funcname, (const char *)(rec + 1), rec->msglen);
+			head += rec->len;
+		}
+		__atomic_store_n(&r->head, head, __ATOMIC_RELEASE);
+
+		unsigned long dropped = __atomic_load_n(&r->dropped, __ATOMIC_RELAXED);
+		if(dropped != r->reported)
+		{
+			int n = snprintf(msg, sizeof(msg), "%lu messages dropped, log buffer full", dropped - r->reported);
+			log_append(4, time(NULL), NULL, r->tid, __FILE__, __LINE__, __FUNCTION__, msg, n);
+			r->reported = dropped;
+		}
+	}
+	log_write_batch();
+	pthread_mutex_unlock(&flushlock);
+}
+
+static void *log_flusher(void *args)
+{
+	_set_log_thread_name_("logflush");
+	while(1)
+	{
+		log_flush();
+		usleep(LOG_FLUSH_USEC);
+	}
+	return NULL;
+}
+
+//当前线程的缓冲区，首次写日志时创建；线程退出后不回收（各服务的线程都常驻）
+static struct log_ring *log_ring_get(void)
+{
+	struct log_ring *r = myring;
+	if(r)
+		return r;
+	r = (struct log_ring *)calloc(1, sizeof(struct log_ring));
+	if(!r)
+		return NULL;
+	r->buf = (char *)malloc(LOG_RING_SIZE);
+	if(!r->buf)
+	{
+		free(r);
+		return NULL;
+	}
+	r->tid = _gettid_();
+	pthread_mutex_lock(&ringlock);
+	r->next = rings;
+	__atomic_store_n(&rings, r, __ATOMIC_RELEASE);
+	pthread_mutex_unlock(&ringlock);
+	myring = r;
+	return r;
+}
+
+unsigned long _log_dropped_(void)
+{
+	unsigned long dropped = 0;
+	struct log_ring *r;
+	for(r = __atomic_load_n(&rings, __ATOMIC_ACQUIRE); r; r = r->next)
+		dropped += __atomic_load_n(&r->dropped, __ATOMIC_RELAXED);
+	return dropped;
+}
+
 void _init_log_ (const char *app, const char *dir)
 {
 #if !CLIENTAPI
@@ -69,6 +277,19 @@ void _init_log_ (const char *app, const char *dir)
 	if(logfd < 0)
 		logfd = dup(2);
 	fcntl(logfd, F_SETFD, FD_CLOEXEC);
+
+	//进程退出（exit、main返回）时写出缓冲区中剩余的日志
+	atexit(log_flush);
+	pthread_t tid;
+	if(pthread_create(&tid, NULL, log_flusher, NULL) == 0)
+	{
+		pthread_detach(tid);
+		logsync = 0;
+	}
+	else
+	{
+		fprintf(stderr, "log flusher thread create failed, fall back to synchronous log\n");
+	}
 }
 
 void _init_log_stat_(void)
@@ -98,9 +319,10 @@ void _write_log_(
 {
 	// save errno
 	int savedErrNo = errno;
-	int off = 0;
-	char buf[LOGSIZE];
-	char logfile[256];
+	struct log_ring *r;
+	struct log_rec *rec;
+	unsigned long head, tail, pos, pad;
+	int n;
 #if !CLIENTAPI
 #if !HAS_TLS
 	const char *threadname;
@@ -118,57 +340,31 @@ void _write_log_(
 	else
 		++statLogCount[level];
 #endif
-	
-	// construct prefix
-	struct tm tm;
-	time_t now = time (NULL);
-	localtime_r(&now, &tm);
-	filename = basename(filename);
-#if !CLIENTAPI
-#if HAS_TLS
-#else
-	pthread_once(&nameonce, _init_namekey_);
-	threadname = (const char *)pthread_getspecific(namekey);
-#endif
-#endif
-	if(threadname)
-	off = snprintf (buf, LOGSIZE,
-			"<%d>[%02d:%02d:%02d] %s: %s(%d)[%s]: ",
-			level,
-			tm.tm_hour, tm.tm_min, tm.tm_sec,
-			threadname,
-			filename, lineno, funcname
-		       );
-	else
-	off = snprintf (buf, LOGSIZE,
-			"<%d>[%02d:%02d:%02d] pid[%d]: %s(%d)[%s]: ",
-			level,
-			tm.tm_hour, tm.tm_min, tm.tm_sec,
-			_gettid_(),
-			filename, lineno, funcname
-		       );
-	if(off >= LOGSIZE)
-		off = LOGSIZE - 1;
-		
-	{
-	int today = tm.tm_year*1000 + tm.tm_yday;
-	if(logfd >= 0 && today != logday)
-	{
-		int fd;
 
-		logday = today;
-		snprintf (logfile, sizeof(logfile),
-				"%s/%s.error%04d%02d%02d.log", log_dir, appname,
-				tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday);
-		fd = open (logfile, O_CREAT | O_LARGEFILE | O_APPEND |O_WRONLY, 0644);
-		if(fd >= 0)
-		{
-			dup2(fd, logfd);
-			close(fd);
-			fcntl(logfd, F_SETFD, FD_CLOEXEC);
-		}
+	r = log_ring_get();
+	if(!r)
+		return;
+
+	//按最长的一条预留空间，正文直接格式化到缓冲区中；放不下则从缓冲区头部开始
+	tail = r->tail;
+	head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+	pos = tail & (LOG_RING_SIZE - 1);
+	pad = 0;
+	if(pos + sizeof(struct log_rec) + LOGSIZE > LOG_RING_SIZE)
+		pad = LOG_RING_SIZE - pos;
+	if(tail + pad + sizeof(struct log_rec) + LOGSIZE - head > LOG_RING_SIZE)
+	{
+		__atomic_store_n(&r->dropped, r->dropped + 1, __ATOMIC_RELAXED);
+		errno = savedErrNo;
+		return;
 	}
+	if(pad)
+	{
+		((struct log_rec *)(r->buf + pos))->len = 0;
+		tail += pad;
+		pos = 0;
 	}
+	rec = (struct log_rec *)(r->buf + pos);
 
 	{
 		// formatted message
@@ -176,23 +372,31 @@ void _write_log_(
 		va_start(ap, format);
 		// restore errno
 		errno = savedErrNo;
-		off += vsnprintf(buf+off, LOGSIZE-off, format, ap);
+		n = vsnprintf((char *)(rec + 1), LOGSIZE, format, ap);
 		va_end(ap);
 	}
+	if(n < 0)
+		n = 0;
+	else if(n >= LOGSIZE)
+		n = LOGSIZE - 1;
 
-	if(off >= LOGSIZE)
-		off = LOGSIZE - 1;
-	if(buf[off-1]!='\n'){
-		if(off < LOGSIZE - 1)
-			buf[off++] = '\n';
-		else
-			buf[LOGSIZE-1] = '\n';
-	}
-
-	int unused;
-	unused = fwrite(buf+3, 1, off-3, stderr);
+#if !CLIENTAPI
+#if !HAS_TLS
+	pthread_once(&nameonce, _init_namekey_);
+	threadname = (const char *)pthread_getspecific(namekey);
+#endif
+#endif
+	rec->len = (sizeof(struct log_rec) + n + 7) & ~7;
+	rec->level = level;
+	rec->msglen = n;
+	rec->lineno = lineno;
+	rec->ts = time(NULL);
+	rec->filename = filename;
+	rec->funcname = funcname;
+	rec->threadname = threadname;
+	__atomic_store_n(&r->tail, tail + rec->len, __ATOMIC_RELEASE);
 
-	if(logfd >= 0)
-		unused = write(logfd, buf, off);
+	if(logsync)
+		log_flush();
+	errno = savedErrNo;
 }
-
@@ -50,12 +50,18 @@ const ::google::protobuf::internal::GeneratedMessageReflection*
 const ::google::protobuf::Descriptor* CacheGetRouteRsp_descriptor_ = NULL;
 const ::google::protobuf::internal::GeneratedMessageReflection*
   CacheGetRouteRsp_reflection_ = NULL;
+const ::google::protobuf::Descriptor* CacheRouteNotify_descriptor_ = NULL;
+const ::google::protobuf::internal::GeneratedMessageReflection*
+  CacheRouteNotify_reflection_ = NULL;
 const ::google::protobuf::Descriptor* HostBatchCallRes_descriptor_ = NULL;
 const ::google::protobuf::internal::GeneratedMessageReflection*
   HostBatchCallRes_reflection_ = NULL;
 const ::google::protobuf::Descriptor* CacheBatchRptReq_descriptor_ = NULL;
 const ::google::protobuf::internal::GeneratedMessageReflection*
   CacheBatchRptReq_reflection_ = NULL;
+const ::google::protobuf::Descriptor* GetRouteBatchReq_descriptor_ = NULL;
+const ::google::protobuf::internal::GeneratedMessageReflection*
+  GetRouteBatchReq_reflection_ = NULL;
 const ::google::protobuf::EnumDescriptor* MsgTypeId_descriptor_ = NULL;
 
 }  // namespace
@@ -68,9 +74,11 @@ void protobuf_AssignDesc_elb_2eproto() {
       "elb.proto");
   GOOGLE_CHECK(file != NULL);
   HostAddr_descriptor_ = file->message_type(0);
-  static const int HostAddr_offsets_[2] = {
+  static const int HostAddr_offsets_[4] = {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(HostAddr, ip_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(HostAddr, port_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(HostAddr, idc_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(HostAddr, rack_),
   };
   HostAddr_reflection_ =
     new ::google::protobuf::internal::GeneratedMessageReflection(
@@ -84,10 +92,11 @@ void protobuf_AssignDesc_elb_2eproto() {
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(HostAddr));
   GetHostReq_descriptor_ = file->message_type(1);
-  static const int GetHostReq_offsets_[3] = {
+  static const int GetHostReq_offsets_[4] = {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(GetHostReq, seq_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(GetHostReq, modid_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(GetHostReq, cmdid_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(GetHostReq, hashkey_),
   };
   GetHostReq_reflection_ =
     new ::google::protobuf::internal::GeneratedMessageReflection(
@@ -210,10 +219,11 @@ void protobuf_AssignDesc_elb_2eproto() {
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(ReportStatusReq));
   CacheGetRouteReq_descriptor_ = file->message_type(8);
-  static const int CacheGetRouteReq_offsets_[3] = {
+  static const int CacheGetRouteReq_offsets_[4] = {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(CacheGetRouteReq, modid_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(CacheGetRouteReq, cmdid_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(CacheGetRouteReq, version_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(CacheGetRouteReq, subport_),
   };
   CacheGetRouteReq_reflection_ =
     new ::google::protobuf::internal::GeneratedMessageReflection(
@@ -227,12 +237,21 @@ void protobuf_AssignDesc_elb_2eproto() {
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(CacheGetRouteReq));
   CacheGetRouteRsp_descriptor_ = file->message_type(9);
-  static const int CacheGetRouteRsp_offsets_[5] = {
+  static const int CacheGetRouteRsp_offsets_[14] = {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(CacheGetRouteRsp, modid_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(CacheGetRouteRsp, cmdid_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(CacheGetRouteRsp, version_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(CacheGetRouteRsp, overload_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(CacheGetRouteRsp, route_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(CacheGetRouteRsp, pushed_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(CacheGetRouteRsp, downs_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(CacheGetRouteRsp, probenum_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(CacheGetRouteRsp, hashpolicy_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(CacheGetRouteRsp, hashparam_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(CacheGetRouteRsp, localities_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(CacheGetRouteRsp, localmin_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(CacheGetRouteRsp, spillpct_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(CacheGetRouteRsp, pushseq_),
   };
   CacheGetRouteRsp_reflection_ =
     new ::google::protobuf::internal::GeneratedMessageReflection(
@@ -245,11 +264,34 @@ void protobuf_AssignDesc_elb_2eproto() {
       ::google::protobuf::DescriptorPool::generated_pool(),
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(CacheGetRouteRsp));
-  HostBatchCallRes_descriptor_ = file->message_type(10);
-  static const int HostBatchCallRes_offsets_[3] = {
+  CacheRouteNotify_descriptor_ = file->message_type(10);
+  static const int CacheRouteNotify_offsets_[7] = {
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(CacheRouteNotify, modid_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(CacheRouteNotify, cmdid_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(CacheRouteNotify, version_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(CacheRouteNotify, overload_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(CacheRouteNotify, downs_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(CacheRouteNotify, probenum_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(CacheRouteNotify, pushseq_),
+  };
+  CacheRouteNotify_reflection_ =
+    new ::google::protobuf::internal::GeneratedMessageReflection(
+      CacheRouteNotify_descriptor_,
+      CacheRouteNotify::default_instance_,
+      CacheRouteNotify_offsets_,
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(CacheRouteNotify, _has_bits_[0]),
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(CacheRouteNotify, _unknown_fields_),
+      -1,
+      ::google::protobuf::DescriptorPool::generated_pool(),
+      ::google::protobuf::MessageFactory::generated_factory(),
+      sizeof(CacheRouteNotify));
+  HostBatchCallRes_descriptor_ = file->message_type(11);
+  static const int HostBatchCallRes_offsets_[5] = {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(HostBatchCallRes, ip_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(HostBatchCallRes, port_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(HostBatchCallRes, succcnt_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(HostBatchCallRes, costsum_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(HostBatchCallRes, costcnt_),
   };
   HostBatchCallRes_reflection_ =
     new ::google::protobuf::internal::GeneratedMessageReflection(
@@ -262,7 +304,7 @@ void protobuf_AssignDesc_elb_2eproto() {
       ::google::protobuf::DescriptorPool::generated_pool(),
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(HostBatchCallRes));
-  CacheBatchRptReq_descriptor_ = file->message_type(11);
+  CacheBatchRptReq_descriptor_ = file->message_type(12);
   static const int CacheBatchRptReq_offsets_[3] = {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(CacheBatchRptReq, modid_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(CacheBatchRptReq, cmdid_),
@@ -279,6 +321,21 @@ void protobuf_AssignDesc_elb_2eproto() {
       ::google::protobuf::DescriptorPool::generated_pool(),
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(CacheBatchRptReq));
+  GetRouteBatchReq_descriptor_ = file->message_type(13);
+  static const int GetRouteBatchReq_offsets_[1] = {
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(GetRouteBatchReq, reqs_),
+  };
+  GetRouteBatchReq_reflection_ =
+    new ::google::protobuf::internal::GeneratedMessageReflection(
+      GetRouteBatchReq_descriptor_,
+      GetRouteBatchReq::default_instance_,
+      GetRouteBatchReq_offsets_,
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(GetRouteBatchReq, _has_bits_[0]),
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(GetRouteBatchReq, _unknown_fields_),
+      -1,
+      ::google::protobuf::DescriptorPool::generated_pool(),
+      ::google::protobuf::MessageFactory::generated_factory(),
+      sizeof(GetRouteBatchReq));
   MsgTypeId_descriptor_ = file->enum_type(0);
 }
 
@@ -312,10 +369,14 @@ void protobuf_RegisterTypes(const ::std::string&) {
     CacheGetRouteReq_descriptor_, &CacheGetRouteReq::default_instance());
   ::google::protobuf::MessageFactory::InternalRegisterGeneratedMessage(
     CacheGetRouteRsp_descriptor_, &CacheGetRouteRsp::default_instance());
+  ::google::protobuf::MessageFactory::InternalRegisterGeneratedMessage(
+    CacheRouteNotify_descriptor_, &CacheRouteNotify::default_instance());
   ::google::protobuf::MessageFactory::InternalRegisterGeneratedMessage(
     HostBatchCallRes_descriptor_, &HostBatchCallRes::default_instance());
   ::google::protobuf::MessageFactory::InternalRegisterGeneratedMessage(
     CacheBatchRptReq_descriptor_, &CacheBatchRptReq::default_instance());
+  ::google::protobuf::MessageFactory::InternalRegisterGeneratedMessage(
+    GetRouteBatchReq_descriptor_, &GetRouteBatchReq::default_instance());
 }
 
 }  // namespace
@@ -341,10 +402,14 @@ void protobuf_ShutdownFile_elb_2eproto() {
   delete CacheGetRouteReq_reflection_;
   delete CacheGetRouteRsp::default_instance_;
   delete CacheGetRouteRsp_reflection_;
+  delete CacheRouteNotify::default_instance_;
+  delete CacheRouteNotify_reflection_;
   delete HostBatchCallRes::default_instance_;
   delete HostBatchCallRes_reflection_;
   delete CacheBatchRptReq::default_instance_;
   delete CacheBatchRptReq_reflection_;
+  delete GetRouteBatchReq::default_instance_;
+  delete GetRouteBatchReq_reflection_;
 }
 
 void protobuf_AddDesc_elb_2eproto() {
@@ -354,38 +419,56 @@ void protobuf_AddDesc_elb_2eproto() {
   GOOGLE_PROTOBUF_VERIFY_VERSION;
 
   ::google::protobuf::DescriptorPool::InternalAddGeneratedFile(
-    "\n\telb.proto\022\003elb\"$\n\010HostAddr\022\n\n\002ip\030\001 \002(\005"
-    "\022\014\n\004port\030\002 \002(\005\"7\n\nGetHostReq\022\013\n\003seq\030\001 \002("
-    "\r\022\r\n\005modid\030\002 \002(\005\022\r\n\005cmdid\030\003 \002(\005\"e\n\nGetHo"
-    "stRsp\022\013\n\003seq\030\001 \002(\r\022\r\n\005modid\030\002 \002(\005\022\r\n\005cmd"
-    "id\030\003 \002(\005\022\017\n\007retcode\030\004 \002(\005\022\033\n\004host\030\005 \001(\0132"
-    "\r.elb.HostAddr\"f\n\tReportReq\022\r\n\005modid\030\001 \002"
-    "(\005\022\r\n\005cmdid\030\002 \002(\005\022\033\n\004host\030\003 \002(\0132\r.elb.Ho"
-    "stAddr\022\017\n\007retcode\030\004 \002(\005\022\r\n\005tcost\030\005 \001(\r\"+"
-    "\n\013GetRouteReq\022\r\n\005modid\030\001 \002(\005\022\r\n\005cmdid\030\002 "
-    "\002(\005\"I\n\013GetRouteRsp\022\r\n\005modid\030\001 \002(\005\022\r\n\005cmd"
-    "id\030\002 \002(\005\022\034\n\005hosts\030\003 \003(\0132\r.elb.HostAddr\"W"
-    "\n\016HostCallResult\022\n\n\002ip\030\001 \002(\005\022\014\n\004port\030\002 \002"
-    "(\005\022\014\n\004succ\030\003 \002(\r\022\013\n\003err\030\004 \002(\r\022\020\n\010overloa"
-    "d\030\005 \002(\010\"q\n\017ReportStatusReq\022\r\n\005modid\030\001 \002("
-    "\005\022\r\n\005cmdid\030\002 \002(\005\022\016\n\006caller\030\003 \002(\005\022$\n\007resu"
-    "lts\030\004 \003(\0132\023.elb.HostCallResult\022\n\n\002ts\030\005 \002"
-    "(\r\"A\n\020CacheGetRouteReq\022\r\n\005modid\030\001 \002(\005\022\r\n"
-    "\005cmdid\030\002 \002(\005\022\017\n\007version\030\003 \002(\003\"q\n\020CacheGe"
-    "tRouteRsp\022\r\n\005modid\030\001 \002(\005\022\r\n\005cmdid\030\002 \002(\005\022"
-    "\017\n\007version\030\003 \002(\003\022\020\n\010overload\030\004 \001(\010\022\034\n\005ro"
-    "ute\030\005 \003(\0132\r.elb.HostAddr\"=\n\020HostBatchCal"
-    "lRes\022\n\n\002ip\030\001 \002(\005\022\014\n\004port\030\002 \002(\005\022\017\n\007succCn"
-    "t\030\003 \002(\r\"X\n\020CacheBatchRptReq\022\r\n\005modid\030\001 \002"
-    "(\005\022\r\n\005cmdid\030\002 \002(\005\022&\n\007results\030\003 \003(\0132\025.elb"
-    ".HostBatchCallRes*\205\002\n\tMsgTypeId\022\020\n\014GetHo"
-    "stReqId\020\001\022\020\n\014GetHostRspId\020\002\022\017\n\013ReportReq"
-    "Id\020\003\022\027\n\023GetRouteByToolReqId\020\004\022\027\n\023GetRout"
-    "eByToolRspId\020\005\022\030\n\024GetRouteByAgentReqId\020\006"
-    "\022\030\n\024GetRouteByAgentRspId\020\007\022\025\n\021ReportStat"
-    "usReqId\020\010\022\026\n\022CacheGetRouteReqId\020\t\022\026\n\022Cac"
-    "heGetRouteRspId\020\n\022\026\n\022CacheBatchRptReqId\020"
-    "\013", 1241);
+    "\n\telb.proto\022\003elb\"?\n\010HostAddr\022\n\n\002ip\030\001 \002(\005"
+    "\022\014\n\004port\030\002 \002(\005\022\013\n\003idc\030\003 \001(\r\022\014\n\004rack\030\004 \001("
+    "\r\"H\n\nGetHostReq\022\013\n\003seq\030\001 \002(\r\022\r\n\005modid\030\002 "
+    "\002(\005\022\r\n\005cmdid\030\003 \002(\005\022\017\n\007hashkey\030\004 \001(\004\"e\n\nG"
+    "etHostRsp\022\013\n\003seq\030\001 \002(\r\022\r\n\005modid\030\002 \002(\005\022\r\n"
+    "\005cmdid\030\003 \002(\005\022\017\n\007retcode\030\004 \002(\005\022\033\n\004host\030\005 "
+    "\001(\0132\r.elb.HostAddr\"f\n\tReportReq\022\r\n\005modid"
+    "\030\001 \002(\005\022\r\n\005cmdid\030\002 \002(\005\022\033\n\004host\030\003 \002(\0132\r.el"
+    "b.HostAddr\022\017\n\007retcode\030\004 \002(\005\022\r\n\005tcost\030\005 \001"
+    "(\r\"+\n\013GetRouteReq\022\r\n\005modid\030\001 \002(\005\022\r\n\005cmdi"
+    "d\030\002 \002(\005\"I\n\013GetRouteRsp\022\r\n\005modid\030\001 \002(\005\022\r\n"
+    "\005cmdid\030\002 \002(\005\022\034\n\005hosts\030\003 \003(\0132\r.elb.HostAd"
+    "dr\"W\n\016HostCallResult\022\n\n\002ip\030\001 \002(\005\022\014\n\004port"
+    "\030\002 \002(\005\022\014\n\004succ\030\003 \002(\r\022\013\n\003err\030\004 \002(\r\022\020\n\010ove"
+    "rload\030\005 \002(\010\"q\n\017ReportStatusReq\022\r\n\005modid\030"
+    "\001 \002(\005\022\r\n\005cmdid\030\002 \002(\005\022\016\n\006caller\030\003 \002(\005\022$\n\007"
+    "results\030\004 \003(\0132\023.elb.HostCallResult\022\n\n\002ts"
+    "\030\005 \002(\r\"R\n\020CacheGetRouteReq\022\r\n\005modid\030\001 \002("
+    "\005\022\r\n\005cmdid\030\002 \002(\005\022\017\n\007version\030\003 \002(\003\022\017\n\007sub"
+    "port\030\004 \001(\005\"\241\002\n\020CacheGetRouteRsp\022\r\n\005modid"
+    "\030\001 \002(\005\022\r\n\005cmdid\030\002 \002(\005\022\017\n\007version\030\003 \002(\003\022\020"
+    "\n\010overload\030\004 \001(\010\022\034\n\005route\030\005 \003(\0132\r.elb.Ho"
+    "stAddr\022\016\n\006pushed\030\006 \001(\010\022\034\n\005downs\030\007 \003(\0132\r."
+    "elb.HostAddr\022\020\n\010probeNum\030\010 \001(\005\022\022\n\nhashpo"
+    "licy\030\t \001(\005\022\021\n\thashparam\030\n \001(\005\022\022\n\nlocalit"
+    "ies\030\013 \003(\005\022\020\n\010localmin\030\014 \001(\005\022\020\n\010spillpct\030"
+    "\r \001(\005\022\017\n\007pushseq\030\016 \001(\r\"\224\001\n\020CacheRouteNot"
+    "ify\022\r\n\005modid\030\001 \002(\005\022\r\n\005cmdid\030\002 \002(\005\022\017\n\007ver"
+    "sion\030\003 \002(\003\022\020\n\010overload\030\004 \001(\010\022\034\n\005downs\030\005 "
+    "\003(\0132\r.elb.HostAddr\022\020\n\010probeNum\030\006 \001(\005\022\017\n\007"
+    "pushseq\030\007 \001(\r\"_\n\020HostBatchCallRes\022\n\n\002ip\030"
+    "\001 \002(\005\022\014\n\004port\030\002 \002(\005\022\017\n\007succCnt\030\003 \002(\r\022\017\n\007"
+    "costSum\030\004 \001(\004\022\017\n\007costCnt\030\005 \001(\r\"X\n\020CacheB"
+    "atchRptReq\022\r\n\005modid\030\001 \002(\005\022\r\n\005cmdid\030\002 \002(\005"
+    "\022&\n\007results\030\003 \003(\0132\025.elb.HostBatchCallRes"
+    "\"2\n\020GetRouteBatchReq\022\036\n\004reqs\030\001 \003(\0132\020.elb"
+    ".GetRouteReq*\216\004\n\tMsgTypeId\022\020\n\014GetHostReq"
+    "Id\020\001\022\020\n\014GetHostRspId\020\002\022\017\n\013ReportReqId\020\003\022"
+    "\027\n\023GetRouteByToolReqId\020\004\022\027\n\023GetRouteByTo"
+    "olRspId\020\005\022\030\n\024GetRouteByAgentReqId\020\006\022\030\n\024G"
+    "etRouteByAgentRspId\020\007\022\025\n\021ReportStatusReq"
+    "Id\020\010\022\026\n\022CacheGetRouteReqId\020\t\022\026\n\022CacheGet"
+    "RouteRspId\020\n\022\026\n\022CacheBatchRptReqId\020\013\022\021\n\r"
+    "WireNegoReqId\020\014\022\021\n\rWireNegoRspId\020\r\022\023\n\017Fi"
+    "xGetHostReqId\020\016\022\023\n\017FixGetHostRspId\020\017\022\022\n\016"
+    "FixReportReqId\020\020\022\035\n\031GetRouteBatchByAgent"
+    "ReqId\020\021\022\026\n\022CacheRouteNotifyId\020\022\022\023\n\017Agent"
+    "StatsReqId\020\023\022\023\n\017AgentStatsRspId\020\024\022\024\n\020Ser"
+    "verStatsReqId\020\025\022\024\n\020ServerStatsRspId\020\026\022\026\n"
+    "\022FixGetHostKeyReqId\020\027", 1981);
   ::google::protobuf::MessageFactory::InternalRegisterGeneratedFile(
     "elb.proto", &protobuf_RegisterTypes);
   HostAddr::default_instance_ = new HostAddr();
@@ -398,8 +481,10 @@ void protobuf_AddDesc_elb_2eproto() {
   ReportStatusReq::default_instance_ = new ReportStatusReq();
   CacheGetRouteReq::default_instance_ = new CacheGetRouteReq();
   CacheGetRouteRsp::default_instance_ = new CacheGetRouteRsp();
+  CacheRouteNotify::default_instance_ = new CacheRouteNotify();
   HostBatchCallRes::default_instance_ = new HostBatchCallRes();
   CacheBatchRptReq::default_instance_ = new CacheBatchRptReq();
+  GetRouteBatchReq::default_instance_ = new GetRouteBatchReq();
   HostAddr::default_instance_->InitAsDefaultInstance();
   GetHostReq::default_instance_->InitAsDefaultInstance();
   GetHostRsp::default_instance_->InitAsDefaultInstance();
@@ -410,8 +495,10 @@ void protobuf_AddDesc_elb_2eproto() {
   ReportStatusReq::default_instance_->InitAsDefaultInstance();
   CacheGetRouteReq::default_instance_->InitAsDefaultInstance();
   CacheGetRouteRsp::default_instance_->InitAsDefaultInstance();
+  CacheRouteNotify::default_instance_->InitAsDefaultInstance();
   HostBatchCallRes::default_instance_->InitAsDefaultInstance();
   CacheBatchRptReq::default_instance_->InitAsDefaultInstance();
+  GetRouteBatchReq::default_instance_->InitAsDefaultInstance();
   ::google::protobuf::internal::OnShutdown(&protobuf_ShutdownFile_elb_2eproto);
 }
 
@@ -438,6 +525,18 @@ bool MsgTypeId_IsValid(int value) {
     case 9:
     case 10:
     case 11:
+    case 12:
+    case 13:
+    case 14:
+    case 15:
+    case 16:
+    case 17:
+    case 18:
+    case 19:
+    case 20:
+    case 21:
+    case 22:
+    case 23:
       return true;
     default:
       return false;
@@ -450,6 +549,8 @@ bool MsgTypeId_IsValid(int value) {
 #ifndef _MSC_VER
 const int HostAddr::kIpFieldNumber;
 const int HostAddr::kPortFieldNumber;
+const int HostAddr::kIdcFieldNumber;
+const int HostAddr::kRackFieldNumber;
 #endif  // !_MSC_VER
 
 HostAddr::HostAddr()
@@ -472,6 +573,8 @@ void HostAddr::SharedCtor() {
   _cached_size_ = 0;
   ip_ = 0;
   port_ = 0;
+  idc_ = 0u;
+  rack_ = 0u;
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
 }
 
@@ -517,7 +620,7 @@ void HostAddr::Clear() {
     ::memset(&first, 0, n);                                \
   } while (0)
 
-  ZR_(ip_, port_);
+  ZR_(ip_, rack_);
 
 #undef OFFSET_OF_FIELD_
 #undef ZR_
@@ -561,6 +664,36 @@ bool HostAddr::MergePartialFromCodedStream(
         } else {
           goto handle_unusual;
         }
+        if (input->ExpectTag(24)) goto parse_idc;
+        break;
+      }
+
+      // optional uint32 idc = 3;
+      case 3: {
+        if (tag == 24) {
+         parse_idc:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint32, ::google::protobuf::internal::WireFormatLite::TYPE_UINT32>(
+                 input, &idc_)));
+          set_has_idc();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(32)) goto parse_rack;
+        break;
+      }
+
+      // optional uint32 rack = 4;
+      case 4: {
+        if (tag == 32) {
+         parse_rack:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint32, ::google::protobuf::internal::WireFormatLite::TYPE_UINT32>(
+                 input, &rack_)));
+          set_has_rack();
+        } else {
+          goto handle_unusual;
+        }
         if (input->ExpectAtEnd()) goto success;
         break;
       }
@@ -600,6 +733,16 @@ void HostAddr::SerializeWithCachedSizes(
     ::google::protobuf::internal::WireFormatLite::WriteInt32(2, this->port(), output);
   }
 
+  // optional uint32 idc = 3;
+  if (has_idc()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt32(3, this->idc(), output);
+  }
+
+  // optional uint32 rack = 4;
+  if (has_rack()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt32(4, this->rack(), output);
+  }
+
   if (!unknown_fields().empty()) {
     ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
         unknown_fields(), output);
@@ -620,6 +763,16 @@ void HostAddr::SerializeWithCachedSizes(
     target = ::google::protobuf::internal::WireFormatLite::WriteInt32ToArray(2, this->port(), target);
   }
 
+  // optional uint32 idc = 3;
+  if (has_idc()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt32ToArray(3, this->idc(), target);
+  }
+
+  // optional uint32 rack = 4;
+  if (has_rack()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt32ToArray(4, this->rack(), target);
+  }
+
   if (!unknown_fields().empty()) {
     target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
         unknown_fields(), target);
@@ -646,6 +799,20 @@ int HostAddr::ByteSize() const {
           this->port());
     }
 
+    // optional uint32 idc = 3;
+    if (has_idc()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::UInt32Size(
+          this->idc());
+    }
+
+    // optional uint32 rack = 4;
+    if (has_rack()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::UInt32Size(
+          this->rack());
+    }
+
   }
   if (!unknown_fields().empty()) {
     total_size +=
@@ -679,6 +846,12 @@ void HostAddr::MergeFrom(const HostAddr& from) {
     if (from.has_port()) {
       set_port(from.port());
     }
+    if (from.has_idc()) {
+      set_idc(from.idc());
+    }
+    if (from.has_rack()) {
+      set_rack(from.rack());
+    }
   }
   mutable_unknown_fields()->MergeFrom(from.unknown_fields());
 }
@@ -705,6 +878,8 @@ void HostAddr::Swap(HostAddr* other) {
   if (other != this) {
     std::swap(ip_, other->ip_);
     std::swap(port_, other->port_);
+    std::swap(idc_, other->idc_);
+    std::swap(rack_, other->rack_);
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
@@ -726,6 +901,7 @@ void HostAddr::Swap(HostAddr* other) {
 const int GetHostReq::kSeqFieldNumber;
 const int GetHostReq::kModidFieldNumber;
 const int GetHostReq::kCmdidFieldNumber;
+const int GetHostReq::kHashkeyFieldNumber;
 #endif  // !_MSC_VER
 
 GetHostReq::GetHostReq()
@@ -749,6 +925,7 @@ void GetHostReq::SharedCtor() {
   seq_ = 0u;
   modid_ = 0;
   cmdid_ = 0;
+  hashkey_ = GOOGLE_ULONGLONG(0);
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
 }
 
@@ -853,6 +1030,21 @@ bool GetHostReq::MergePartialFromCodedStream(
         } else {
           goto handle_unusual;
         }
+        if (input->ExpectTag(32)) goto parse_hashkey;
+        break;
+      }
+
+      // optional uint64 hashkey = 4;
+      case 4: {
+        if (tag == 32) {
+         parse_hashkey:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
+                 input, &hashkey_)));
+          set_has_hashkey();
+        } else {
+          goto handle_unusual;
+        }
         if (input->ExpectAtEnd()) goto success;
         break;
       }
@@ -897,6 +1089,11 @@ void GetHostReq::SerializeWithCachedSizes(
     ::google::protobuf::internal::WireFormatLite::WriteInt32(3, this->cmdid(), output);
   }
 
+  // optional uint64 hashkey = 4;
+  if (has_hashkey()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt64(4, this->hashkey(), output);
+  }
+
   if (!unknown_fields().empty()) {
     ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
         unknown_fields(), output);
@@ -922,6 +1119,11 @@ void GetHostReq::SerializeWithCachedSizes(
     target = ::google::protobuf::internal::WireFormatLite::WriteInt32ToArray(3, this->cmdid(), target);
   }
 
+  // optional uint64 hashkey = 4;
+  if (has_hashkey()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(4, this->hashkey(), target);
+  }
+
   if (!unknown_fields().empty()) {
     target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
         unknown_fields(), target);
@@ -955,6 +1157,13 @@ int GetHostReq::ByteSize() const {
           this->cmdid());
     }
 
+    // optional uint64 hashkey = 4;
+    if (has_hashkey()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::UInt64Size(
+          this->hashkey());
+    }
+
   }
   if (!unknown_fields().empty()) {
     total_size +=
@@ -991,6 +1200,9 @@ void GetHostReq::MergeFrom(const GetHostReq& from) {
     if (from.has_cmdid()) {
       set_cmdid(from.cmdid());
     }
+    if (from.has_hashkey()) {
+      set_hashkey(from.hashkey());
+    }
   }
   mutable_unknown_fields()->MergeFrom(from.unknown_fields());
 }
@@ -1018,6 +1230,7 @@ void GetHostReq::Swap(GetHostReq* other) {
     std::swap(seq_, other->seq_);
     std::swap(modid_, other->modid_);
     std::swap(cmdid_, other->cmdid_);
+    std::swap(hashkey_, other->hashkey_);
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
@@ -3211,6 +3424,7 @@ void ReportStatusReq::Swap(ReportStatusReq* other) {
 const int CacheGetRouteReq::kModidFieldNumber;
 const int CacheGetRouteReq::kCmdidFieldNumber;
 const int CacheGetRouteReq::kVersionFieldNumber;
+const int CacheGetRouteReq::kSubportFieldNumber;
 #endif  // !_MSC_VER
 
 CacheGetRouteReq::CacheGetRouteReq()
@@ -3234,6 +3448,7 @@ void CacheGetRouteReq::SharedCtor() {
   modid_ = 0;
   cmdid_ = 0;
   version_ = GOOGLE_LONGLONG(0);
+  subport_ = 0;
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
 }
 
@@ -3279,7 +3494,7 @@ void CacheGetRouteReq::Clear() {
     ::memset(&first, 0, n);                                \
   } while (0)
 
-  ZR_(modid_, version_);
+  ZR_(modid_, subport_);
 
 #undef OFFSET_OF_FIELD_
 #undef ZR_
@@ -3338,6 +3553,21 @@ bool CacheGetRouteReq::MergePartialFromCodedStream(
         } else {
           goto handle_unusual;
         }
+        if (input->ExpectTag(32)) goto parse_subport;
+        break;
+      }
+
+      // optional int32 subport = 4;
+      case 4: {
+        if (tag == 32) {
+         parse_subport:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::int32, ::google::protobuf::internal::WireFormatLite::TYPE_INT32>(
+                 input, &subport_)));
+          set_has_subport();
+        } else {
+          goto handle_unusual;
+        }
         if (input->ExpectAtEnd()) goto success;
         break;
       }
@@ -3382,6 +3612,11 @@ void CacheGetRouteReq::SerializeWithCachedSizes(
     ::google::protobuf::internal::WireFormatLite::WriteInt64(3, this->version(), output);
   }
 
+  // optional int32 subport = 4;
+  if (has_subport()) {
+    ::google::protobuf::internal::WireFormatLite::WriteInt32(4, this->subport(), output);
+  }
+
   if (!unknown_fields().empty()) {
     ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
         unknown_fields(), output);
@@ -3407,6 +3642,11 @@ void CacheGetRouteReq::SerializeWithCachedSizes(
     target = ::google::protobuf::internal::WireFormatLite::WriteInt64ToArray(3, this->version(), target);
   }
 
+  // optional int32 subport = 4;
+  if (has_subport()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt32ToArray(4, this->subport(), target);
+  }
+
   if (!unknown_fields().empty()) {
     target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
         unknown_fields(), target);
@@ -3440,6 +3680,13 @@ int CacheGetRouteReq::ByteSize() const {
           this->version());
     }
 
+    // optional int32 subport = 4;
+    if (has_subport()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::Int32Size(
+          this->subport());
+    }
+
   }
   if (!unknown_fields().empty()) {
     total_size +=
@@ -3476,6 +3723,9 @@ void CacheGetRouteReq::MergeFrom(const CacheGetRouteReq& from) {
     if (from.has_version()) {
       set_version(from.version());
     }
+    if (from.has_subport()) {
+      set_subport(from.subport());
+    }
   }
   mutable_unknown_fields()->MergeFrom(from.unknown_fields());
 }
@@ -3503,6 +3753,7 @@ void CacheGetRouteReq::Swap(CacheGetRouteReq* other) {
     std::swap(modid_, other->modid_);
     std::swap(cmdid_, other->cmdid_);
     std::swap(version_, other->version_);
+    std::swap(subport_, other->subport_);
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
@@ -3526,6 +3777,15 @@ const int CacheGetRouteRsp::kCmdidFieldNumber;
 const int CacheGetRouteRsp::kVersionFieldNumber;
 const int CacheGetRouteRsp::kOverloadFieldNumber;
 const int CacheGetRouteRsp::kRouteFieldNumber;
+const int CacheGetRouteRsp::kPushedFieldNumber;
+const int CacheGetRouteRsp::kDownsFieldNumber;
+const int CacheGetRouteRsp::kProbeNumFieldNumber;
+const int CacheGetRouteRsp::kHashpolicyFieldNumber;
+const int CacheGetRouteRsp::kHashparamFieldNumber;
+const int CacheGetRouteRsp::kLocalitiesFieldNumber;
+const int CacheGetRouteRsp::kLocalminFieldNumber;
+const int CacheGetRouteRsp::kSpillpctFieldNumber;
+const int CacheGetRouteRsp::kPushseqFieldNumber;
 #endif  // !_MSC_VER
 
 CacheGetRouteRsp::CacheGetRouteRsp()
@@ -3550,6 +3810,13 @@ void CacheGetRouteRsp::SharedCtor() {
   cmdid_ = 0;
   version_ = GOOGLE_LONGLONG(0);
   overload_ = false;
+  pushed_ = false;
+  probenum_ = 0;
+  hashpolicy_ = 0;
+  hashparam_ = 0;
+  localmin_ = 0;
+  spillpct_ = 0;
+  pushseq_ = 0u;
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
 }
 
@@ -3595,15 +3862,21 @@ void CacheGetRouteRsp::Clear() {
     ::memset(&first, 0, n);                                \
   } while (0)
 
-  if (_has_bits_[0 / 32] & 15) {
+  if (_has_bits_[0 / 32] & 175) {
     ZR_(modid_, version_);
-    overload_ = false;
+    ZR_(overload_, probenum_);
+  }
+  if (_has_bits_[8 / 32] & 15104) {
+    ZR_(hashpolicy_, hashparam_);
+    ZR_(localmin_, pushseq_);
   }
 
 #undef OFFSET_OF_FIELD_
 #undef ZR_
 
   route_.Clear();
+  downs_.Clear();
+  localities_.Clear();
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
   mutable_unknown_fields()->Clear();
 }
@@ -3687,6 +3960,141 @@ bool CacheGetRouteRsp::MergePartialFromCodedStream(
           goto handle_unusual;
         }
         if (input->ExpectTag(42)) goto parse_route;
+        if (input->ExpectTag(48)) goto parse_pushed;
+        break;
+      }
+
+      // optional bool pushed = 6;
+      case 6: {
+        if (tag == 48) {
+         parse_pushed:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   bool, ::google::protobuf::internal::WireFormatLite::TYPE_BOOL>(
+                 input, &pushed_)));
+          set_has_pushed();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(58)) goto parse_downs;
+        break;
+      }
+
+      // repeated .elb.HostAddr downs = 7;
+      case 7: {
+        if (tag == 58) {
+         parse_downs:
+          DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
+                input, add_downs()));
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(58)) goto parse_downs;
+        if (input->ExpectTag(64)) goto parse_probeNum;
+        break;
+      }
+
+      // optional int32 probeNum = 8;
+      case 8: {
+        if (tag == 64) {
+         parse_probeNum:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::int32, ::google::protobuf::internal::WireFormatLite::TYPE_INT32>(
+                 input, &probenum_)));
+          set_has_probenum();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(72)) goto parse_hashpolicy;
+        break;
+      }
+
+      // optional int32 hashpolicy = 9;
+      case 9: {
+        if (tag == 72) {
+         parse_hashpolicy:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::int32, ::google::protobuf::internal::WireFormatLite::TYPE_INT32>(
+                 input, &hashpolicy_)));
+          set_has_hashpolicy();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(80)) goto parse_hashparam;
+        break;
+      }
+
+      // optional int32 hashparam = 10;
+      case 10: {
+        if (tag == 80) {
+         parse_hashparam:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::int32, ::google::protobuf::internal::WireFormatLite::TYPE_INT32>(
+                 input, &hashparam_)));
+          set_has_hashparam();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(88)) goto parse_localities;
+        break;
+      }
+
+      // repeated int32 localities = 11;
+      case 11: {
+        if (tag == 88) {
+         parse_localities:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::int32, ::google::protobuf::internal::WireFormatLite::TYPE_INT32>(
+                 input, &localities_)));
+          set_has_localities();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(88)) goto parse_localities;
+        if (input->ExpectTag(96)) goto parse_localmin;
+        break;
+      }
+
+      // optional int32 localmin = 12;
+      case 12: {
+        if (tag == 96) {
+         parse_localmin:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::int32, ::google::protobuf::internal::WireFormatLite::TYPE_INT32>(
+                 input, &localmin_)));
+          set_has_localmin();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(104)) goto parse_spillpct;
+        break;
+      }
+
+      // optional int32 spillpct = 13;
+      case 13: {
+        if (tag == 104) {
+         parse_spillpct:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::int32, ::google::protobuf::internal::WireFormatLite::TYPE_INT32>(
+                 input, &spillpct_)));
+          set_has_spillpct();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(112)) goto parse_pushseq;
+        break;
+      }
+
+      // optional uint32 pushseq = 14;
+      case 14: {
+        if (tag == 112) {
+         parse_pushseq:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint32, ::google::protobuf::internal::WireFormatLite::TYPE_UINT32>(
+                 input, &pushseq_)));
+          set_has_pushseq();
+        } else {
+          goto handle_unusual;
+        }
         if (input->ExpectAtEnd()) goto success;
         break;
       }
@@ -3742,6 +4150,53 @@ void CacheGetRouteRsp::SerializeWithCachedSizes(
       5, this->route(i), output);
   }
 
+  // optional bool pushed = 6;
+  if (has_pushed()) {
+    ::google::protobuf::internal::WireFormatLite::WriteBool(6, this->pushed(), output);
+  }
+
+  // repeated .elb.HostAddr downs = 7;
+  for (int i = 0; i < this->downs_size(); i++) {
+    ::google::protobuf::internal::WireFormatLite::WriteMessageMaybeToArray(
+      7, this->downs(i), output);
+  }
+
+  // optional int32 probeNum = 8;
+  if (has_probenum()) {
+    ::google::protobuf::internal::WireFormatLite::WriteInt32(8, this->probenum(), output);
+  }
+
+  // optional int32 hashpolicy = 9;
+  if (has_hashpolicy()) {
+    ::google::protobuf::internal::WireFormatLite::WriteInt32(9, this->hashpolicy(), output);
+  }
+
+  // optional int32 hashparam = 10;
+  if (has_hashparam()) {
+    ::google::protobuf::internal::WireFormatLite::WriteInt32(10, this->hashparam(), output);
+  }
+
+  // repeated int32 localities = 11;
+  for (int i = 0; i < this->localities_size(); i++) {
+    ::google::protobuf::internal::WireFormatLite::WriteMessageMaybeToArray(
+      11, this->localities(i), output);
+  }
+
+  // optional int32 localmin = 12;
+  if (has_localmin()) {
+    ::google::protobuf::internal::WireFormatLite::WriteInt32(12, this->localmin(), output);
+  }
+
+  // optional int32 spillpct = 13;
+  if (has_spillpct()) {
+    ::google::protobuf::internal::WireFormatLite::WriteInt32(13, this->spillpct(), output);
+  }
+
+  // optional uint32 pushseq = 14;
+  if (has_pushseq()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt32(14, this->pushseq(), output);
+  }
+
   if (!unknown_fields().empty()) {
     ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
         unknown_fields(), output);
@@ -3779,6 +4234,55 @@ void CacheGetRouteRsp::SerializeWithCachedSizes(
         5, this->route(i), target);
   }
 
+  // optional bool pushed = 6;
+  if (has_pushed()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(6, this->pushed(), target);
+  }
+
+  // repeated .elb.HostAddr downs = 7;
+  for (int i = 0; i < this->downs_size(); i++) {
+    target = ::google::protobuf::internal::WireFormatLite::
+      WriteMessageNoVirtualToArray(
+        7, this->downs(i), target);
+  }
+
+  // optional int32 probeNum = 8;
+  if (has_probenum()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt32ToArray(8, this->probenum(), target);
+  }
+
+  // optional int32 hashpolicy = 9;
+  if (has_hashpolicy()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt32ToArray(9, this->hashpolicy(), target);
+  }
+
+  // optional int32 hashparam = 10;
+  if (has_hashparam()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt32ToArray(10, this->hashparam(), target);
+  }
+
+  // repeated int32 localities = 11;
+  for (int i = 0; i < this->localities_size(); i++) {
+    target = ::google::protobuf::internal::WireFormatLite::
+      WriteMessageNoVirtualToArray(
+        11, this->localities(i), target);
+  }
+
+  // optional int32 localmin = 12;
+  if (has_localmin()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt32ToArray(12, this->localmin(), target);
+  }
+
+  // optional int32 spillpct = 13;
+  if (has_spillpct()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt32ToArray(13, this->spillpct(), target);
+  }
+
+  // optional uint32 pushseq = 14;
+  if (has_pushseq()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt32ToArray(14, this->pushseq(), target);
+  }
+
   if (!unknown_fields().empty()) {
     target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
         unknown_fields(), target);
@@ -3817,6 +4321,55 @@ int CacheGetRouteRsp::ByteSize() const {
       total_size += 1 + 1;
     }
 
+    // optional bool pushed = 6;
+    if (has_pushed()) {
+      total_size += 1 + 1;
+    }
+
+    // optional int32 probeNum = 8;
+    if (has_probenum()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::Int32Size(
+          this->probenum());
+    }
+
+  }
+  if (_has_bits_[8 / 32] & (0xffu << (8 % 32))) {
+    // optional int32 hashpolicy = 9;
+    if (has_hashpolicy()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::Int32Size(
+          this->hashpolicy());
+    }
+
+    // optional int32 hashparam = 10;
+    if (has_hashparam()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::Int32Size(
+          this->hashparam());
+    }
+
+    // optional int32 localmin = 12;
+    if (has_localmin()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::Int32Size(
+          this->localmin());
+    }
+
+    // optional int32 spillpct = 13;
+    if (has_spillpct()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::Int32Size(
+          this->spillpct());
+    }
+
+    // optional uint32 pushseq = 14;
+    if (has_pushseq()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::UInt32Size(
+          this->pushseq());
+    }
+
   }
   // repeated .elb.HostAddr route = 5;
   total_size += 1 * this->route_size();
@@ -3826,6 +4379,22 @@ int CacheGetRouteRsp::ByteSize() const {
         this->route(i));
   }
 
+  // repeated .elb.HostAddr downs = 7;
+  total_size += 1 * this->downs_size();
+  for (int i = 0; i < this->downs_size(); i++) {
+    total_size +=
+      ::google::protobuf::internal::WireFormatLite::MessageSizeNoVirtual(
+        this->downs(i));
+  }
+
+  // repeated int32 localities = 11;
+  total_size += 1 * this->localities_size();
+  for (int i = 0; i < this->localities_size(); i++) {
+    total_size +=
+      ::google::protobuf::internal::WireFormatLite::MessageSizeNoVirtual(
+        this->localities(i));
+  }
+
   if (!unknown_fields().empty()) {
     total_size +=
       ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
@@ -3852,6 +4421,8 @@ void CacheGetRouteRsp::MergeFrom(const ::google::protobuf::Message& from) {
 void CacheGetRouteRsp::MergeFrom(const CacheGetRouteRsp& from) {
   GOOGLE_CHECK_NE(&from, this);
   route_.MergeFrom(from.route_);
+  downs_.MergeFrom(from.downs_);
+  localities_.MergeFrom(from.localities_);
   if (from._has_bits_[0 / 32] & (0xffu << (0 % 32))) {
     if (from.has_modid()) {
       set_modid(from.modid());
@@ -3865,6 +4436,29 @@ void CacheGetRouteRsp::MergeFrom(const CacheGetRouteRsp& from) {
     if (from.has_overload()) {
       set_overload(from.overload());
     }
+    if (from.has_pushed()) {
+      set_pushed(from.pushed());
+    }
+    if (from.has_probenum()) {
+      set_probenum(from.probenum());
+    }
+  }
+  if (from._has_bits_[8 / 32] & (0xffu << (8 % 32))) {
+    if (from.has_hashpolicy()) {
+      set_hashpolicy(from.hashpolicy());
+    }
+    if (from.has_hashparam()) {
+      set_hashparam(from.hashparam());
+    }
+    if (from.has_localmin()) {
+      set_localmin(from.localmin());
+    }
+    if (from.has_spillpct()) {
+      set_spillpct(from.spillpct());
+    }
+    if (from.has_pushseq()) {
+      set_pushseq(from.pushseq());
+    }
   }
   mutable_unknown_fields()->MergeFrom(from.unknown_fields());
 }
@@ -3885,6 +4479,7 @@ bool CacheGetRouteRsp::IsInitialized() const {
   if ((_has_bits_[0] & 0x00000007) != 0x00000007) return false;
 
   if (!::google::protobuf::internal::AllAreInitialized(this->route())) return false;
+  if (!::google::protobuf::internal::AllAreInitialized(this->downs())) return false;
   return true;
 }
 
@@ -3895,6 +4490,15 @@ void CacheGetRouteRsp::Swap(CacheGetRouteRsp* other) {
     std::swap(version_, other->version_);
     std::swap(overload_, other->overload_);
     route_.Swap(&other->route_);
+    std::swap(pushed_, other->pushed_);
+    downs_.Swap(&other->downs_);
+    std::swap(probenum_, other->probenum_);
+    std::swap(hashpolicy_, other->hashpolicy_);
+    std::swap(hashparam_, other->hashparam_);
+    localities_.Swap(&other->localities_);
+    std::swap(localmin_, other->localmin_);
+    std::swap(spillpct_, other->spillpct_);
+    std::swap(pushseq_, other->pushseq_);
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
@@ -3913,32 +4517,504 @@ void CacheGetRouteRsp::Swap(CacheGetRouteRsp* other) {
 // ===================================================================
 
 #ifndef _MSC_VER
-const int HostBatchCallRes::kIpFieldNumber;
-const int HostBatchCallRes::kPortFieldNumber;
-const int HostBatchCallRes::kSuccCntFieldNumber;
+const int CacheRouteNotify::kModidFieldNumber;
+const int CacheRouteNotify::kCmdidFieldNumber;
+const int CacheRouteNotify::kVersionFieldNumber;
+const int CacheRouteNotify::kOverloadFieldNumber;
+const int CacheRouteNotify::kDownsFieldNumber;
+const int CacheRouteNotify::kProbeNumFieldNumber;
+const int CacheRouteNotify::kPushseqFieldNumber;
 #endif  // !_MSC_VER
 
-HostBatchCallRes::HostBatchCallRes()
+CacheRouteNotify::CacheRouteNotify()
   : ::google::protobuf::Message() {
   SharedCtor();
-  // @@protoc_insertion_point(constructor:elb.HostBatchCallRes)
+  // @@protoc_insertion_point(constructor:elb.CacheRouteNotify)
 }
 
-void HostBatchCallRes::InitAsDefaultInstance() {
+void CacheRouteNotify::InitAsDefaultInstance() {
 }
 
-HostBatchCallRes::HostBatchCallRes(const HostBatchCallRes& from)
+CacheRouteNotify::CacheRouteNotify(const CacheRouteNotify& from)
   : ::google::protobuf::Message() {
   SharedCtor();
   MergeFrom(from);
-  // @@protoc_insertion_point(copy_constructor:elb.HostBatchCallRes)
+  // @@protoc_insertion_point(copy_constructor:elb.CacheRouteNotify)
 }
 
-void HostBatchCallRes::SharedCtor() {
+void CacheRouteNotify::SharedCtor() {
   _cached_size_ = 0;
-  ip_ = 0;
+  modid_ = 0;
+  cmdid_ = 0;
+  version_ = GOOGLE_LONGLONG(0);
+  overload_ = false;
+  probenum_ = 0;
+  pushseq_ = 0u;
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+}
+
+CacheRouteNotify::~CacheRouteNotify() {
+  // @@protoc_insertion_point(destructor:elb.CacheRouteNotify)
+  SharedDtor();
+}
+
+void CacheRouteNotify::SharedDtor() {
+  if (this != default_instance_) {
+  }
+}
+
+void CacheRouteNotify::SetCachedSize(int size) const {
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+}
+const ::google::protobuf::Descriptor* CacheRouteNotify::descriptor() {
+  protobuf_AssignDescriptorsOnce();
+  return CacheRouteNotify_descriptor_;
+}
+
+const CacheRouteNotify& CacheRouteNotify::default_instance() {
+  if (default_instance_ == NULL) protobuf_AddDesc_elb_2eproto();
+  return *default_instance_;
+}
+
+CacheRouteNotify* CacheRouteNotify::default_instance_ = NULL;
+
+CacheRouteNotify* CacheRouteNotify::New() const {
+  return new CacheRouteNotify;
+}
+
+void CacheRouteNotify::Clear() {
+#define OFFSET_OF_FIELD_(f) (reinterpret_cast<char*>(      \
+  &reinterpret_cast<CacheRouteNotify*>(16)->f) - \
+   reinterpret_cast<char*>(16))
+
+#define ZR_(first, last) do {                              \
+    size_t f = OFFSET_OF_FIELD_(first);                    \
+    size_t n = OFFSET_OF_FIELD_(last) - f + sizeof(last);  \
+    ::memset(&first, 0, n);                                \
+  } while (0)
+
+  if (_has_bits_[0 / 32] & 111) {
+    ZR_(modid_, version_);
+    ZR_(overload_, pushseq_);
+  }
+
+#undef OFFSET_OF_FIELD_
+#undef ZR_
+
+  downs_.Clear();
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  mutable_unknown_fields()->Clear();
+}
+
+bool CacheRouteNotify::MergePartialFromCodedStream(
+    ::google::protobuf::io::CodedInputStream* input) {
+#define DO_(EXPRESSION) if (!(EXPRESSION)) goto failure
+  ::google::protobuf::uint32 tag;
+  // @@protoc_insertion_point(parse_start:elb.CacheRouteNotify)
+  for (;;) {
+    ::std::pair< ::google::protobuf::uint32, bool> p = input->ReadTagWithCutoff(127);
+    tag = p.first;
+    if (!p.second) goto handle_unusual;
+    switch (::google::protobuf::internal::WireFormatLite::GetTagFieldNumber(tag)) {
+      // required int32 modid = 1;
+      case 1: {
+        if (tag == 8) {
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::int32, ::google::protobuf::internal::WireFormatLite::TYPE_INT32>(
+                 input, &modid_)));
+          set_has_modid();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(16)) goto parse_cmdid;
+        break;
+      }
+
+      // required int32 cmdid = 2;
+      case 2: {
+        if (tag == 16) {
+         parse_cmdid:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::int32, ::google::protobuf::internal::WireFormatLite::TYPE_INT32>(
+                 input, &cmdid_)));
+          set_has_cmdid();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(24)) goto parse_version;
+        break;
+      }
+
+      // required int64 version = 3;
+      case 3: {
+        if (tag == 24) {
+         parse_version:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::int64, ::google::protobuf::internal::WireFormatLite::TYPE_INT64>(
+                 input, &version_)));
+          set_has_version();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(32)) goto parse_overload;
+        break;
+      }
+
+      // optional bool overload = 4;
+      case 4: {
+        if (tag == 32) {
+         parse_overload:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   bool, ::google::protobuf::internal::WireFormatLite::TYPE_BOOL>(
+                 input, &overload_)));
+          set_has_overload();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(42)) goto parse_downs;
+        break;
+      }
+
+      // repeated .elb.HostAddr downs = 5;
+      case 5: {
+        if (tag == 42) {
+         parse_downs:
+          DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
+                input, add_downs()));
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(42)) goto parse_downs;
+        if (input->ExpectTag(48)) goto parse_probeNum;
+        break;
+      }
+
+      // optional int32 probeNum = 6;
+      case 6: {
+        if (tag == 48) {
+         parse_probeNum:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::int32, ::google::protobuf::internal::WireFormatLite::TYPE_INT32>(
+                 input, &probenum_)));
+          set_has_probenum();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(56)) goto parse_pushseq;
+        break;
+      }
+
+      // optional uint32 pushseq = 7;
+      case 7: {
+        if (tag == 56) {
+         parse_pushseq:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint32, ::google::protobuf::internal::WireFormatLite::TYPE_UINT32>(
+                 input, &pushseq_)));
+          set_has_pushseq();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectAtEnd()) goto success;
+        break;
+      }
+
+      default: {
+      handle_unusual:
+        if (tag == 0 ||
+            ::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_END_GROUP) {
+          goto success;
+        }
+        DO_(::google::protobuf::internal::WireFormat::SkipField(
+              input, tag, mutable_unknown_fields()));
+        break;
+      }
+    }
+  }
+success:
+  // @@protoc_insertion_point(parse_success:elb.CacheRouteNotify)
+  return true;
+failure:
+  // @@protoc_insertion_point(parse_failure:elb.CacheRouteNotify)
+  return false;
+#undef DO_
+}
+
+void CacheRouteNotify::SerializeWithCachedSizes(
+    ::google::protobuf::io::CodedOutputStream* output) const {
+  // @@protoc_insertion_point(serialize_start:elb.CacheRouteNotify)
+  // required int32 modid = 1;
+  if (has_modid()) {
+    ::google::protobuf::internal::WireFormatLite::WriteInt32(1, this->modid(), output);
+  }
+
+  // required int32 cmdid = 2;
+  if (has_cmdid()) {
+    ::google::protobuf::internal::WireFormatLite::WriteInt32(2, this->cmdid(), output);
+  }
+
+  // required int64 version = 3;
+  if (has_version()) {
+    ::google::protobuf::internal::WireFormatLite::WriteInt64(3, this->version(), output);
+  }
+
+  // optional bool overload = 4;
+  if (has_overload()) {
+    ::google::protobuf::internal::WireFormatLite::WriteBool(4, this->overload(), output);
+  }
+
+  // repeated .elb.HostAddr downs = 5;
+  for (int i = 0; i < this->downs_size(); i++) {
+    ::google::protobuf::internal::WireFormatLite::WriteMessageMaybeToArray(
+      5, this->downs(i), output);
+  }
+
+  // optional int32 probeNum = 6;
+  if (has_probenum()) {
+    ::google::protobuf::internal::WireFormatLite::WriteInt32(6, this->probenum(), output);
+  }
+
+  // optional uint32 pushseq = 7;
+  if (has_pushseq()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt32(7, this->pushseq(), output);
+  }
+
+  if (!unknown_fields().empty()) {
+    ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
+        unknown_fields(), output);
+  }
+  // @@protoc_insertion_point(serialize_end:elb.CacheRouteNotify)
+}
+
+::google::protobuf::uint8* CacheRouteNotify::SerializeWithCachedSizesToArray(
+    ::google::protobuf::uint8* target) const {
+  // @@protoc_insertion_point(serialize_to_array_start:elb.CacheRouteNotify)
+  // required int32 modid = 1;
+  if (has_modid()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt32ToArray(1, this->modid(), target);
+  }
+
+  // required int32 cmdid = 2;
+  if (has_cmdid()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt32ToArray(2, this->cmdid(), target);
+  }
+
+  // required int64 version = 3;
+  if (has_version()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt64ToArray(3, this->version(), target);
+  }
+
+  // optional bool overload = 4;
+  if (has_overload()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(4, this->overload(), target);
+  }
+
+  // repeated .elb.HostAddr downs = 5;
+  for (int i = 0; i < this->downs_size(); i++) {
+    target = ::google::protobuf::internal::WireFormatLite::
+      WriteMessageNoVirtualToArray(
+        5, this->downs(i), target);
+  }
+
+  // optional int32 probeNum = 6;
+  if (has_probenum()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt32ToArray(6, this->probenum(), target);
+  }
+
+  // optional uint32 pushseq = 7;
+  if (has_pushseq()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt32ToArray(7, this->pushseq(), target);
+  }
+
+  if (!unknown_fields().empty()) {
+    target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
+        unknown_fields(), target);
+  }
+  // @@protoc_insertion_point(serialize_to_array_end:elb.CacheRouteNotify)
+  return target;
+}
+
+int CacheRouteNotify::ByteSize() const {
+  int total_size = 0;
+
+  if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    // required int32 modid = 1;
+    if (has_modid()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::Int32Size(
+          this->modid());
+    }
+
+    // required int32 cmdid = 2;
+    if (has_cmdid()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::Int32Size(
+          this->cmdid());
+    }
+
+    // required int64 version = 3;
+    if (has_version()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::Int64Size(
+          this->version());
+    }
+
+    // optional bool overload = 4;
+    if (has_overload()) {
+      total_size += 1 + 1;
+    }
+
+    // optional int32 probeNum = 6;
+    if (has_probenum()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::Int32Size(
+          this->probenum());
+    }
+
+    // optional uint32 pushseq = 7;
+    if (has_pushseq()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::UInt32Size(
+          this->pushseq());
+    }
+
+  }
+  // repeated .elb.HostAddr downs = 5;
+  total_size += 1 * this->downs_size();
+  for (int i = 0; i < this->downs_size(); i++) {
+    total_size +=
+      ::google::protobuf::internal::WireFormatLite::MessageSizeNoVirtual(
+        this->downs(i));
+  }
+
+  if (!unknown_fields().empty()) {
+    total_size +=
+      ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
+        unknown_fields());
+  }
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = total_size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+  return total_size;
+}
+
+void CacheRouteNotify::MergeFrom(const ::google::protobuf::Message& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  const CacheRouteNotify* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const CacheRouteNotify*>(
+      &from);
+  if (source == NULL) {
+    ::google::protobuf::internal::ReflectionOps::Merge(from, this);
+  } else {
+    MergeFrom(*source);
+  }
+}
+
+void CacheRouteNotify::MergeFrom(const CacheRouteNotify& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  downs_.MergeFrom(from.downs_);
+  if (from._has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    if (from.has_modid()) {
+      set_modid(from.modid());
+    }
+    if (from.has_cmdid()) {
+      set_cmdid(from.cmdid());
+    }
+    if (from.has_version()) {
+      set_version(from.version());
+    }
+    if (from.has_overload()) {
+      set_overload(from.overload());
+    }
+    if (from.has_probenum()) {
+      set_probenum(from.probenum());
+    }
+    if (from.has_pushseq()) {
+      set_pushseq(from.pushseq());
+    }
+  }
+  mutable_unknown_fields()->MergeFrom(from.unknown_fields());
+}
+
+void CacheRouteNotify::CopyFrom(const ::google::protobuf::Message& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+void CacheRouteNotify::CopyFrom(const CacheRouteNotify& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool CacheRouteNotify::IsInitialized() const {
+  if ((_has_bits_[0] & 0x00000007) != 0x00000007) return false;
+
+  if (!::google::protobuf::internal::AllAreInitialized(this->downs())) return false;
+  return true;
+}
+
+void CacheRouteNotify::Swap(CacheRouteNotify* other) {
+  if (other != this) {
+    std::swap(modid_, other->modid_);
+    std::swap(cmdid_, other->cmdid_);
+    std::swap(version_, other->version_);
+    std::swap(overload_, other->overload_);
+    downs_.Swap(&other->downs_);
+    std::swap(probenum_, other->probenum_);
+    std::swap(pushseq_, other->pushseq_);
+    std::swap(_has_bits_[0], other->_has_bits_[0]);
+    _unknown_fields_.Swap(&other->_unknown_fields_);
+    std::swap(_cached_size_, other->_cached_size_);
+  }
+}
+
+::google::protobuf::Metadata CacheRouteNotify::GetMetadata() const {
+  protobuf_AssignDescriptorsOnce();
+  ::google::protobuf::Metadata metadata;
+  metadata.descriptor = CacheRouteNotify_descriptor_;
+  metadata.reflection = CacheRouteNotify_reflection_;
+  return metadata;
+}
+
+
+// ===================================================================
+
+#ifndef _MSC_VER
+const int HostBatchCallRes::kIpFieldNumber;
+const int HostBatchCallRes::kPortFieldNumber;
+const int HostBatchCallRes::kSuccCntFieldNumber;
+const int HostBatchCallRes::kCostSumFieldNumber;
+const int HostBatchCallRes::kCostCntFieldNumber;
+#endif  // !_MSC_VER
+
+HostBatchCallRes::HostBatchCallRes()
+  : ::google::protobuf::Message() {
+  SharedCtor();
+  // @@protoc_insertion_point(constructor:elb.HostBatchCallRes)
+}
+
+void HostBatchCallRes::InitAsDefaultInstance() {
+}
+
+HostBatchCallRes::HostBatchCallRes(const HostBatchCallRes& from)
+  : ::google::protobuf::Message() {
+  SharedCtor();
+  MergeFrom(from);
+  // @@protoc_insertion_point(copy_constructor:elb.HostBatchCallRes)
+}
+
+void HostBatchCallRes::SharedCtor() {
+  _cached_size_ = 0;
+  ip_ = 0;
   port_ = 0;
   succcnt_ = 0u;
+  costsum_ = GOOGLE_ULONGLONG(0);
+  costcnt_ = 0u;
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
 }
 
@@ -3984,7 +5060,9 @@ void HostBatchCallRes::Clear() {
     ::memset(&first, 0, n);                                \
   } while (0)
 
-  ZR_(ip_, succcnt_);
+  if (_has_bits_[0 / 32] & 31) {
+    ZR_(ip_, costcnt_);
+  }
 
 #undef OFFSET_OF_FIELD_
 #undef ZR_
@@ -4043,6 +5121,36 @@ bool HostBatchCallRes::MergePartialFromCodedStream(
         } else {
           goto handle_unusual;
         }
+        if (input->ExpectTag(32)) goto parse_costSum;
+        break;
+      }
+
+      // optional uint64 costSum = 4;
+      case 4: {
+        if (tag == 32) {
+         parse_costSum:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
+                 input, &costsum_)));
+          set_has_costsum();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(40)) goto parse_costCnt;
+        break;
+      }
+
+      // optional uint32 costCnt = 5;
+      case 5: {
+        if (tag == 40) {
+         parse_costCnt:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint32, ::google::protobuf::internal::WireFormatLite::TYPE_UINT32>(
+                 input, &costcnt_)));
+          set_has_costcnt();
+        } else {
+          goto handle_unusual;
+        }
         if (input->ExpectAtEnd()) goto success;
         break;
       }
@@ -4087,6 +5195,16 @@ void HostBatchCallRes::SerializeWithCachedSizes(
     ::google::protobuf::internal::WireFormatLite::WriteUInt32(3, this->succcnt(), output);
   }
 
+  // optional uint64 costSum = 4;
+  if (has_costsum()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt64(4, this->costsum(), output);
+  }
+
+  // optional uint32 costCnt = 5;
+  if (has_costcnt()) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt32(5, this->costcnt(), output);
+  }
+
   if (!unknown_fields().empty()) {
     ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
         unknown_fields(), output);
@@ -4112,6 +5230,16 @@ void HostBatchCallRes::SerializeWithCachedSizes(
     target = ::google::protobuf::internal::WireFormatLite::WriteUInt32ToArray(3, this->succcnt(), target);
   }
 
+  // optional uint64 costSum = 4;
+  if (has_costsum()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(4, this->costsum(), target);
+  }
+
+  // optional uint32 costCnt = 5;
+  if (has_costcnt()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt32ToArray(5, this->costcnt(), target);
+  }
+
   if (!unknown_fields().empty()) {
     target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
         unknown_fields(), target);
@@ -4145,6 +5273,20 @@ int HostBatchCallRes::ByteSize() const {
           this->succcnt());
     }
 
+    // optional uint64 costSum = 4;
+    if (has_costsum()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::UInt64Size(
+          this->costsum());
+    }
+
+    // optional uint32 costCnt = 5;
+    if (has_costcnt()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::UInt32Size(
+          this->costcnt());
+    }
+
   }
   if (!unknown_fields().empty()) {
     total_size +=
@@ -4181,6 +5323,12 @@ void HostBatchCallRes::MergeFrom(const HostBatchCallRes& from) {
     if (from.has_succcnt()) {
       set_succcnt(from.succcnt());
     }
+    if (from.has_costsum()) {
+      set_costsum(from.costsum());
+    }
+    if (from.has_costcnt()) {
+      set_costcnt(from.costcnt());
+    }
   }
   mutable_unknown_fields()->MergeFrom(from.unknown_fields());
 }
@@ -4208,6 +5356,8 @@ void HostBatchCallRes::Swap(HostBatchCallRes* other) {
     std::swap(ip_, other->ip_);
     std::swap(port_, other->port_);
     std::swap(succcnt_, other->succcnt_);
+    std::swap(costsum_, other->costsum_);
+    std::swap(costcnt_, other->costcnt_);
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
@@ -4538,6 +5688,226 @@ void CacheBatchRptReq::Swap(CacheBatchRptReq* other) {
 }
 
 
+// ===================================================================
+
+#ifndef _MSC_VER
+const int GetRouteBatchReq::kReqsFieldNumber;
+#endif  // !_MSC_VER
+
+GetRouteBatchReq::GetRouteBatchReq()
+  : ::google::protobuf::Message() {
+  SharedCtor();
+  // @@protoc_insertion_point(constructor:elb.GetRouteBatchReq)
+}
+
+void GetRouteBatchReq::InitAsDefaultInstance() {
+}
+
+GetRouteBatchReq::GetRouteBatchReq(const GetRouteBatchReq& from)
+  : ::google::protobuf::Message() {
+  SharedCtor();
+  MergeFrom(from);
+  // @@protoc_insertion_point(copy_constructor:elb.GetRouteBatchReq)
+}
+
+void GetRouteBatchReq::SharedCtor() {
+  _cached_size_ = 0;
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+}
+
+GetRouteBatchReq::~GetRouteBatchReq() {
+  // @@protoc_insertion_point(destructor:elb.GetRouteBatchReq)
+  SharedDtor();
+}
+
+void GetRouteBatchReq::SharedDtor() {
+  if (this != default_instance_) {
+  }
+}
+
+void GetRouteBatchReq::SetCachedSize(int size) const {
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+}
+const ::google::protobuf::Descriptor* GetRouteBatchReq::descriptor() {
+  protobuf_AssignDescriptorsOnce();
+  return GetRouteBatchReq_descriptor_;
+}
+
+const GetRouteBatchReq& GetRouteBatchReq::default_instance() {
+  if (default_instance_ == NULL) protobuf_AddDesc_elb_2eproto();
+  return *default_instance_;
+}
+
+GetRouteBatchReq* GetRouteBatchReq::default_instance_ = NULL;
+
+GetRouteBatchReq* GetRouteBatchReq::New() const {
+  return new GetRouteBatchReq;
+}
+
+void GetRouteBatchReq::Clear() {
+  reqs_.Clear();
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  mutable_unknown_fields()->Clear();
+}
+
+bool GetRouteBatchReq::MergePartialFromCodedStream(
+    ::google::protobuf::io::CodedInputStream* input) {
+#define DO_(EXPRESSION) if (!(EXPRESSION)) goto failure
+  ::google::protobuf::uint32 tag;
+  // @@protoc_insertion_point(parse_start:elb.GetRouteBatchReq)
+  for (;;) {
+    ::std::pair< ::google::protobuf::uint32, bool> p = input->ReadTagWithCutoff(127);
+    tag = p.first;
+    if (!p.second) goto handle_unusual;
+    switch (::google::protobuf::internal::WireFormatLite::GetTagFieldNumber(tag)) {
+      // repeated .elb.GetRouteReq reqs = 1;
+      case 1: {
+        if (tag == 10) {
+         parse_reqs:
+          DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
+                input, add_reqs()));
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(10)) goto parse_reqs;
+        if (input->ExpectAtEnd()) goto success;
+        break;
+      }
+
+      default: {
+      handle_unusual:
+        if (tag == 0 ||
+            ::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_END_GROUP) {
+          goto success;
+        }
+        DO_(::google::protobuf::internal::WireFormat::SkipField(
+              input, tag, mutable_unknown_fields()));
+        break;
+      }
+    }
+  }
+success:
+  // @@protoc_insertion_point(parse_success:elb.GetRouteBatchReq)
+  return true;
+failure:
+  // @@protoc_insertion_point(parse_failure:elb.GetRouteBatchReq)
+  return false;
+#undef DO_
+}
+
+void GetRouteBatchReq::SerializeWithCachedSizes(
+    ::google::protobuf::io::CodedOutputStream* output) const {
+  // @@protoc_insertion_point(serialize_start:elb.GetRouteBatchReq)
+  // repeated .elb.GetRouteReq reqs = 1;
+  for (int i = 0; i < this->reqs_size(); i++) {
+    ::google::protobuf::internal::WireFormatLite::WriteMessageMaybeToArray(
+      1, this->reqs(i), output);
+  }
+
+  if (!unknown_fields().empty()) {
+    ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
+        unknown_fields(), output);
+  }
+  // @@protoc_insertion_point(serialize_end:elb.GetRouteBatchReq)
+}
+
+::google::protobuf::uint8* GetRouteBatchReq::SerializeWithCachedSizesToArray(
+    ::google::protobuf::uint8* target) const {
+  // @@protoc_insertion_point(serialize_to_array_start:elb.GetRouteBatchReq)
+  // repeated .elb.GetRouteReq reqs = 1;
+  for (int i = 0; i < this->reqs_size(); i++) {
+    target = ::google::protobuf::internal::WireFormatLite::
+      WriteMessageNoVirtualToArray(
+        1, this->reqs(i), target);
+  }
+
+  if (!unknown_fields().empty()) {
+    target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
+        unknown_fields(), target);
+  }
+  // @@protoc_insertion_point(serialize_to_array_end:elb.GetRouteBatchReq)
+  return target;
+}
+
+int GetRouteBatchReq::ByteSize() const {
+  int total_size = 0;
+
+  // repeated .elb.GetRouteReq reqs = 1;
+  total_size += 1 * this->reqs_size();
+  for (int i = 0; i < this->reqs_size(); i++) {
+    total_size +=
+      ::google::protobuf::internal::WireFormatLite::MessageSizeNoVirtual(
+        this->reqs(i));
+  }
+
+  if (!unknown_fields().empty()) {
+    total_size +=
+      ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
+        unknown_fields());
+  }
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = total_size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+  return total_size;
+}
+
+void GetRouteBatchReq::MergeFrom(const ::google::protobuf::Message& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  const GetRouteBatchReq* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const GetRouteBatchReq*>(
+      &from);
+  if (source == NULL) {
+    ::google::protobuf::internal::ReflectionOps::Merge(from, this);
+  } else {
+    MergeFrom(*source);
+  }
+}
+
+void GetRouteBatchReq::MergeFrom(const GetRouteBatchReq& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  reqs_.MergeFrom(from.reqs_);
+  mutable_unknown_fields()->MergeFrom(from.unknown_fields());
+}
+
+void GetRouteBatchReq::CopyFrom(const ::google::protobuf::Message& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+void GetRouteBatchReq::CopyFrom(const GetRouteBatchReq& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool GetRouteBatchReq::IsInitialized() const {
+
+  if (!::google::protobuf::internal::AllAreInitialized(this->reqs())) return false;
+  return true;
+}
+
+void GetRouteBatchReq::Swap(GetRouteBatchReq* other) {
+  if (other != this) {
+    reqs_.Swap(&other->reqs_);
+    std::swap(_has_bits_[0], other->_has_bits_[0]);
+    _unknown_fields_.Swap(&other->_unknown_fields_);
+    std::swap(_cached_size_, other->_cached_size_);
+  }
+}
+
+::google::protobuf::Metadata GetRouteBatchReq::GetMetadata() const {
+  protobuf_AssignDescriptorsOnce();
+  ::google::protobuf::Metadata metadata;
+  metadata.descriptor = GetRouteBatchReq_descriptor_;
+  metadata.reflection = GetRouteBatchReq_reflection_;
+  return metadata;
+}
+
+
 // @@protoc_insertion_point(namespace_scope)
 
 }  // namespace elb
@@ -44,8 +44,10 @@ class HostCallResult;
 class ReportStatusReq;
 class CacheGetRouteReq;
 class CacheGetRouteRsp;
+class CacheRouteNotify;
 class HostBatchCallRes;
 class CacheBatchRptReq;
+class GetRouteBatchReq;
 
 enum MsgTypeId {
   GetHostReqId = 1,
@@ -58,11 +60,23 @@ enum MsgTypeId {
   ReportStatusReqId = 8,
   CacheGetRouteReqId = 9,
   CacheGetRouteRspId = 10,
-  CacheBatchRptReqId = 11
+  CacheBatchRptReqId = 11,
+  WireNegoReqId = 12,
+  WireNegoRspId = 13,
+  FixGetHostReqId = 14,
+  FixGetHostRspId = 15,
+  FixReportReqId = 16,
+  GetRouteBatchByAgentReqId = 17,
+  CacheRouteNotifyId = 18,
+  AgentStatsReqId = 19,
+  AgentStatsRspId = 20,
+  ServerStatsReqId = 21,
+  ServerStatsRspId = 22,
+  FixGetHostKeyReqId = 23
 };
 bool MsgTypeId_IsValid(int value);
 const MsgTypeId MsgTypeId_MIN = GetHostReqId;
-const MsgTypeId MsgTypeId_MAX = CacheBatchRptReqId;
+const MsgTypeId MsgTypeId_MAX = FixGetHostKeyReqId;
 const int MsgTypeId_ARRAYSIZE = MsgTypeId_MAX + 1;
 
 const ::google::protobuf::EnumDescriptor* MsgTypeId_descriptor();
@@ -144,12 +158,30 @@ class HostAddr : public ::google::protobuf::Message {
   inline ::google::protobuf::int32 port() const;
   inline void set_port(::google::protobuf::int32 value);
 
+  // optional uint32 idc = 3;
+  inline bool has_idc() const;
+  inline void clear_idc();
+  static const int kIdcFieldNumber = 3;
+  inline ::google::protobuf::uint32 idc() const;
+  inline void set_idc(::google::protobuf::uint32 value);
+
+  // optional uint32 rack = 4;
+  inline bool has_rack() const;
+  inline void clear_rack();
+  static const int kRackFieldNumber = 4;
+  inline ::google::protobuf::uint32 rack() const;
+  inline void set_rack(::google::protobuf::uint32 value);
+
   // @@protoc_insertion_point(class_scope:elb.HostAddr)
  private:
   inline void set_has_ip();
   inline void clear_has_ip();
   inline void set_has_port();
   inline void clear_has_port();
+  inline void set_has_idc();
+  inline void clear_has_idc();
+  inline void set_has_rack();
+  inline void clear_has_rack();
 
   ::google::protobuf::UnknownFieldSet _unknown_fields_;
 
@@ -157,6 +189,8 @@ class HostAddr : public ::google::protobuf::Message {
   mutable int _cached_size_;
   ::google::protobuf::int32 ip_;
   ::google::protobuf::int32 port_;
+  ::google::protobuf::uint32 idc_;
+  ::google::protobuf::uint32 rack_;
   friend void  protobuf_AddDesc_elb_2eproto();
   friend void protobuf_AssignDesc_elb_2eproto();
   friend void protobuf_ShutdownFile_elb_2eproto();
@@ -240,6 +274,13 @@ class GetHostReq : public ::google::protobuf::Message {
   inline ::google::protobuf::int32 cmdid() const;
   inline void set_cmdid(::google::protobuf::int32 value);
 
+  // optional uint64 hashkey = 4;
+  inline bool has_hashkey() const;
+  inline void clear_hashkey();
+  static const int kHashkeyFieldNumber = 4;
+  inline ::google::protobuf::uint64 hashkey() const;
+  inline void set_hashkey(::google::protobuf::uint64 value);
+
   // @@protoc_insertion_point(class_scope:elb.GetHostReq)
  private:
   inline void set_has_seq();
@@ -248,6 +289,8 @@ class GetHostReq : public ::google::protobuf::Message {
   inline void clear_has_modid();
   inline void set_has_cmdid();
   inline void clear_has_cmdid();
+  inline void set_has_hashkey();
+  inline void clear_has_hashkey();
 
   ::google::protobuf::UnknownFieldSet _unknown_fields_;
 
@@ -255,6 +298,7 @@ class GetHostReq : public ::google::protobuf::Message {
   mutable int _cached_size_;
   ::google::protobuf::uint32 seq_;
   ::google::protobuf::int32 modid_;
+  ::google::protobuf::uint64 hashkey_;
   ::google::protobuf::int32 cmdid_;
   friend void  protobuf_AddDesc_elb_2eproto();
   friend void protobuf_AssignDesc_elb_2eproto();
@@ -1013,6 +1057,13 @@ class CacheGetRouteReq : public ::google::protobuf::Message {
   inline ::google::protobuf::int64 version() const;
   inline void set_version(::google::protobuf::int64 value);
 
+  // optional int32 subport = 4;
+  inline bool has_subport() const;
+  inline void clear_subport();
+  static const int kSubportFieldNumber = 4;
+  inline ::google::protobuf::int32 subport() const;
+  inline void set_subport(::google::protobuf::int32 value);
+
   // @@protoc_insertion_point(class_scope:elb.CacheGetRouteReq)
  private:
   inline void set_has_modid();
@@ -1021,6 +1072,8 @@ class CacheGetRouteReq : public ::google::protobuf::Message {
   inline void clear_has_cmdid();
   inline void set_has_version();
   inline void clear_has_version();
+  inline void set_has_subport();
+  inline void clear_has_subport();
 
   ::google::protobuf::UnknownFieldSet _unknown_fields_;
 
@@ -1029,6 +1082,7 @@ class CacheGetRouteReq : public ::google::protobuf::Message {
   ::google::protobuf::int32 modid_;
   ::google::protobuf::int32 cmdid_;
   ::google::protobuf::int64 version_;
+  ::google::protobuf::int32 subport_;
   friend void  protobuf_AddDesc_elb_2eproto();
   friend void protobuf_AssignDesc_elb_2eproto();
   friend void protobuf_ShutdownFile_elb_2eproto();
@@ -1131,6 +1185,79 @@ class CacheGetRouteRsp : public ::google::protobuf::Message {
   inline ::google::protobuf::RepeatedPtrField< ::elb::HostAddr >*
       mutable_route();
 
+  // optional bool pushed = 6;
+  inline bool has_pushed() const;
+  inline void clear_pushed();
+  static const int kPushedFieldNumber = 6;
+  inline bool pushed() const;
+  inline void set_pushed(bool value);
+
+  // repeated .elb.HostAddr downs = 7;
+  inline int downs_size() const;
+  inline void clear_downs();
+  static const int kDownsFieldNumber = 7;
+  inline const ::elb::HostAddr& downs(int index) const;
+  inline ::elb::HostAddr* mutable_downs(int index);
+  inline ::elb::HostAddr* add_downs();
+  inline const ::google::protobuf::RepeatedPtrField< ::elb::HostAddr >&
+      downs() const;
+  inline ::google::protobuf::RepeatedPtrField< ::elb::HostAddr >*
+      mutable_downs();
+
+  // optional int32 probeNum = 8;
+  inline bool has_probenum() const;
+  inline void clear_probenum();
+  static const int kProbeNumFieldNumber = 8;
+  inline ::google::protobuf::int32 probenum() const;
+  inline void set_probenum(::google::protobuf::int32 value);
+
+  // optional int32 hashpolicy = 9;
+  inline bool has_hashpolicy() const;
+  inline void clear_hashpolicy();
+  static const int kHashpolicyFieldNumber = 9;
+  inline ::google::protobuf::int32 hashpolicy() const;
+  inline void set_hashpolicy(::google::protobuf::int32 value);
+
+  // optional int32 hashparam = 10;
+  inline bool has_hashparam() const;
+  inline void clear_hashparam();
+  static const int kHashparamFieldNumber = 10;
+  inline ::google::protobuf::int32 hashparam() const;
+  inline void set_hashparam(::google::protobuf::int32 value);
+
+  // repeated int32 localities = 11;
+  inline int localities_size() const;
+  inline void clear_localities();
+  static const int kLocalitiesFieldNumber = 11;
+  inline const ::google::protobuf::int32& localities(int index) const;
+  inline ::google::protobuf::int32* mutable_localities(int index);
+  inline ::google::protobuf::int32* add_localities();
+  inline const ::google::protobuf::RepeatedPtrField< ::google::protobuf::int32 >&
+      localities() const;
+  inline ::google::protobuf::RepeatedPtrField< ::google::protobuf::int32 >*
+      mutable_localities();
+
+  // optional int32 localmin = 12;
+  inline bool has_localmin() const;
+  inline void clear_localmin();
+  static const int kLocalminFieldNumber = 12;
+  inline ::google::protobuf::int32 localmin() const;
+  inline void set_localmin(::google::protobuf::int32 value);
+
+  // optional int32 spillpct = 13;
+  inline bool has_spillpct() const;
+  inline void clear_spillpct();
+  static const int kSpillpctFieldNumber = 13;
+  inline ::google::protobuf::int32 spillpct() const;
+  inline void set_spillpct(::google::protobuf::int32 value);
+
+  // optional uint32 pushseq = 14;
+  inline bool has_pushseq() const;
+  inline void clear_pushseq();
+  static const int kPushseqFieldNumber = 14;
+  inline ::google::protobuf::uint32 pushseq() const;
+  inline void set_pushseq(::google::protobuf::uint32 value);
+
   // @@protoc_insertion_point(class_scope:elb.CacheGetRouteRsp)
  private:
   inline void set_has_modid();
@@ -1141,6 +1268,20 @@ class CacheGetRouteRsp : public ::google::protobuf::Message {
   inline void clear_has_version();
   inline void set_has_overload();
   inline void clear_has_overload();
+  inline void set_has_pushed();
+  inline void clear_has_pushed();
+  inline void set_has_probenum();
+  inline void clear_has_probenum();
+  inline void set_has_hashpolicy();
+  inline void clear_has_hashpolicy();
+  inline void set_has_hashparam();
+  inline void clear_has_hashparam();
+  inline void set_has_localmin();
+  inline void clear_has_localmin();
+  inline void set_has_spillpct();
+  inline void clear_has_spillpct();
+  inline void set_has_pushseq();
+  inline void clear_has_pushseq();
 
   ::google::protobuf::UnknownFieldSet _unknown_fields_;
 
@@ -1151,6 +1292,15 @@ class CacheGetRouteRsp : public ::google::protobuf::Message {
   ::google::protobuf::int64 version_;
   ::google::protobuf::RepeatedPtrField< ::elb::HostAddr > route_;
   bool overload_;
+  bool pushed_;
+  ::google::protobuf::int32 probenum_;
+  ::google::protobuf::RepeatedPtrField< ::elb::HostAddr > downs_;
+  ::google::protobuf::int32 hashpolicy_;
+  ::google::protobuf::int32 hashparam_;
+  ::google::protobuf::RepeatedPtrField< ::google::protobuf::int32 > localities_;
+  ::google::protobuf::int32 localmin_;
+  ::google::protobuf::int32 spillpct_;
+  ::google::protobuf::uint32 pushseq_;
   friend void  protobuf_AddDesc_elb_2eproto();
   friend void protobuf_AssignDesc_elb_2eproto();
   friend void protobuf_ShutdownFile_elb_2eproto();
@@ -1160,6 +1310,148 @@ class CacheGetRouteRsp : public ::google::protobuf::Message {
 };
 // -------------------------------------------------------------------
 
+class CacheRouteNotify : public ::google::protobuf::Message {
+ public:
+  CacheRouteNotify();
+  virtual ~CacheRouteNotify();
+
+  CacheRouteNotify(const CacheRouteNotify& from);
+
+  inline CacheRouteNotify& operator=(const CacheRouteNotify& from) {
+    CopyFrom(from);
+    return *this;
+  }
+
+  inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
+    return _unknown_fields_;
+  }
+
+  inline ::google::protobuf::UnknownFieldSet* mutable_unknown_fields() {
+    return &_unknown_fields_;
+  }
+
+  static const ::google::protobuf::Descriptor* descriptor();
+  static const CacheRouteNotify& default_instance();
+
+  void Swap(CacheRouteNotify* other);
+
+  // implements Message ----------------------------------------------
+
+  CacheRouteNotify* New() const;
+  void CopyFrom(const ::google::protobuf::Message& from);
+  void MergeFrom(const ::google::protobuf::Message& from);
+  void CopyFrom(const CacheRouteNotify& from);
+  void MergeFrom(const CacheRouteNotify& from);
+  void Clear();
+  bool IsInitialized() const;
+
+  int ByteSize() const;
+  bool MergePartialFromCodedStream(
+      ::google::protobuf::io::CodedInputStream* input);
+  void SerializeWithCachedSizes(
+      ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
+  int GetCachedSize() const { return _cached_size_; }
+  private:
+  void SharedCtor();
+  void SharedDtor();
+  void SetCachedSize(int size) const;
+  public:
+  ::google::protobuf::Metadata GetMetadata() const;
+
+  // nested types ----------------------------------------------------
+
+  // accessors -------------------------------------------------------
+
+  // required int32 modid = 1;
+  inline bool has_modid() const;
+  inline void clear_modid();
+  static const int kModidFieldNumber = 1;
+  inline ::google::protobuf::int32 modid() const;
+  inline void set_modid(::google::protobuf::int32 value);
+
+  // required int32 cmdid = 2;
+  inline bool has_cmdid() const;
+  inline void clear_cmdid();
+  static const int kCmdidFieldNumber = 2;
+  inline ::google::protobuf::int32 cmdid() const;
+  inline void set_cmdid(::google::protobuf::int32 value);
+
+  // required int64 version = 3;
+  inline bool has_version() const;
+  inline void clear_version();
+  static const int kVersionFieldNumber = 3;
+  inline ::google::protobuf::int64 version() const;
+  inline void set_version(::google::protobuf::int64 value);
+
+  // optional bool overload = 4;
+  inline bool has_overload() const;
+  inline void clear_overload();
+  static const int kOverloadFieldNumber = 4;
+  inline bool overload() const;
+  inline void set_overload(bool value);
+
+  // repeated .elb.HostAddr downs = 5;
+  inline int downs_size() const;
+  inline void clear_downs();
+  static const int kDownsFieldNumber = 5;
+  inline const ::elb::HostAddr& downs(int index) const;
+  inline ::elb::HostAddr* mutable_downs(int index);
+  inline ::elb::HostAddr* add_downs();
+  inline const ::google::protobuf::RepeatedPtrField< ::elb::HostAddr >&
+      downs() const;
+  inline ::google::protobuf::RepeatedPtrField< ::elb::HostAddr >*
+      mutable_downs();
+
+  // optional int32 probeNum = 6;
+  inline bool has_probenum() const;
+  inline void clear_probenum();
+  static const int kProbeNumFieldNumber = 6;
+  inline ::google::protobuf::int32 probenum() const;
+  inline void set_probenum(::google::protobuf::int32 value);
+
+  // optional uint32 pushseq = 7;
+  inline bool has_pushseq() const;
+  inline void clear_pushseq();
+  static const int kPushseqFieldNumber = 7;
+  inline ::google::protobuf::uint32 pushseq() const;
+  inline void set_pushseq(::google::protobuf::uint32 value);
+
+  // @@protoc_insertion_point(class_scope:elb.CacheRouteNotify)
+ private:
+  inline void set_has_modid();
+  inline void clear_has_modid();
+  inline void set_has_cmdid();
+  inline void clear_has_cmdid();
+  inline void set_has_version();
+  inline void clear_has_version();
+  inline void set_has_overload();
+  inline void clear_has_overload();
+  inline void set_has_probenum();
+  inline void clear_has_probenum();
+  inline void set_has_pushseq();
+  inline void clear_has_pushseq();
+
+  ::google::protobuf::UnknownFieldSet _unknown_fields_;
+
+  ::google::protobuf::uint32 _has_bits_[1];
+  mutable int _cached_size_;
+  ::google::protobuf::int32 modid_;
+  ::google::protobuf::int32 cmdid_;
+  ::google::protobuf::int64 version_;
+  ::google::protobuf::RepeatedPtrField< ::elb::HostAddr > downs_;
+  bool overload_;
+  ::google::protobuf::int32 probenum_;
+  ::google::protobuf::uint32 pushseq_;
+  friend void  protobuf_AddDesc_elb_2eproto();
+  friend void protobuf_AssignDesc_elb_2eproto();
+  friend void protobuf_ShutdownFile_elb_2eproto();
+
+  void InitAsDefaultInstance();
+  static CacheRouteNotify* default_instance_;
+};
+// -------------------------------------------------------------------
+
 class HostBatchCallRes : public ::google::protobuf::Message {
  public:
   HostBatchCallRes();
@@ -1234,6 +1526,20 @@ class HostBatchCallRes : public ::google::protobuf::Message {
   inline ::google::protobuf::uint32 succcnt() const;
   inline void set_succcnt(::google::protobuf::uint32 value);
 
+  // optional uint64 costSum = 4;
+  inline bool has_costsum() const;
+  inline void clear_costsum();
+  static const int kCostSumFieldNumber = 4;
+  inline ::google::protobuf::uint64 costsum() const;
+  inline void set_costsum(::google::protobuf::uint64 value);
+
+  // optional uint32 costCnt = 5;
+  inline bool has_costcnt() const;
+  inline void clear_costcnt();
+  static const int kCostCntFieldNumber = 5;
+  inline ::google::protobuf::uint32 costcnt() const;
+  inline void set_costcnt(::google::protobuf::uint32 value);
+
   // @@protoc_insertion_point(class_scope:elb.HostBatchCallRes)
  private:
   inline void set_has_ip();
@@ -1242,6 +1548,10 @@ class HostBatchCallRes : public ::google::protobuf::Message {
   inline void clear_has_port();
   inline void set_has_succcnt();
   inline void clear_has_succcnt();
+  inline void set_has_costsum();
+  inline void clear_has_costsum();
+  inline void set_has_costcnt();
+  inline void clear_has_costcnt();
 
   ::google::protobuf::UnknownFieldSet _unknown_fields_;
 
@@ -1249,7 +1559,9 @@ class HostBatchCallRes : public ::google::protobuf::Message {
   mutable int _cached_size_;
   ::google::protobuf::int32 ip_;
   ::google::protobuf::int32 port_;
+  ::google::protobuf::uint64 costsum_;
   ::google::protobuf::uint32 succcnt_;
+  ::google::protobuf::uint32 costcnt_;
   friend void  protobuf_AddDesc_elb_2eproto();
   friend void protobuf_AssignDesc_elb_2eproto();
   friend void protobuf_ShutdownFile_elb_2eproto();
@@ -1359,6 +1671,88 @@ class CacheBatchRptReq : public ::google::protobuf::Message {
   void InitAsDefaultInstance();
   static CacheBatchRptReq* default_instance_;
 };
+// -------------------------------------------------------------------
+
+class GetRouteBatchReq : public ::google::protobuf::Message {
+ public:
+  GetRouteBatchReq();
+  virtual ~GetRouteBatchReq();
+
+  GetRouteBatchReq(const GetRouteBatchReq& from);
+
+  inline GetRouteBatchReq& operator=(const GetRouteBatchReq& from) {
+    CopyFrom(from);
+    return *this;
+  }
+
+  inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
+    return _unknown_fields_;
+  }
+
+  inline ::google::protobuf::UnknownFieldSet* mutable_unknown_fields() {
+    return &_unknown_fields_;
+  }
+
+  static const ::google::protobuf::Descriptor* descriptor();
+  static const GetRouteBatchReq& default_instance();
+
+  void Swap(GetRouteBatchReq* other);
+
+  // implements Message ----------------------------------------------
+
+  GetRouteBatchReq* New() const;
+  void CopyFrom(const ::google::protobuf::Message& from);
+  void MergeFrom(const ::google::protobuf::Message& from);
+  void CopyFrom(const GetRouteBatchReq& from);
+  void MergeFrom(const GetRouteBatchReq& from);
+  void Clear();
+  bool IsInitialized() const;
+
+  int ByteSize() const;
+  bool MergePartialFromCodedStream(
+      ::google::protobuf::io::CodedInputStream* input);
+  void SerializeWithCachedSizes(
+      ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
+  int GetCachedSize() const { return _cached_size_; }
+  private:
+  void SharedCtor();
+  void SharedDtor();
+  void SetCachedSize(int size) const;
+  public:
+  ::google::protobuf::Metadata GetMetadata() const;
+
+  // nested types ----------------------------------------------------
+
+  // accessors -------------------------------------------------------
+
+  // repeated .elb.GetRouteReq reqs = 1;
+  inline int reqs_size() const;
+  inline void clear_reqs();
+  static const int kReqsFieldNumber = 1;
+  inline const ::elb::GetRouteReq& reqs(int index) const;
+  inline ::elb::GetRouteReq* mutable_reqs(int index);
+  inline ::elb::GetRouteReq* add_reqs();
+  inline const ::google::protobuf::RepeatedPtrField< ::elb::GetRouteReq >&
+      reqs() const;
+  inline ::google::protobuf::RepeatedPtrField< ::elb::GetRouteReq >*
+      mutable_reqs();
+
+  // @@protoc_insertion_point(class_scope:elb.GetRouteBatchReq)
+ private:
+
+  ::google::protobuf::UnknownFieldSet _unknown_fields_;
+
+  ::google::protobuf::uint32 _has_bits_[1];
+  mutable int _cached_size_;
+  ::google::protobuf::RepeatedPtrField< ::elb::GetRouteReq > reqs_;
+  friend void  protobuf_AddDesc_elb_2eproto();
+  friend void protobuf_AssignDesc_elb_2eproto();
+  friend void protobuf_ShutdownFile_elb_2eproto();
+
+  void InitAsDefaultInstance();
+  static GetRouteBatchReq* default_instance_;
+};
 // ===================================================================
 
 
@@ -1414,6 +1808,54 @@ inline void HostAddr::set_port(::google::protobuf::int32 value) {
   // @@protoc_insertion_point(field_set:elb.HostAddr.port)
 }
 
+// optional uint32 idc = 3;
+inline bool HostAddr::has_idc() const {
+  return (_has_bits_[0] & 0x00000004u) != 0;
+}
+inline void HostAddr::set_has_idc() {
+  _has_bits_[0] |= 0x00000004u;
+}
+inline void HostAddr::clear_has_idc() {
+  _has_bits_[0] &= ~0x00000004u;
+}
+inline void HostAddr::clear_idc() {
+  idc_ = 0u;
+  clear_has_idc();
+}
+inline ::google::protobuf::uint32 HostAddr::idc() const {
+  // @@protoc_insertion_point(field_get:elb.HostAddr.idc)
+  return idc_;
+}
+inline void HostAddr::set_idc(::google::protobuf::uint32 value) {
+  set_has_idc();
+  idc_ = value;
+  // @@protoc_insertion_point(field_set:elb.HostAddr.idc)
+}
+
+// optional uint32 rack = 4;
+inline bool HostAddr::has_rack() const {
+  return (_has_bits_[0] & 0x00000008u) != 0;
+}
+inline void HostAddr::set_has_rack() {
+  _has_bits_[0] |= 0x00000008u;
+}
+inline void HostAddr::clear_has_rack() {
+  _has_bits_[0] &= ~0x00000008u;
+}
+inline void HostAddr::clear_rack() {
+  rack_ = 0u;
+  clear_has_rack();
+}
+inline ::google::protobuf::uint32 HostAddr::rack() const {
+  // @@protoc_insertion_point(field_get:elb.HostAddr.rack)
+  return rack_;
+}
+inline void HostAddr::set_rack(::google::protobuf::uint32 value) {
+  set_has_rack();
+  rack_ = value;
+  // @@protoc_insertion_point(field_set:elb.HostAddr.rack)
+}
+
 // -------------------------------------------------------------------
 
 // GetHostReq
@@ -1490,6 +1932,30 @@ inline void GetHostReq::set_cmdid(::google::protobuf::int32 value) {
   // @@protoc_insertion_point(field_set:elb.GetHostReq.cmdid)
 }
 
+// optional uint64 hashkey = 4;
+inline bool GetHostReq::has_hashkey() const {
+  return (_has_bits_[0] & 0x00000008u) != 0;
+}
+inline void GetHostReq::set_has_hashkey() {
+  _has_bits_[0] |= 0x00000008u;
+}
+inline void GetHostReq::clear_has_hashkey() {
+  _has_bits_[0] &= ~0x00000008u;
+}
+inline void GetHostReq::clear_hashkey() {
+  hashkey_ = GOOGLE_ULONGLONG(0);
+  clear_has_hashkey();
+}
+inline ::google::protobuf::uint64 GetHostReq::hashkey() const {
+  // @@protoc_insertion_point(field_get:elb.GetHostReq.hashkey)
+  return hashkey_;
+}
+inline void GetHostReq::set_hashkey(::google::protobuf::uint64 value) {
+  set_has_hashkey();
+  hashkey_ = value;
+  // @@protoc_insertion_point(field_set:elb.GetHostReq.hashkey)
+}
+
 // -------------------------------------------------------------------
 
 // GetHostRsp
@@ -2236,6 +2702,30 @@ inline void CacheGetRouteReq::set_version(::google::protobuf::int64 value) {
   // @@protoc_insertion_point(field_set:elb.CacheGetRouteReq.version)
 }
 
+// optional int32 subport = 4;
+inline bool CacheGetRouteReq::has_subport() const {
+  return (_has_bits_[0] & 0x00000008u) != 0;
+}
+inline void CacheGetRouteReq::set_has_subport() {
+  _has_bits_[0] |= 0x00000008u;
+}
+inline void CacheGetRouteReq::clear_has_subport() {
+  _has_bits_[0] &= ~0x00000008u;
+}
+inline void CacheGetRouteReq::clear_subport() {
+  subport_ = 0;
+  clear_has_subport();
+}
+inline ::google::protobuf::int32 CacheGetRouteReq::subport() const {
+  // @@protoc_insertion_point(field_get:elb.CacheGetRouteReq.subport)
+  return subport_;
+}
+inline void CacheGetRouteReq::set_subport(::google::protobuf::int32 value) {
+  set_has_subport();
+  subport_ = value;
+  // @@protoc_insertion_point(field_set:elb.CacheGetRouteReq.subport)
+}
+
 // -------------------------------------------------------------------
 
 // CacheGetRouteRsp
@@ -2366,6 +2856,412 @@ CacheGetRouteRsp::mutable_route() {
   return &route_;
 }
 
+// optional bool pushed = 6;
+inline bool CacheGetRouteRsp::has_pushed() const {
+  return (_has_bits_[0] & 0x00000020u) != 0;
+}
+inline void CacheGetRouteRsp::set_has_pushed() {
+  _has_bits_[0] |= 0x00000020u;
+}
+inline void CacheGetRouteRsp::clear_has_pushed() {
+  _has_bits_[0] &= ~0x00000020u;
+}
+inline void CacheGetRouteRsp::clear_pushed() {
+  pushed_ = false;
+  clear_has_pushed();
+}
+inline bool CacheGetRouteRsp::pushed() const {
+  // @@protoc_insertion_point(field_get:elb.CacheGetRouteRsp.pushed)
+  return pushed_;
+}
+inline void CacheGetRouteRsp::set_pushed(bool value) {
+  set_has_pushed();
+  pushed_ = value;
+  // @@protoc_insertion_point(field_set:elb.CacheGetRouteRsp.pushed)
+}
+
+// repeated .elb.HostAddr downs = 7;
+inline int CacheGetRouteRsp::downs_size() const {
+  return downs_.size();
+}
+inline void CacheGetRouteRsp::clear_downs() {
+  downs_.Clear();
+}
+inline const ::elb::HostAddr& CacheGetRouteRsp::downs(int index) const {
+  // @@protoc_insertion_point(field_get:elb.CacheGetRouteRsp.downs)
+  return downs_.Get(index);
+}
+inline ::elb::HostAddr* CacheGetRouteRsp::mutable_downs(int index) {
+  // @@protoc_insertion_point(field_mutable:elb.CacheGetRouteRsp.downs)
+  return downs_.Mutable(index);
+}
+inline ::elb::HostAddr* CacheGetRouteRsp::add_downs() {
+  // @@protoc_insertion_point(field_add:elb.CacheGetRouteRsp.downs)
+  return downs_.Add();
+}
+inline const ::google::protobuf::RepeatedPtrField< ::elb::HostAddr >&
+CacheGetRouteRsp::downs() const {
+  // @@protoc_insertion_point(field_list:elb.CacheGetRouteRsp.downs)
+  return downs_;
+}
+inline ::google::protobuf::RepeatedPtrField< ::elb::HostAddr >*
+CacheGetRouteRsp::mutable_downs() {
+  // @@protoc_insertion_point(field_mutable_list:elb.CacheGetRouteRsp.downs)
+  return &downs_;
+}
+
+// optional int32 probeNum = 8;
+inline bool CacheGetRouteRsp::has_probenum() const {
+  return (_has_bits_[0] & 0x00000080u) != 0;
+}
+inline void CacheGetRouteRsp::set_has_probenum() {
+  _has_bits_[0] |= 0x00000080u;
+}
+inline void CacheGetRouteRsp::clear_has_probenum() {
+  _has_bits_[0] &= ~0x00000080u;
+}
+inline void CacheGetRouteRsp::clear_probenum() {
+  probenum_ = 0;
+  clear_has_probenum();
+}
+inline ::google::protobuf::int32 CacheGetRouteRsp::probenum() const {
+  // @@protoc_insertion_point(field_get:elb.CacheGetRouteRsp.probeNum)
+  return probenum_;
+}
+inline void CacheGetRouteRsp::set_probenum(::google::protobuf::int32 value) {
+  set_has_probenum();
+  probenum_ = value;
+  // @@protoc_insertion_point(field_set:elb.CacheGetRouteRsp.probeNum)
+}
+
+// optional int32 hashpolicy = 9;
+inline bool CacheGetRouteRsp::has_hashpolicy() const {
+  return (_has_bits_[0] & 0x00000100u) != 0;
+}
+inline void CacheGetRouteRsp::set_has_hashpolicy() {
+  _has_bits_[0] |= 0x00000100u;
+}
+inline void CacheGetRouteRsp::clear_has_hashpolicy() {
+  _has_bits_[0] &= ~0x00000100u;
+}
+inline void CacheGetRouteRsp::clear_hashpolicy() {
+  hashpolicy_ = 0;
+  clear_has_hashpolicy();
+}
+inline ::google::protobuf::int32 CacheGetRouteRsp::hashpolicy() const {
+  // @@protoc_insertion_point(field_get:elb.CacheGetRouteRsp.hashpolicy)
+  return hashpolicy_;
+}
+inline void CacheGetRouteRsp::set_hashpolicy(::google::protobuf::int32 value) {
+  set_has_hashpolicy();
+  hashpolicy_ = value;
+  // @@protoc_insertion_point(field_set:elb.CacheGetRouteRsp.hashpolicy)
+}
+
+// optional int32 hashparam = 10;
+inline bool CacheGetRouteRsp::has_hashparam() const {
+  return (_has_bits_[0] & 0x00000200u) != 0;
+}
+inline void CacheGetRouteRsp::set_has_hashparam() {
+  _has_bits_[0] |= 0x00000200u;
+}
+inline void CacheGetRouteRsp::clear_has_hashparam() {
+  _has_bits_[0] &= ~0x00000200u;
+}
+inline void CacheGetRouteRsp::clear_hashparam() {
+  hashparam_ = 0;
+  clear_has_hashparam();
+}
+inline ::google::protobuf::int32 CacheGetRouteRsp::hashparam() const {
+  // @@protoc_insertion_point(field_get:elb.CacheGetRouteRsp.hashparam)
+  return hashparam_;
+}
+inline void CacheGetRouteRsp::set_hashparam(::google::protobuf::int32 value) {
+  set_has_hashparam();
+  hashparam_ = value;
+  // @@protoc_insertion_point(field_set:elb.CacheGetRouteRsp.hashparam)
+}
+
+// repeated int32 localities = 11;
+inline int CacheGetRouteRsp::localities_size() const {
+  return localities_.size();
+}
+inline void CacheGetRouteRsp::clear_localities() {
+  localities_.Clear();
+}
+inline const ::google::protobuf::int32& CacheGetRouteRsp::localities(int index) const {
+  // @@protoc_insertion_point(field_get:elb.CacheGetRouteRsp.localities)
+  return localities_.Get(index);
+}
+inline ::google::protobuf::int32* CacheGetRouteRsp::mutable_localities(int index) {
+  // @@protoc_insertion_point(field_mutable:elb.CacheGetRouteRsp.localities)
+  return localities_.Mutable(index);
+}
+inline ::google::protobuf::int32* CacheGetRouteRsp::add_localities() {
+  // @@protoc_insertion_point(field_add:elb.CacheGetRouteRsp.localities)
+  return localities_.Add();
+}
+inline const ::google::protobuf::RepeatedPtrField< ::google::protobuf::int32 >&
+CacheGetRouteRsp::localities() const {
+  // @@protoc_insertion_point(field_list:elb.CacheGetRouteRsp.localities)
+  return localities_;
+}
+inline ::google::protobuf::RepeatedPtrField< ::google::protobuf::int32 >*
+CacheGetRouteRsp::mutable_localities() {
+  // @@protoc_insertion_point(field_mutable_list:elb.CacheGetRouteRsp.localities)
+  return &localities_;
+}
+
+// optional int32 localmin = 12;
+inline bool CacheGetRouteRsp::has_localmin() const {
+  return (_has_bits_[0] & 0x00000800u) != 0;
+}
+inline void CacheGetRouteRsp::set_has_localmin() {
+  _has_bits_[0] |= 0x00000800u;
+}
+inline void CacheGetRouteRsp::clear_has_localmin() {
+  _has_bits_[0] &= ~0x00000800u;
+}
+inline void CacheGetRouteRsp::clear_localmin() {
+  localmin_ = 0;
+  clear_has_localmin();
+}
+inline ::google::protobuf::int32 CacheGetRouteRsp::localmin() const {
+  // @@protoc_insertion_point(field_get:elb.CacheGetRouteRsp.localmin)
+  return localmin_;
+}
+inline void CacheGetRouteRsp::set_localmin(::google::protobuf::int32 value) {
+  set_has_localmin();
+  localmin_ = value;
+  // @@protoc_insertion_point(field_set:elb.CacheGetRouteRsp.localmin)
+}
+
+// optional int32 spillpct = 13;
+inline bool CacheGetRouteRsp::has_spillpct() const {
+  return (_has_bits_[0] & 0x00001000u) != 0;
+}
+inline void CacheGetRouteRsp::set_has_spillpct() {
+  _has_bits_[0] |= 0x00001000u;
+}
+inline void CacheGetRouteRsp::clear_has_spillpct() {
+  _has_bits_[0] &= ~0x00001000u;
+}
+inline void CacheGetRouteRsp::clear_spillpct() {
+  spillpct_ = 0;
+  clear_has_spillpct();
+}
+inline ::google::protobuf::int32 CacheGetRouteRsp::spillpct() const {
+  // @@protoc_insertion_point(field_get:elb.CacheGetRouteRsp.spillpct)
+  return spillpct_;
+}
+inline void CacheGetRouteRsp::set_spillpct(::google::protobuf::int32 value) {
+  set_has_spillpct();
+  spillpct_ = value;
+  // @@protoc_insertion_point(field_set:elb.CacheGetRouteRsp.spillpct)
+}
+
+// optional uint32 pushseq = 14;
+inline bool CacheGetRouteRsp::has_pushseq() const {
+  return (_has_bits_[0] & 0x00002000u) != 0;
+}
+inline void CacheGetRouteRsp::set_has_pushseq() {
+  _has_bits_[0] |= 0x00002000u;
+}
+inline void CacheGetRouteRsp::clear_has_pushseq() {
+  _has_bits_[0] &= ~0x00002000u;
+}
+inline void CacheGetRouteRsp::clear_pushseq() {
+  pushseq_ = 0u;
+  clear_has_pushseq();
+}
+inline ::google::protobuf::uint32 CacheGetRouteRsp::pushseq() const {
+  // @@protoc_insertion_point(field_get:elb.CacheGetRouteRsp.pushseq)
+  return pushseq_;
+}
+inline void CacheGetRouteRsp::set_pushseq(::google::protobuf::uint32 value) {
+  set_has_pushseq();
+  pushseq_ = value;
+  // @@protoc_insertion_point(field_set:elb.CacheGetRouteRsp.pushseq)
+}
+
+// -------------------------------------------------------------------
+
+// CacheRouteNotify
+
+// required int32 modid = 1;
+inline bool CacheRouteNotify::has_modid() const {
+  return (_has_bits_[0] & 0x00000001u) != 0;
+}
+inline void CacheRouteNotify::set_has_modid() {
+  _has_bits_[0] |= 0x00000001u;
+}
+inline void CacheRouteNotify::clear_has_modid() {
+  _has_bits_[0] &= ~0x00000001u;
+}
+inline void CacheRouteNotify::clear_modid() {
+  modid_ = 0;
+  clear_has_modid();
+}
+inline ::google::protobuf::int32 CacheRouteNotify::modid() const {
+  // @@protoc_insertion_point(field_get:elb.CacheRouteNotify.modid)
+  return modid_;
+}
+inline void CacheRouteNotify::set_modid(::google::protobuf::int32 value) {
+  set_has_modid();
+  modid_ = value;
+  // @@protoc_insertion_point(field_set:elb.CacheRouteNotify.modid)
+}
+
+// required int32 cmdid = 2;
+inline bool CacheRouteNotify::has_cmdid() const {
+  return (_has_bits_[0] & 0x00000002u) != 0;
+}
+inline void CacheRouteNotify::set_has_cmdid() {
+  _has_bits_[0] |= 0x00000002u;
+}
+inline void CacheRouteNotify::clear_has_cmdid() {
+  _has_bits_[0] &= ~0x00000002u;
+}
+inline void CacheRouteNotify::clear_cmdid() {
+  cmdid_ = 0;
+  clear_has_cmdid();
+}
+inline ::google::protobuf::int32 CacheRouteNotify::cmdid() const {
+  // @@protoc_insertion_point(field_get:elb.CacheRouteNotify.cmdid)
+  return cmdid_;
+}
+inline void CacheRouteNotify::set_cmdid(::google::protobuf::int32 value) {
+  set_has_cmdid();
+  cmdid_ = value;
+  // @@protoc_insertion_point(field_set:elb.CacheRouteNotify.cmdid)
+}
+
+// required int64 version = 3;
+inline bool CacheRouteNotify::has_version() const {
+  return (_has_bits_[0] & 0x00000004u) != 0;
+}
+inline void CacheRouteNotify::set_has_version() {
+  _has_bits_[0] |= 0x00000004u;
+}
+inline void CacheRouteNotify::clear_has_version() {
+  _has_bits_[0] &= ~0x00000004u;
+}
+inline void CacheRouteNotify::clear_version() {
+  version_ = GOOGLE_LONGLONG(0);
+  clear_has_version();
+}
+inline ::google::protobuf::int64 CacheRouteNotify::version() const {
+  // @@protoc_insertion_point(field_get:elb.CacheRouteNotify.version)
+  return version_;
+}
+inline void CacheRouteNotify::set_version(::google::protobuf::int64 value) {
+  set_has_version();
+  version_ = value;
+  // @@protoc_insertion_point(field_set:elb.CacheRouteNotify.version)
+}
+
+// optional bool overload = 4;
+inline bool CacheRouteNotify::has_overload() const {
+  return (_has_bits_[0] & 0x00000008u) != 0;
+}
+inline void CacheRouteNotify::set_has_overload() {
+  _has_bits_[0] |= 0x00000008u;
+}
+inline void CacheRouteNotify::clear_has_overload() {
+  _has_bits_[0] &= ~0x00000008u;
+}
+inline void CacheRouteNotify::clear_overload() {
+  overload_ = false;
+  clear_has_overload();
+}
+inline bool CacheRouteNotify::overload() const {
+  // @@protoc_insertion_point(field_get:elb.CacheRouteNotify.overload)
+  return overload_;
+}
+inline void CacheRouteNotify::set_overload(bool value) {
+  set_has_overload();
+  overload_ = value;
+  // @@protoc_insertion_point(field_set:elb.CacheRouteNotify.overload)
+}
+
+// repeated .elb.HostAddr downs = 5;
+inline int CacheRouteNotify::downs_size() const {
+  return downs_.size();
+}
+inline void CacheRouteNotify::clear_downs() {
+  downs_.Clear();
+}
+inline const ::elb::HostAddr& CacheRouteNotify::downs(int index) const {
+  // @@protoc_insertion_point(field_get:elb.CacheRouteNotify.downs)
+  return downs_.Get(index);
+}
+inline ::elb::HostAddr* CacheRouteNotify::mutable_downs(int index) {
+  // @@protoc_insertion_point(field_mutable:elb.CacheRouteNotify.downs)
+  return downs_.Mutable(index);
+}
+inline ::elb::HostAddr* CacheRouteNotify::add_downs() {
+  // @@protoc_insertion_point(field_add:elb.CacheRouteNotify.downs)
+  return downs_.Add();
+}
+inline const ::google::protobuf::RepeatedPtrField< ::elb::HostAddr >&
+CacheRouteNotify::downs() const {
+  // @@protoc_insertion_point(field_list:elb.CacheRouteNotify.downs)
+  return downs_;
+}
+inline ::google::protobuf::RepeatedPtrField< ::elb::HostAddr >*
+CacheRouteNotify::mutable_downs() {
+  // @@protoc_insertion_point(field_mutable_list:elb.CacheRouteNotify.downs)
+  return &downs_;
+}
+
+// optional int32 probeNum = 6;
+inline bool CacheRouteNotify::has_probenum() const {
+  return (_has_bits_[0] & 0x00000020u) != 0;
+}
+inline void CacheRouteNotify::set_has_probenum() {
+  _has_bits_[0] |= 0x00000020u;
+}
+inline void CacheRouteNotify::clear_has_probenum() {
+  _has_bits_[0] &= ~0x00000020u;
+}
+inline void CacheRouteNotify::clear_probenum() {
+  probenum_ = 0;
+  clear_has_probenum();
+}
+inline ::google::protobuf::int32 CacheRouteNotify::probenum() const {
+  // @@protoc_insertion_point(field_get:elb.CacheRouteNotify.probeNum)
+  return probenum_;
+}
+inline void CacheRouteNotify::set_probenum(::google::protobuf::int32 value) {
+  set_has_probenum();
+  probenum_ = value;
+  // @@protoc_insertion_point(field_set:elb.CacheRouteNotify.probeNum)
+}
+
+// optional uint32 pushseq = 7;
+inline bool CacheRouteNotify::has_pushseq() const {
+  return (_has_bits_[0] & 0x00000040u) != 0;
+}
+inline void CacheRouteNotify::set_has_pushseq() {
+  _has_bits_[0] |= 0x00000040u;
+}
+inline void CacheRouteNotify::clear_has_pushseq() {
+  _has_bits_[0] &= ~0x00000040u;
+}
+inline void CacheRouteNotify::clear_pushseq() {
+  pushseq_ = 0u;
+  clear_has_pushseq();
+}
+inline ::google::protobuf::uint32 CacheRouteNotify::pushseq() const {
+  // @@protoc_insertion_point(field_get:elb.CacheRouteNotify.pushseq)
+  return pushseq_;
+}
+inline void CacheRouteNotify::set_pushseq(::google::protobuf::uint32 value) {
+  set_has_pushseq();
+  pushseq_ = value;
+  // @@protoc_insertion_point(field_set:elb.CacheRouteNotify.pushseq)
+}
+
 // -------------------------------------------------------------------
 
 // HostBatchCallRes
@@ -2442,6 +3338,54 @@ inline void HostBatchCallRes::set_succcnt(::google::protobuf::uint32 value) {
   // @@protoc_insertion_point(field_set:elb.HostBatchCallRes.succCnt)
 }
 
+// optional uint64 costSum = 4;
+inline bool HostBatchCallRes::has_costsum() const {
+  return (_has_bits_[0] & 0x00000008u) != 0;
+}
+inline void HostBatchCallRes::set_has_costsum() {
+  _has_bits_[0] |= 0x00000008u;
+}
+inline void HostBatchCallRes::clear_has_costsum() {
+  _has_bits_[0] &= ~0x00000008u;
+}
+inline void HostBatchCallRes::clear_costsum() {
+  costsum_ = GOOGLE_ULONGLONG(0);
+  clear_has_costsum();
+}
+inline ::google::protobuf::uint64 HostBatchCallRes::costsum() const {
+  // @@protoc_insertion_point(field_get:elb.HostBatchCallRes.costSum)
+  return costsum_;
+}
+inline void HostBatchCallRes::set_costsum(::google::protobuf::uint64 value) {
+  set_has_costsum();
+  costsum_ = value;
+  // @@protoc_insertion_point(field_set:elb.HostBatchCallRes.costSum)
+}
+
+// optional uint32 costCnt = 5;
+inline bool HostBatchCallRes::has_costcnt() const {
+  return (_has_bits_[0] & 0x00000010u) != 0;
+}
+inline void HostBatchCallRes::set_has_costcnt() {
+  _has_bits_[0] |= 0x00000010u;
+}
+inline void HostBatchCallRes::clear_has_costcnt() {
+  _has_bits_[0] &= ~0x00000010u;
+}
+inline void HostBatchCallRes::clear_costcnt() {
+  costcnt_ = 0u;
+  clear_has_costcnt();
+}
+inline ::google::protobuf::uint32 HostBatchCallRes::costcnt() const {
+  // @@protoc_insertion_point(field_get:elb.HostBatchCallRes.costCnt)
+  return costcnt_;
+}
+inline void HostBatchCallRes::set_costcnt(::google::protobuf::uint32 value) {
+  set_has_costcnt();
+  costcnt_ = value;
+  // @@protoc_insertion_point(field_set:elb.HostBatchCallRes.costCnt)
+}
+
 // -------------------------------------------------------------------
 
 // CacheBatchRptReq
@@ -2524,6 +3468,40 @@ CacheBatchRptReq::mutable_results() {
   return &results_;
 }
 
+// -------------------------------------------------------------------
+
+// GetRouteBatchReq
+
+// repeated .elb.GetRouteReq reqs = 1;
+inline int GetRouteBatchReq::reqs_size() const {
+  return reqs_.size();
+}
+inline void GetRouteBatchReq::clear_reqs() {
+  reqs_.Clear();
+}
+inline const ::elb::GetRouteReq& GetRouteBatchReq::reqs(int index) const {
+  // @@protoc_insertion_point(field_get:elb.GetRouteBatchReq.reqs)
+  return reqs_.Get(index);
+}
+inline ::elb::GetRouteReq* GetRouteBatchReq::mutable_reqs(int index) {
+  // @@protoc_insertion_point(field_mutable:elb.GetRouteBatchReq.reqs)
+  return reqs_.Mutable(index);
+}
+inline ::elb::GetRouteReq* GetRouteBatchReq::add_reqs() {
+  // @@protoc_insertion_point(field_add:elb.GetRouteBatchReq.reqs)
+  return reqs_.Add();
+}
+inline const ::google::protobuf::RepeatedPtrField< ::elb::GetRouteReq >&
+GetRouteBatchReq::reqs() const {
+  // @@protoc_insertion_point(field_list:elb.GetRouteBatchReq.reqs)
+  return reqs_;
+}
+inline ::google::protobuf::RepeatedPtrField< ::elb::GetRouteReq >*
+GetRouteBatchReq::mutable_reqs() {
+  // @@protoc_insertion_point(field_mutable_list:elb.GetRouteBatchReq.reqs)
+  return &reqs_;
+}
+
 
 // @@protoc_insertion_point(namespace_scope)
 
@@ -0,0 +1,78 @@
+#ifndef __FIXED_WIRE_H__
+#define __FIXED_WIRE_H__
+
+#include <stdint.h>
+#include <string.h>
+
+//GetHost/Report热路径消息的定长二进制编码
+//api与agent同在本机，消息体直接按主机字节序的定长结构收发（与commu_head一致），
+//省去protobuf的varint编解码与ByteSize；
+//api首次走网络前用WireNegoReqId协商版本，agent不认识或关闭了定长编码时回退到protobuf
+
+//当前定长编码版本，消息布局有任何改动都需要递增，并分配新的cmdid
+#define FIXED_WIRE_VERSION 2//2: 增加FixGetHostKeyReq
+
+//WireNegoReqId / WireNegoRspId: 请求带api支持的最高版本，应答带双方都支持的版本（0表示只用protobuf）
+struct FixWireNego
+{
+    uint32_t version;
+};
+
+//FixGetHostReqId
+struct FixGetHostReq
+{
+    uint32_t seq;
+    int32_t modid;
+    int32_t cmdid;
+};
+
+//FixGetHostKeyReqId（版本2）：按key做一致性哈希选取节点，64位key拆成两个32位字段避免结构体填充
+struct FixGetHostKeyReq
+{
+    uint32_t seq;
+    int32_t modid;
+    int32_t cmdid;
+    uint32_t keyHigh;
+    uint32_t keyLow;
+};
+
+//FixGetHostRspId: retcode != 0时ip/port无意义
+struct FixGetHostRsp
+{
+    uint32_t seq;
+    int32_t modid;
+    int32_t cmdid;
+    int32_t retcode;
+    int32_t ip;
+    int32_t port;
+};
+
+//FixReportReqId: tcost为调用耗时(ms)，未知时填0；失败时agent按耗时放大失败次数，成功时只计入耗时统计
+struct FixReportReq
+{
+    int32_t modid;
+    int32_t cmdid;
+    int32_t ip;
+    int32_t port;
+    int32_t retcode;
+    uint32_t tcost;
+};
+
+//结构体全部由4字节字段组成，不应有填充
+typedef char FixWireNegoSizeCheck[sizeof(FixWireNego) == 4 ? 1 : -1];
+typedef char FixGetHostReqSizeCheck[sizeof(FixGetHostReq) == 12 ? 1 : -1];
+typedef char FixGetHostKeyReqSizeCheck[sizeof(FixGetHostKeyReq) == 20 ? 1 : -1];
+typedef char FixGetHostRspSizeCheck[sizeof(FixGetHostRsp) == 24 ? 1 : -1];
+typedef char FixReportReqSizeCheck[sizeof(FixReportReq) == 24 ? 1 : -1];
+
+//解码：长度必须与定长结构完全一致，否则认为是坏包
+template <typename T>
+inline bool fixedDecode(const char* data, uint32_t len, T& msg)
+{
+    if (len != sizeof(T))
+        return false;
+    ::memcpy(&msg, data, sizeof(T));
+    return true;
+}
+
+#endif
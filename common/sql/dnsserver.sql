@@ -9,6 +9,8 @@ CREATE TABLE `DnsServerRoute` (
   `cmdid` int(10) unsigned NOT NULL,
   `serverip` int(10) unsigned NOT NULL,
   `serverport` int(10) unsigned NOT NULL,
+  `idc` int(10) unsigned NOT NULL DEFAULT 0,
+  `rack` int(10) unsigned NOT NULL DEFAULT 0,
   PRIMARY KEY (`id`)
 ) ENGINE=InnoDB AUTO_INCREMENT=116064 DEFAULT CHARSET=utf8;
 
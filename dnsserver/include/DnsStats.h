@@ -0,0 +1,49 @@
+#ifndef __DNS_STATS_H__
+#define __DNS_STATS_H__
+
+#include <string>
+#include <stdint.h>
+#include "statsBase.h"
+
+//dnsserver的运行指标（见common/base/include/statsBase.h），经ServerStatsReqId消息以Prometheus文本导出
+
+#define DNS_STAT_SLOTS 64//reactor线程池的线程数上限，超出的线程共用最后一个槽
+
+//reactor各线程的指标，线程首次处理消息时领取
+struct __attribute__((aligned(64))) DnsThreadStats
+{
+    uint64_t getRoute;     //GetRouteByAgentReqId
+    uint64_t getRouteBatch;//GetRouteBatchByAgentReqId
+    uint64_t batchMods;    //批量请求中的mod个数
+    uint64_t decodeErrs;
+    StatHist reqUs;        //处理一个请求（批量请求算一个）的耗时
+    uint64_t connBuild;
+    uint64_t connClose;
+    uint64_t pushRuns;     //pushChange的执行次数
+    uint64_t pushMsgs;     //推送给agent的路由消息数
+    StatHist pushUs;       //一次pushChange的耗时
+};
+
+//数据加载线程的指标，只有该线程写
+struct __attribute__((aligned(64))) DnsLoadStats
+{
+    uint64_t reloads;
+    uint64_t reloadFails;
+    StatHist reloadUs;     //一次Route::reload的耗时：查询MySQL并建好新快照
+    uint64_t rows;         //最近一次加载的行数
+    uint64_t rowsTotal;
+    uint64_t mods;         //最近一次加载的快照中的模块数、节点数
+    uint64_t hosts;
+    uint64_t version;      //当前路由版本
+    uint64_t pushCalls;    //SubscribeList::push的调用次数
+    uint64_t pushChanges;  //其中有变更的mod个数
+    uint64_t pushQueued;   //变更扇出到订阅者的(连接, mod)个数
+};
+
+extern StatSlots<DnsThreadStats, DNS_STAT_SLOTS> dnsStats;
+extern DnsLoadStats loadStats;
+
+//导出为Prometheus文本格式；limit > 0时截断到limit字节以内
+void dumpStats(std::string& text, size_t limit = 0);
+
+#endif
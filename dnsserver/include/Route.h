@@ -17,11 +17,20 @@ typedef hash_map<uint64_t, hash_set<uint64_t> >::iterator routeMapIt;
 typedef hash_set<uint64_t> hostSet;
 typedef hash_set<uint64_t>::iterator hostSetIt;
 
+//节点的位置标签：机房、机架编号，0表示未知
+struct Locality
+{
+    uint32_t idc;
+    uint32_t rack;
+};
+//ip << 32 + port -> 位置标签，只记录有标签的节点
+typedef hash_map<uint64_t, Locality> localityMap;
+
 class Route
 {
 public:
-    //main threads call it
-    hostSet getHosts(int modid, int cmdid);
+    //main threads call it；locs不为NULL时同时取出这些节点的位置标签
+    hostSet getHosts(int modid, int cmdid, localityMap* locs = NULL);
 
     //backend thread call it
     int reload();
@@ -48,6 +57,9 @@ private:
     pthread_rwlock_t _rwlock;
     routeMap* _data;
     routeMap* _tmpData;
+    //节点的位置标签，与_data、_tmpData一同加载、交换
+    localityMap* _loc;
+    localityMap* _tmpLoc;
 
     char _sql[1000];
 };
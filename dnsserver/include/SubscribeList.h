@@ -19,6 +19,9 @@ public:
 
     void fetchPush(__gnu_cxx::hash_set<int>& subscribers,
         __gnu_cxx::hash_map<int, __gnu_cxx::hash_set<uint64_t> >& news);
+
+    //运行指标：被订阅的mod数、(连接, mod)订阅数、有待push消息的连接数
+    void stats(size_t& mods, size_t& subs, size_t& pending);
 private:
     //记录订阅信息: mod -> fds
     __gnu_cxx::hash_map<uint64_t, __gnu_cxx::hash_set<int> > bookl;
@@ -0,0 +1,87 @@
+#include <string.h>
+#include "log.h"
+#include "Route.h"
+#include "DnsStats.h"
+#include "SubscribeList.h"
+
+StatSlots<DnsThreadStats, DNS_STAT_SLOTS> dnsStats;
+DnsLoadStats loadStats;
+
+//reactor每个线程一行的计数器
+static void appendPerThread(StatText& out, const char* name, const char* help, uint64_t DnsThreadStats::*field)
+{
+    out.head(name, "counter", help);
+    for (int t = 0;t < dnsStats.used(); ++t)
+        out.line("%s{thread=\"%d\"} %lu\n", name, t, (unsigned long)statLoad(dnsStats.at(t).*field));
+}
+
+void dumpStats(std::string& text, size_t limit)
+{
+    text.clear();
+    StatText out(text);
+    int threads = dnsStats.used();
+
+    appendPerThread(out, "elb_dns_get_route_total", "GetRouteByAgent requests", &DnsThreadStats::getRoute);
+    appendPerThread(out, "elb_dns_get_route_batch_total", "GetRouteBatchByAgent requests", &DnsThreadStats::getRouteBatch);
+    appendPerThread(out, "elb_dns_batch_mods_total", "Modules asked for in batch requests", &DnsThreadStats::batchMods);
+    appendPerThread(out, "elb_dns_decode_errors_total", "Requests that failed to decode", &DnsThreadStats::decodeErrs);
+    appendPerThread(out, "elb_dns_push_runs_total", "pushChange runs", &DnsThreadStats::pushRuns);
+    appendPerThread(out, "elb_dns_push_msgs_total", "Route messages pushed to agents", &DnsThreadStats::pushMsgs);
+
+    //耗时汇总所有线程，控制导出的行数
+    StatHist reqUs, pushUs;
+    ::memset(&reqUs, 0, sizeof reqUs);
+    ::memset(&pushUs, 0, sizeof pushUs);
+    uint64_t conns = 0;
+    for (int t = 0;t < threads; ++t)
+    {
+        const DnsThreadStats& stats = dnsStats.at(t);
+        reqUs.merge(stats.reqUs);
+        pushUs.merge(stats.pushUs);
+        conns += statLoad(stats.connBuild) - statLoad(stats.connClose);
+    }
+    out.head("elb_dns_request_seconds", "histogram", "Time spent handling a route request");
+    out.hist("elb_dns_request_seconds", "", reqUs);
+    out.head("elb_dns_push_seconds", "histogram", "Time spent in one pushChange run");
+    out.hist("elb_dns_push_seconds", "", pushUs);
+    out.head("elb_dns_connections", "gauge", "Agent connections");
+    out.line("elb_dns_connections %ld\n", (long)conns);
+
+    size_t subMods = 0, subs = 0, pending = 0;
+    Singleton<SubscribeList>::ins()->stats(subMods, subs, pending);
+    out.head("elb_dns_subscribed_mods", "gauge", "Modules subscribed by at least one agent");
+    out.line("elb_dns_subscribed_mods %lu\n", (unsigned long)subMods);
+    out.head("elb_dns_subscriptions", "gauge", "(connection, module) subscriptions");
+    out.line("elb_dns_subscriptions %lu\n", (unsigned long)subs);
+    out.head("elb_dns_push_pending", "gauge", "Connections with changes waiting to be pushed");
+    out.line("elb_dns_push_pending %lu\n", (unsigned long)pending);
+
+    out.head("elb_dns_reloads_total", "counter", "Route reloads from MySQL");
+    out.line("elb_dns_reloads_total %lu\n", (unsigned long)statLoad(loadStats.reloads));
+    out.head("elb_dns_reload_failures_total", "counter", "Route reloads that failed");
+    out.line("elb_dns_reload_failures_total %lu\n", (unsigned long)statLoad(loadStats.reloadFails));
+    out.head("elb_dns_reload_seconds", "histogram", "Time spent loading the route table and building the snapshot");
+    out.hist("elb_dns_reload_seconds", "", loadStats.reloadUs);
+    out.head("elb_dns_reload_rows", "gauge", "Rows read by the last reload");
+    out.line("elb_dns_reload_rows %lu\n", (unsigned long)statLoad(loadStats.rows));
+    out.head("elb_dns_reload_rows_total", "counter", "Rows read by all reloads");
+    out.line("elb_dns_reload_rows_total %lu\n", (unsigned long)statLoad(loadStats.rowsTotal));
+    out.head("elb_dns_snapshot_mods", "gauge", "Modules in the route snapshot");
+    out.line("elb_dns_snapshot_mods %lu\n", (unsigned long)statLoad(loadStats.mods));
+    out.head("elb_dns_snapshot_hosts", "gauge", "Hosts in the route snapshot");
+    out.line("elb_dns_snapshot_hosts %lu\n", (unsigned long)statLoad(loadStats.hosts));
+    out.head("elb_dns_route_version", "gauge", "Current route version");
+    out.line("elb_dns_route_version %lu\n", (unsigned long)statLoad(loadStats.version));
+
+    out.head("elb_dns_change_pushes_total", "counter", "Route change batches handed to the subscription list");
+    out.line("elb_dns_change_pushes_total %lu\n", (unsigned long)statLoad(loadStats.pushCalls));
+    out.head("elb_dns_changed_mods_total", "counter", "Changed modules in those batches");
+    out.line("elb_dns_changed_mods_total %lu\n", (unsigned long)statLoad(loadStats.pushChanges));
+    out.head("elb_dns_push_fanout_total", "counter", "(connection, module) pushes queued for changed modules");
+    out.line("elb_dns_push_fanout_total %lu\n", (unsigned long)statLoad(loadStats.pushQueued));
+    out.head("elb_dns_log_dropped_total", "counter", "Log messages dropped because a log buffer was full");
+    out.line("elb_dns_log_dropped_total %lu\n", _log_dropped_());
+
+    if (limit)
+        out.truncate(limit);
+}
@@ -1,6 +1,7 @@
 #include "log.h"
 #include "Route.h"
 #include "config_reader.h"
+#include "DnsStats.h"
 #include "SubscribeList.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -9,7 +10,7 @@
 #include <vector>
 
 //main threads call it
-hostSet Route::getHosts(int modid, int cmdid)
+hostSet Route::getHosts(int modid, int cmdid, localityMap* locs)
 {
     hostSet hosts;
     uint64_t key = ((uint64_t)modid << 32) + cmdid;
@@ -19,22 +20,44 @@ hostSet Route::getHosts(int modid, int cmdid)
     if (it != _data->end())
     {
         hosts = it->second;
+        for (hostSetIt ht = hosts.begin();locs && !_loc->empty() && ht != hosts.end(); ++ht)
+        {
+            localityMap::iterator lt = _loc->find(*ht);
+            if (lt != _loc->end())
+                (*locs)[*ht] = lt->second;
+        }
     }
     ::pthread_rwlock_unlock(&_rwlock);
     return hosts;
 }
 
+//DnsServerRoute表的idc、rack列（第6、7列）；老表没有这两列时不记录
+static void loadLocality(MYSQL_ROW row, unsigned fields, uint64_t host, localityMap& locs)
+{
+    if (fields < 7)
+        return ;
+    Locality loc;
+    loc.idc = row[5]? strtoul(row[5], NULL, 10): 0;
+    loc.rack = row[6]? strtoul(row[6], NULL, 10): 0;
+    if (loc.idc || loc.rack)
+        locs[host] = loc;
+}
+
 //backend thread call it
 int Route::reload()
 {
+    uint64_t startUs = statNowUs();
+    statAdd(loadStats.reloads);
     mysql_ping(&_dbConn);
     _tmpData->clear();
+    _tmpLoc->clear();
     //read from DB
     snprintf(_sql, 100, "SELECT * FROM DnsServerRoute;");
     int ret = mysql_real_query(&_dbConn, _sql, strlen(_sql));
     if (ret)
     {
         log_error("Failed to find any records and caused an error: %s\n", mysql_error(&_dbConn));
+        statAdd(loadStats.reloadFails);
         return -1;
     }
 
@@ -42,6 +65,7 @@ int Route::reload()
     if (!result)
     {
         log_error("Error getting records: %s\n", mysql_error(&_dbConn));
+        statAdd(loadStats.reloadFails);
         return -1;
     }
 
@@ -60,9 +84,19 @@ int Route::reload()
         uint64_t value = ((uint64_t)ip << 32) + port;
 
         (*_tmpData)[key].insert(value);
+        loadLocality(row, mysql_num_fields(result), value, *_tmpLoc);
     }
     log_debug("load data size is %lu", _tmpData->size());
     mysql_free_result(result);
+
+    uint64_t hosts = 0;
+    for (routeMapIt it = _tmpData->begin();it != _tmpData->end(); ++it)
+        hosts += it->second.size();
+    statSet(loadStats.rows, lineNum);
+    statAdd(loadStats.rowsTotal, lineNum);
+    statSet(loadStats.mods, _tmpData->size());
+    statSet(loadStats.hosts, hosts);
+    loadStats.reloadUs.record(statNowUs() - startUs);
     return 0;
 }
 
@@ -74,6 +108,9 @@ void Route::swap()
     routeMap* t = _data;
     _data = _tmpData;
     _tmpData = t;
+    localityMap* l = _loc;
+    _loc = _tmpLoc;
+    _tmpLoc = l;
     ::pthread_rwlock_unlock(&_rwlock);
 }
 
@@ -82,6 +119,8 @@ Route::Route(): routeVersion(0)
     ::pthread_rwlock_init(&_rwlock, NULL);
     _tmpData = new routeMap();
     _data = new routeMap();
+    _tmpLoc = new localityMap();
+    _loc = new localityMap();
 
     //connection DBconn
     const char* dbHost   = config_reader::ins()->GetString("mysql", "db_host", "127.0.0.1").c_str();
@@ -139,9 +178,17 @@ Route::Route(): routeVersion(0)
         uint64_t value = ((uint64_t)ip << 32) + port;
 
         (*_data)[key].insert(value);
+        loadLocality(row, mysql_num_fields(result), value, *_loc);
     }
     log_info("init load data size is %lu", _tmpData->size());
     mysql_free_result(result);
+
+    uint64_t hosts = 0;
+    for (routeMapIt it = _data->begin();it != _data->end(); ++it)
+        hosts += it->second.size();
+    statSet(loadStats.rows, lineNum);
+    statSet(loadStats.mods, _data->size());
+    statSet(loadStats.hosts, hosts);
 }
 
 int Route::loadVersion()
@@ -175,6 +222,7 @@ int Route::loadVersion()
         return 0;
     }
     routeVersion = newVersion;
+    statSet(loadStats.version, routeVersion);
     log_info("new route version is %ld", routeVersion);
     mysql_free_result(result);
     return 1;
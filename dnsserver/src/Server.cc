@@ -8,23 +8,39 @@
 #include "Route.h"
 #include "elb.pb.h"
 #include "Server.h"
+#include "DnsStats.h"
 #include "SubscribeList.h"
 
 tcp_server* server;
 
-void getRoute(const char* data, uint32_t len, int msgid, net_commu* com, void* usr_data)
+//填入mod当前的路由及节点的位置标签
+static void fillRoute(int modid, int cmdid, elb::GetRouteRsp& rsp)
 {
-    elb::GetRouteReq req;
-    elb::GetRouteRsp rsp;
-    req.ParseFromArray(data, len);//解包，data[0:len)保证是一个完整包
+    localityMap locs;
+    hostSet hosts = Singleton<Route>::ins()->getHosts(modid, cmdid, &locs);
+
+    rsp.set_modid(modid);
+    rsp.set_cmdid(cmdid);
 
-    if (!req.ParseFromArray(data, len))
+    for (hostSetIt it = hosts.begin();it != hosts.end(); ++it)
     {
-        log_error("request decode error");
-        return ;
+        uint64_t key = *it;
+        elb::HostAddr* host = rsp.add_hosts();
+        host->set_ip((uint32_t)(key >> 32));
+        host->set_port((int)key);
+        localityMap::iterator lt = locs.find(key);
+        if (lt != locs.end())
+        {
+            host->set_idc(lt->second.idc);
+            host->set_rack(lt->second.rack);
+        }
     }
+}
 
-    int modid = req.modid(), cmdid = req.cmdid();
+//订阅mod并回复它当前的路由
+static void replyRoute(int modid, int cmdid, net_commu* com)
+{
+    elb::GetRouteRsp rsp;
 
     //如果之前没有订阅过此mod，就订阅
     uint64_t key = (((uint64_t)modid) << 32) + cmdid;
@@ -36,29 +52,70 @@ void getRoute(const char* data, uint32_t len, int msgid, net_commu* com, void* u
         Singleton<SubscribeList>::ins()->subscribe(key, com->get_fd());
     }
 
-    hostSet hosts = Singleton<Route>::ins()->getHosts(modid, cmdid);
+    fillRoute(modid, cmdid, rsp);
 
-    rsp.set_modid(modid);
-    rsp.set_cmdid(cmdid);
+    std::string rspStr;
+    rsp.SerializeToString(&rspStr);
+    com->send_data(rspStr.c_str(), rspStr.size(), elb::GetRouteByAgentRspId);//回复消息
+}
 
-    for (hostSetIt it = hosts.begin();it != hosts.end(); ++it)
+void getRoute(const char* data, uint32_t len, int msgid, net_commu* com, void* usr_data)
+{
+    elb::GetRouteReq req;
+    DnsThreadStats* stats = dnsStats.mine();
+    uint64_t startUs = statNowUs();
+
+    if (!req.ParseFromArray(data, len))//解包，data[0:len)保证是一个完整包
     {
-        uint64_t key = *it;
-        elb::HostAddr host;
-        host.set_ip((uint32_t)(key >> 32));
-        host.set_port((int)key);
-        rsp.add_hosts()->CopyFrom(host);
+        log_error("request decode error");
+        statAdd(stats->decodeErrs);
+        return ;
     }
 
-    std::string rspStr;
-    rsp.SerializeToString(&rspStr);
-    com->send_data(rspStr.c_str(), rspStr.size(), elb::GetRouteByAgentRspId);//回复消息
+    replyRoute(req.modid(), req.cmdid(), com);
+    statAdd(stats->getRoute);
+    stats->reqUs.record(statNowUs() - startUs);
+}
+
+void getRouteBatch(const char* data, uint32_t len, int msgid, net_commu* com, void* usr_data)
+{
+    elb::GetRouteBatchReq req;
+    DnsThreadStats* stats = dnsStats.mine();
+    uint64_t startUs = statNowUs();
+
+    if (!req.ParseFromArray(data, len))//解包，data[0:len)保证是一个完整包
+    {
+        log_error("batch request decode error");
+        statAdd(stats->decodeErrs);
+        return ;
+    }
+
+    //逐个mod回复，agent按普通的GetRouteByAgentRsp处理
+    for (int i = 0;i < req.reqs_size(); ++i)
+        replyRoute(req.reqs(i).modid(), req.reqs(i).cmdid(), com);
+    statAdd(stats->getRouteBatch);
+    statAdd(stats->batchMods, req.reqs_size());
+    stats->reqUs.record(statNowUs() - startUs);
+}
+
+//导出运行指标，只回复本机的连接
+void serverStats(const char* data, uint32_t len, int msgid, net_commu* com, void* usr_data)
+{
+    if (!statPeerLocal(com->get_fd()))
+    {
+        log_error("stats request from non-local peer, fd %d", com->get_fd());
+        return ;
+    }
+    std::string text;
+    dumpStats(text, MSG_LENGTH_LIMIT);
+    com->send_data(text.c_str(), text.size(), elb::ServerStatsRspId);
 }
 
 void createSubscribe(net_commu* com)
 {
     com->parameter = new Interest();
     assert(com->parameter);
+    statAdd(dnsStats.mine()->connBuild);
 }
 
 void clearSubscribe(net_commu* com)
@@ -72,6 +129,7 @@ void clearSubscribe(net_commu* com)
     }
     delete book;
     com->parameter = NULL;
+    statAdd(dnsStats.mine()->connClose);
 }
 
 void pushChange(event_loop* loop, void* args)
@@ -80,6 +138,8 @@ void pushChange(event_loop* loop, void* args)
     __gnu_cxx::hash_map<int, __gnu_cxx::hash_set<uint64_t> > news;
     __gnu_cxx::hash_map<int, __gnu_cxx::hash_set<uint64_t> >::iterator it;
     __gnu_cxx::hash_set<uint64_t>::iterator st;
+    DnsThreadStats* stats = dnsStats.mine();
+    uint64_t startUs = statNowUs(), msgs = 0;
 
     loop->nlistenings(listening);//获取当前loop所有连接
     //从订阅列表取走所有待push消息
@@ -93,24 +153,17 @@ void pushChange(event_loop* loop, void* args)
             int cmdid = (int)(*st);
 
             elb::GetRouteRsp rsp;
-            rsp.set_modid(modid);
-            rsp.set_cmdid(cmdid);
-
-            hostSet hosts = Singleton<Route>::ins()->getHosts(modid, cmdid);
-            for (hostSetIt ht = hosts.begin();ht != hosts.end(); ++ht)
-            {
-                uint64_t key = *ht;
-                elb::HostAddr host;
-                host.set_ip((uint32_t)(key >> 32));
-                host.set_port((int)key);
-                rsp.add_hosts()->CopyFrom(host);
-            }
+            fillRoute(modid, cmdid, rsp);
             std::string rspStr;
             rsp.SerializeToString(&rspStr);
             net_commu* com = tcp_server::conns[fd];
             com->send_data(rspStr.c_str(), rspStr.size(), elb::GetRouteByAgentRspId);//回复消息
+            ++msgs;
         }
     }
+    statAdd(stats->pushRuns);
+    statAdd(stats->pushMsgs, msgs);
+    stats->pushUs.record(statNowUs() - startUs);
 }
 
 int main()
@@ -131,6 +184,10 @@ int main()
 
     //设置：当收到消息id = GetRouteByAgentReqId （即获取路由）的消息调用的回调函数
     server->add_msg_cb(elb::GetRouteByAgentReqId, getRoute);
+    //设置：当收到消息id = GetRouteBatchByAgentReqId （即批量获取路由）的消息调用的回调函数
+    server->add_msg_cb(elb::GetRouteBatchByAgentReqId, getRouteBatch);
+    //设置：当收到消息id = ServerStatsReqId （即查询运行指标，仅限本机）的消息调用的回调函数
+    server->add_msg_cb(elb::ServerStatsReqId, serverStats);
 
     //当连接建立，调用函数createSubscribe,创建保存自己所订阅mod的集合
     server->onConnBuild(createSubscribe);
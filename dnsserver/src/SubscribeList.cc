@@ -1,3 +1,4 @@
+#include "DnsStats.h"
 #include "SubscribeList.h"
 #include "Server.h"
 
@@ -27,6 +28,7 @@ void SubscribeList::push(std::vector<uint64_t>& changes)
 {
     std::vector<uint64_t>::iterator it;
     __gnu_cxx::hash_set<int>::iterator st;
+    uint64_t queued = 0;
 
     ::pthread_mutex_lock(&booklock);
     ::pthread_mutex_lock(&pushlock);
@@ -40,11 +42,16 @@ void SubscribeList::push(std::vector<uint64_t>& changes)
                 int fd = *st;
                 pushl[fd].insert(mod);
             }
+            queued += bookl[mod].size();
         }
     }
     ::pthread_mutex_unlock(&pushlock);
     ::pthread_mutex_unlock(&booklock);
 
+    statAdd(loadStats.pushCalls);
+    statAdd(loadStats.pushChanges, changes.size());
+    statAdd(loadStats.pushQueued, queued);
+
     //通知各个线程都去执行pushChange
     server->threadPool()->run_task(pushChange);
 }
@@ -68,3 +75,18 @@ void SubscribeList::fetchPush(__gnu_cxx::hash_set<int>& subscribers,
     }
     ::pthread_mutex_unlock(&pushlock);
 }
+
+void SubscribeList::stats(size_t& mods, size_t& subs, size_t& pending)
+{
+    __gnu_cxx::hash_map<uint64_t, __gnu_cxx::hash_set<int> >::iterator it;
+    ::pthread_mutex_lock(&booklock);
+    mods = bookl.size();
+    subs = 0;
+    for (it = bookl.begin();it != bookl.end(); ++it)
+        subs += it->second.size();
+    ::pthread_mutex_unlock(&booklock);
+
+    ::pthread_mutex_lock(&pushlock);
+    pending = pushl.size();
+    ::pthread_mutex_unlock(&pushlock);
+}
@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <time.h>
+#include <deque>
 #include <string>
 #include <vector>
 #include <string.h>
@@ -8,25 +9,44 @@
 #include <sys/time.h>
 #include "elb.pb.h"
 #include "easy_reactor.h"
+#include "latencyHist.h"
+
+//默认闭环：每个连接收到应答后再发下一个请求，测最大吞吐
+//-r rate：开环，不论应答是否返回，按总速率rate/s定时发出请求（轮流使用各连接），测给定压力下的尾延迟
+//开环时耗时从请求"应当发出"的时刻算起，定时器迟到、发送排队的时间都计入，不会低估尾延迟
 
 struct Config
 {
-    Config(): hostip(NULL), hostPort(0), concurrency(0), total(0) {}
+    Config(): hostip(NULL), hostPort(0), concurrency(0), total(0), rate(0) {}
     char* hostip;
     short hostPort;
     int concurrency;
     long total;
+    long rate;
 };
 
-unsigned long getCurrentMills()
+//每个连接上已发出、未收到应答的请求的发出时刻；同一连接上的应答按请求顺序返回
+struct ConnCtx
 {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return (unsigned long)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+    ConnCtx(): client(NULL), connected(false) {}
+    tcp_client* client;
+    bool connected;
+    std::deque<uint64_t> inflight;
+};
+
+uint64_t getCurrentNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
 }
 
 Config config;
-unsigned long startTs, endTs;
+uint64_t startNs = 0;
+long done = 0, sent = 0;
+LatencyHist hist;
+std::vector<ConnCtx> conns;
+size_t nextConn = 0;
 
 void parseOption(int argc, char** argv)
 {
@@ -48,76 +68,120 @@ void parseOption(int argc, char** argv)
         {
             config.total = atol(argv[i + 1]);
         }
+        else if (!strcmp(argv[i], "-r"))
+        {
+            config.rate = atol(argv[i + 1]);
+        }
     }
-    if (!config.hostip || !config.hostPort || !config.concurrency || !config.total)
+    if (!config.hostip || !config.hostPort || !config.concurrency || !config.total || config.rate < 0)
     {
-        printf("./dss-benchmark -h ip -p port -c concurrency -n total\n");
+        printf("./dss-benchmark -h ip -p port -c concurrency -n total [-r rate]\n");
         exit(1);
     }
 }
 
+void finish()
+{
+    uint64_t useNs = getCurrentNs() - startNs;
+    printf("communicate %ld times\n", done);
+    printf("time use %lums\n", (unsigned long)(useNs / 1000000));
+    printf("qps %.2f\n", done * 1e9 / useNs);
+    if (config.rate)
+        printf("target rate %ld/s\n", config.rate);
+    hist.print(stdout, "latency", 1000, "us");
+    exit(0);
+}
+
+void sendGetRoute(net_commu* commu, ConnCtx* conn, uint64_t ts)
+{
+    elb::GetRouteReq req;
+    req.set_modid(10001);
+    req.set_cmdid(1001);
+    std::string reqStr;
+    req.SerializeToString(&reqStr);
+    conn->inflight.push_back(ts);
+    commu->send_data(reqStr.c_str(), reqStr.size(), elb::GetRouteByAgentReqId);
+}
+
 void ActionGetRoute(const char* data, uint32_t len, int msgId, net_commu* commu, void* usr_data)
 {
-    long* count = (long*)usr_data;
+    ConnCtx* conn = (ConnCtx*)usr_data;
     elb::GetRouteRsp rsp;
     //解包，data[0:len)保证是一个完整包
     rsp.ParseFromArray(data, len);
 
-    *count = *count + 1;
-    if (*count >= config.total)
+    uint64_t now = getCurrentNs();
+    if (!conn->inflight.empty())
     {
-        endTs = getCurrentMills();
-        printf("communicate %ld times\n", *count);
-        printf("time use %ldms\n", endTs - startTs);
-        printf("qps %.2f\n", (*count * 1000.0) / (endTs - startTs));
-        exit(1);
+        hist.record(now - conn->inflight.front());
+        conn->inflight.pop_front();
     }
+    ++done;
+    if (done >= config.total)
+        finish();
 
-    int modid = rsp.modid();
-    int cmdid = rsp.cmdid();
-    elb::GetRouteReq req;
-    req.set_modid(modid);
-    req.set_cmdid(cmdid);
-    std::string reqStr;
-    req.SerializeToString(&reqStr);
-    commu->send_data(reqStr.c_str(), reqStr.size(), elb::GetRouteByAgentReqId);//回复消息
+    //闭环：收到应答后立即发下一个
+    if (!config.rate)
+        sendGetRoute(commu, conn, now);
 }
 
 void onConnectionCb(tcp_client* client, void *args)
 {
-    unsigned long* startTsPtr = (unsigned long*)args;
-    if (!*startTsPtr)
-        *startTsPtr = getCurrentMills();
+    ConnCtx* conn = (ConnCtx*)args;
+    conn->connected = true;
+    if (config.rate)
+        return ;
+    if (!startNs)
+        startNs = getCurrentNs();
     //连接建立后，主动发送消息
-    elb::GetRouteReq req;
-    req.set_modid(10001);
-    req.set_cmdid(1001);
-    std::string reqStr;
-    req.SerializeToString(&reqStr);
-    client->send_data(reqStr.c_str(), reqStr.size(), elb::GetRouteByAgentReqId);
+    sendGetRoute(client, conn, getCurrentNs());
+}
+
+//开环：每毫秒补发到期的请求，第k个请求应当在startNs + k/rate秒时发出
+void paceRequests(event_loop* loop, void* usr_data)
+{
+    uint64_t now = getCurrentNs();
+    if (!startNs)
+    {
+        bool anyConnected = false;
+        for (size_t i = 0;i < conns.size(); ++i)
+            anyConnected = anyConnected || conns[i].connected;
+        if (!anyConnected)
+            return ;
+        startNs = now;
+    }
+    long due = (long)((double)(now - startNs) * config.rate / 1e9) + 1;
+    while (sent < due && sent < config.total)
+    {
+        ConnCtx* conn = &conns[nextConn++ % conns.size()];
+        if (!conn->connected)
+            continue;
+        sendGetRoute(conn->client, conn, startNs + (uint64_t)(sent * 1e9 / config.rate));
+        ++sent;
+    }
 }
 
 int main(int argc, char** argv)
 {
     parseOption(argc, argv);
-    long done = 0;
     event_loop loop;
-    std::vector<tcp_client*> clients;
+    conns.resize(config.concurrency);
     for (int i = 0;i < config.concurrency; ++i)
     {
         tcp_client* cli = new tcp_client(&loop, config.hostip, config.hostPort);//创建TCP客户端
         if (!cli) exit(1);
-        cli->add_msg_cb(elb::GetRouteByAgentRspId, ActionGetRoute, &done);//设置：当收到消息id=GetRouteByAgentRspId的消息时的回调函数
-        cli->onConnection(onConnectionCb, &startTs);//当连接建立后，执行函数onConnectionCb
-        clients.push_back(cli);
+        conns[i].client = cli;
+        cli->add_msg_cb(elb::GetRouteByAgentRspId, ActionGetRoute, &conns[i]);//设置：当收到消息id=GetRouteByAgentRspId的消息时的回调函数
+        cli->onConnection(onConnectionCb, &conns[i]);//当连接建立后，执行函数onConnectionCb
     }
+    if (config.rate)
+        loop.run_every(paceRequests, NULL, 0, 1);
 
     loop.process_evs();
 
     for (int i = 0;i < config.concurrency; ++i)
     {
-        tcp_client* cli = clients[i];
-        delete cli;
+        delete conns[i].client;
     }
     return 0;
 }
@@ -0,0 +1,97 @@
+#ifndef __AGENT_STATS_H__
+#define __AGENT_STATS_H__
+
+#include <string>
+#include <stdint.h>
+#include "statsBase.h"
+
+//agent的运行指标：每个线程一份计数器与耗时直方图（见common/base/include/statsBase.h），线程固定，按STAT_THREAD绑定
+//导出方式：UDP端口上的AgentStatsReqId消息（lbagent/tool/agentstats），及[stats] dump_file定期落地的Prometheus文本
+
+#define STAT_TOP_MODS 64//按累计过载次数导出的模块个数上限，避免UDP应答超长
+#define STAT_LOCALITIES 3//节点相对agent的位置分级：同机架、同机房、其他，同RouteLb.h的LOCALITY
+
+//指标所属的线程
+enum STAT_THREAD
+{
+    STAT_UDP0,  //UDP线程8888~8890
+    STAT_UDP1,
+    STAT_UDP2,
+    STAT_DSS,   //主线程：dnsserver client
+    STAT_RPT,   //reporter client线程
+    STAT_OTHER, //未绑定的线程（启动阶段、离线模拟器）
+    STAT_THREADS
+};
+
+//UDP端口上的消息类型
+enum STAT_MSG
+{
+    STAT_GET_HOST,    //GetHostReqId、FixGetHostReqId
+    STAT_REPORT,      //ReportReqId、FixReportReqId
+    STAT_BATCH_REPORT,//CacheBatchRptReqId
+    STAT_CACHE_ROUTE, //CacheGetRouteReqId
+    STAT_TOOL_ROUTE,  //GetRouteByToolReqId
+    STAT_OTHER_MSG,   //WireNegoReqId、AgentStatsReqId
+    STAT_MSG_TYPES
+};
+
+//按缓存行对齐，各线程的计数不共享缓存行
+struct __attribute__((aligned(64))) ThreadStats
+{
+    //UDP线程：各类消息的个数与处理耗时
+    uint64_t msgs[STAT_MSG_TYPES];
+    StatHist msgUs[STAT_MSG_TYPES];
+    //getHost的结果：成功、所有节点overload、模块不存在（本地未命中，须向dnsserver拉取）
+    uint64_t hostSucc;
+    uint64_t hostOverload;
+    uint64_t hostNoexist;
+    //API cache获取路由：版本未变（缓存仍有效）、下发了完整路由
+    uint64_t cacheHit;
+    uint64_t cacheMiss;
+    //RouteLB::_mutex：未能立即加锁的次数及其等待耗时
+    uint64_t lockContended;
+    StatHist lockWaitUs;
+    //暂存的调用结果合并进LB算法的游程数
+    uint64_t foldRuns;
+    //节点状态转换
+    uint64_t toOverload;
+    uint64_t toIdle;
+    //按位置偏好选取：给出的idle节点按位置计数，近处节点太少或过载太多而放宽范围的次数；收到的调用结果（含API cache）按节点位置计数
+    uint64_t localPicks[STAT_LOCALITIES];
+    uint64_t localSpills;
+    uint64_t localCalls[STAT_LOCALITIES];
+    //pullQueue、reptQueue：生产者记入队数，消费者记出队数，差值即队列深度
+    uint64_t pullEnq;
+    uint64_t pullDeq;
+    uint64_t reptEnq;
+    uint64_t reptDeq;
+    //dnsserver client
+    uint64_t dssConnects;
+    uint64_t dssRoutes;
+    uint64_t dssHosts;
+    uint64_t subsetSkipped;//收到的节点中落在本agent子集之外、不跟踪的个数
+    //reporter client
+    uint64_t rptReqs;
+    uint64_t rptResults;
+};
+
+//每个线程的指标，静态分配，未调用initStats（如离线模拟器）也可计数
+extern ThreadStats threadStats[STAT_THREADS];
+//当前线程的指标，bindStats之前为STAT_OTHER
+extern __thread ThreadStats* curStats;
+
+static inline ThreadStats* myStats()
+{
+    return curStats? curStats: &threadStats[STAT_OTHER];
+}
+
+//读取[stats]配置，记下启动时刻
+void initStats();
+//将当前线程绑定到某个STAT_THREAD
+void bindStats(int thread);
+//导出为Prometheus文本格式；limit > 0时截断到limit字节以内（在行尾截断，模块明细在最后）
+void dumpStats(std::string& text, size_t limit = 0);
+//写入[stats] dump_file（先写临时文件再rename，供node_exporter的textfile collector读取），由主线程定期调用
+void dumpStatsFile();
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef __PROBER_H__
+#define __PROBER_H__
+
+#include <vector>
+#include <stdint.h>
+#include <ext/hash_map>
+#include "RouteLb.h"
+#include "easy_reactor.h"
+
+//overload节点的主动探测：运行在UDP线程自己的event loop中，对本线程RouteLB里的overload节点发起非阻塞TCP connect
+//connect成功视为探测成功，失败或超时视为探测失败，结果经RouteLB::probeResult合并进LB算法
+class Prober
+{
+public:
+    Prober(event_loop* loop, RouteLB* routeLB);
+
+    //由UDP线程周期性调用：清理超时的探测，到达探测周期时发起新一轮探测
+    void tick();
+
+private:
+    struct Probe
+    {
+        ProbeTarget target;
+        uint64_t deadline;//单调时钟,ms
+    };
+
+    void startRound();
+    void startProbe(const ProbeTarget& target, uint64_t now);
+    void finish(int fd, bool ok);
+
+    static void onWritable(event_loop* loop, int fd, void* args);
+
+    event_loop* _loop;
+    RouteLB* _routeLB;
+    int _interval;//探测周期,ms
+    int _timeout;//单次探测超时,ms
+    int _maxInflight;//同时进行中的探测个数上限
+    uint64_t _lstRound;
+    ProbeTarget _cursor;//上一轮最后发起探测的目标，下一轮从其后开始
+    //fd -> 进行中的探测
+    __gnu_cxx::hash_map<int, Probe> _inflight;
+};
+
+#endif
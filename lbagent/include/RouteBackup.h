@@ -0,0 +1,264 @@
+#ifndef __ROUTE_BACKUP_H__
+#define __ROUTE_BACKUP_H__
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <ext/hash_map>
+
+//lbagent落地的静态路由（二进制），供API在agent宕机时mmap后直接查找
+//每个UDP Server线程一个文件：第i个线程（modid+cmdid % 3 = i）写BACKUP_FILE_PREFIX(i+1)
+//文件布局：BackupHeader | BackupModule[modCnt]（按key升序） | BackupHost[hostCnt]
+//checksum覆盖header之后的全部内容
+//
+//两次全量落地之间，路由的变化以追加方式写入同名的".journal"文件：JournalHeader | (JournalRecord | BackupHost[count])...
+//journal只在generation与全量文件一致时有效，读者以journal中同一模块的最后一条记录为准，count=0表示模块已删除
+
+#define BACKUP_FILE_PREFIX "/tmp/backupRoute.bin."
+#define BACKUP_MAGIC 0x524c4245 //"EBLR"
+#define BACKUP_VERSION 1
+#define JOURNAL_SUFFIX ".journal"
+
+struct BackupHeader
+{
+    uint32_t magic;
+    uint32_t version;//文件格式版本
+    uint32_t modCnt;
+    uint32_t hostCnt;
+    uint32_t checksum;
+    uint32_t generation;//每次全量落地递增，journal以此对应全量文件
+    int64_t ts;//落地时间
+};
+
+struct BackupModule
+{
+    uint64_t key;//modid << 32 + cmdid
+    int64_t version;//路由版本
+    uint32_t first;//此模块第一个节点在BackupHost数组中的下标
+    uint32_t count;//此模块的节点个数
+};
+
+struct BackupHost
+{
+    uint32_t ip;//与API一致，网络序的s_addr
+    int32_t port;
+};
+
+struct JournalHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t generation;
+    uint32_t reserved;
+};
+
+struct JournalRecord
+{
+    uint64_t key;
+    int64_t version;
+    uint32_t count;//其后紧跟count个BackupHost；0表示删除此模块
+    uint32_t checksum;//覆盖key、version、count及其后的节点
+};
+
+//FNV-1a
+static inline uint32_t backupChecksum(const void* data, size_t len, uint32_t hash = 2166136261u)
+{
+    const unsigned char* p = (const unsigned char*)data;
+    for (size_t i = 0;i < len; ++i)
+    {
+        hash ^= p[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static inline uint32_t journalChecksum(const JournalRecord* rec, const BackupHost* hosts)
+{
+    uint32_t hash = backupChecksum(rec, offsetof(JournalRecord, checksum));
+    return backupChecksum(hosts, rec->count * sizeof(BackupHost), hash);
+}
+
+//只读映射一个静态路由文件及其journal；映射时校验格式与checksum，全量文件不合法则视为不存在，journal在第一条不合法的记录处截止
+class BackupView
+{
+public:
+    BackupView(): _base(NULL), _size(0), _mods(NULL), _hosts(NULL), _modCnt(0), _generation(0),
+        _journal(NULL), _journalSize(0) { }
+    ~BackupView() { unmap(); }
+
+    bool mapped() const { return _base != NULL; }
+
+    bool map(const char* path)
+    {
+        unmap();
+        size_t size = 0;
+        void* base = mapFile(path, sizeof(BackupHeader), size);
+        if (!base)
+            return false;
+        const BackupHeader* hdr = (const BackupHeader*)base;
+        size_t expect = sizeof(BackupHeader) + (size_t)hdr->modCnt * sizeof(BackupModule) +
+            (size_t)hdr->hostCnt * sizeof(BackupHost);
+        if (hdr->magic != BACKUP_MAGIC || hdr->version != BACKUP_VERSION || expect != size ||
+            backupChecksum(hdr + 1, expect - sizeof(BackupHeader)) != hdr->checksum)
+        {
+            ::munmap(base, size);
+            return false;
+        }
+        _base = base;
+        _size = size;
+        _modCnt = hdr->modCnt;
+        _generation = hdr->generation;
+        _mods = (const BackupModule*)(hdr + 1);
+        _hosts = (const BackupHost*)(_mods + _modCnt);
+        mapJournal(path);
+        return true;
+    }
+
+    void unmap()
+    {
+        if (_base)
+            ::munmap(_base, _size);
+        if (_journal)
+            ::munmap(_journal, _journalSize);
+        _base = NULL;
+        _size = 0;
+        _mods = NULL;
+        _hosts = NULL;
+        _modCnt = 0;
+        _generation = 0;
+        _journal = NULL;
+        _journalSize = 0;
+        _overlay.clear();
+    }
+
+    //查找模块，journal中的记录优先于全量文件；找到则返回其节点数组及个数
+    const BackupHost* find(uint64_t key, uint32_t& count) const
+    {
+        if (!_overlay.empty())
+        {
+            Overlay::const_iterator it = _overlay.find(key);
+            if (it != _overlay.end())
+            {
+                count = it->second.count;
+                return count? it->second.hosts: NULL;
+            }
+        }
+        uint32_t lo = 0, hi = _modCnt;
+        while (lo < hi)
+        {
+            uint32_t mid = lo + (hi - lo) / 2;
+            if (_mods[mid].key < key)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if (lo == _modCnt || _mods[lo].key != key)
+            return NULL;
+        count = _mods[lo].count;
+        return _hosts + _mods[lo].first;
+    }
+
+    //列出所有现存模块及其路由版本（含journal中新增的，不含journal中已删除的）
+    void getModules(std::vector<std::pair<uint64_t, int64_t> >& mods) const
+    {
+        for (uint32_t i = 0;i < _modCnt; ++i)
+        {
+            if (_overlay.find(_mods[i].key) == _overlay.end())
+                mods.push_back(std::make_pair(_mods[i].key, _mods[i].version));
+        }
+        for (Overlay::const_iterator it = _overlay.begin();it != _overlay.end(); ++it)
+        {
+            if (it->second.count)
+                mods.push_back(std::make_pair(it->first, it->second.version));
+        }
+    }
+
+private:
+    static void* mapFile(const char* path, size_t minSize, size_t& size)
+    {
+        int fd = ::open(path, O_RDONLY);
+        if (fd == -1)
+            return NULL;
+        struct stat st;
+        if (::fstat(fd, &st) == -1 || st.st_size < (off_t)minSize)
+        {
+            ::close(fd);
+            return NULL;
+        }
+        void* base = ::mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (base == MAP_FAILED)
+            return NULL;
+        size = st.st_size;
+        return base;
+    }
+
+    void mapJournal(const char* path)
+    {
+        std::string jpath = std::string(path) + JOURNAL_SUFFIX;
+        size_t size = 0;
+        void* base = mapFile(jpath.c_str(), sizeof(JournalHeader), size);
+        if (!base)
+            return ;
+        const JournalHeader* hdr = (const JournalHeader*)base;
+        if (hdr->magic != BACKUP_MAGIC || hdr->version != BACKUP_VERSION || hdr->generation != _generation)
+        {
+            ::munmap(base, size);
+            return ;
+        }
+        _journal = base;
+        _journalSize = size;
+        //末尾可能是写了一半的记录，遇到第一条不完整或校验失败的记录即停止
+        const char* p = (const char*)(hdr + 1);
+        const char* end = (const char*)base + size;
+        while (p + sizeof(JournalRecord) <= end)
+        {
+            const JournalRecord* rec = (const JournalRecord*)p;
+            const BackupHost* hosts = (const BackupHost*)(rec + 1);
+            if ((size_t)(end - (const char*)hosts) < (size_t)rec->count * sizeof(BackupHost) ||
+                journalChecksum(rec, hosts) != rec->checksum)
+                break;
+            OverlayItem& item = _overlay[rec->key];
+            item.hosts = hosts;
+            item.count = rec->count;
+            item.version = rec->version;
+            p = (const char*)(hosts + rec->count);
+        }
+    }
+
+    struct OverlayItem
+    {
+        const BackupHost* hosts;
+        uint32_t count;
+        int64_t version;
+    };
+    typedef __gnu_cxx::hash_map<uint64_t, OverlayItem> Overlay;
+
+    void* _base;
+    size_t _size;
+    const BackupModule* _mods;
+    const BackupHost* _hosts;
+    uint32_t _modCnt;
+    uint32_t _generation;
+    void* _journal;
+    size_t _journalSize;
+    Overlay _overlay;//journal中每个模块的最新记录
+};
+
+//将modules（须按key升序）与hosts全量写入path，并为新的generation建立空journal
+//都是先写临时文件再rename，读者看到的总是完整的文件
+bool writeRouteBackup(const char* path, uint32_t generation, const std::vector<BackupModule>& modules,
+    const std::vector<BackupHost>& hosts);
+
+//将modules（count为0表示删除）追加到path的journal，一次write写入，读者不会看到被打乱的记录
+bool appendRouteJournal(const char* path, const std::vector<BackupModule>& modules,
+    const std::vector<BackupHost>& hosts);
+
+#endif
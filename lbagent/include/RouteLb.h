@@ -8,7 +8,21 @@
 #include <stdint.h>
 #include <pthread.h>
 #include <ext/hash_map>
+#include <ext/hash_set>
 #include "elb.pb.h"
+#include "TimerWheel.h"
+#include "RouteBackup.h"
+#include "coarseClock.h"
+#include "consistentHash.h"
+
+//节点相对本agent的位置，越小越近；由dnsserver下发的机房、机架编号与[locality]配置比较得出
+enum LOCALITY
+{
+    LOC_RACK,  //同机架
+    LOC_IDC,   //同机房
+    LOC_REMOTE,//其他，或位置未知
+    LOC_TIERS
+};
 
 //host info
 struct HI
@@ -24,8 +38,9 @@ struct HI
         continErr(0),
         overload(false),
         overloadTs(0),
-        windErrCnt(0) {
-            windowTs = time(NULL);
+        windErrCnt(0),
+        locality(LOC_REMOTE) {
+            windowTs = MONO_SEC();
         }
 
     bool checkWindow();
@@ -41,28 +56,81 @@ struct HI
     uint32_t continSucc;
     uint32_t continErr;
     bool overload;
-    long windowTs;
-    long overloadTs;
+    long windowTs;//单调时钟,秒
+    long overloadTs;//单调时钟,秒
 
     uint32_t windErrCnt;//失败率>=windErrRate的连续idle窗口个数，含此时的idle窗口
+    int locality;//LOCALITY
+    WheelNode timer;//idle节点挂窗口到期定时器，overload节点挂过载超时定时器
+};
+
+//节点状态转换的原因
+enum TRANS_REASON
+{
+    TRANS_ERR_RATE,   //（虚拟）失败率高于err_rate
+    TRANS_CONTIN_ERR, //连续失败次数达到contin_err_lim
+    TRANS_WINDOW,     //连续wind_err_limit个窗口真实失败率高于wind_err_rate
+    TRANS_SUCC_RATE,  //（虚拟）成功率高于succ_rate
+    TRANS_CONTIN_SUCC,//连续成功次数达到contin_succ_lim
+    TRANS_TIMEOUT     //overload时长达到overload_wait_lim
+};
+
+//一个节点在一个周期内的状态转换，聚合后由RouteLB在_mutex外输出日志
+struct HostTrans
+{
+    uint32_t toOverload;//进入overload的次数
+    uint32_t toIdle;    //回到idle的次数
+    bool overload;      //最后一次转换后的状态
+    int reason;         //最后一次转换的原因
+    uint32_t succ;      //最后一次转换时的成功、失败个数（TRANS_WINDOW为真实个数，其余为虚拟个数）
+    uint32_t err;
 };
 
+//节点ip << 32 + port -> 转换
+typedef __gnu_cxx::hash_map<uint64_t, HostTrans> HostTransMap;
+//modid << 32 + cmdid -> 此模块下有转换的节点
+typedef __gnu_cxx::hash_map<uint64_t, HostTransMap> TransMap;
+//modid << 32 + cmdid -> 此模块当前的overload节点（ip << 32 + port），随节点状态转换增量维护，供主动探测取目标
+typedef __gnu_cxx::hash_map<uint64_t, __gnu_cxx::hash_set<uint64_t> > DownMap;
+
 class LB
 {
 public:
-    LB(int modid, int cmdid): 
+    //downs为NULL表示未开启主动探测，不维护overload节点集合
+    LB(int modid, int cmdid, TimerWheel* wheel, TransMap* trans, DownMap* downs): 
         effectData(0),
         lstRptTime(0),
         status(ISPULLING),
+        downVer(0),
+        ovldCnt(0),
+        succCostSum(0),
+        succCostCnt(0),
         _modid(modid),
         _cmdid(cmdid),
-        _accessCnt(0) { }
+        _accessCnt(0),
+        _wheel(wheel),
+        _trans(trans),
+        _downs(downs),
+        _chashValid(false),
+        _accessed(false),
+        _pullDue(false),
+        _hasRpt(false) {
+            for (int t = 0;t < LOC_REMOTE; ++t)
+                _localHosts[t] = 0;
+            _updateTimer.type = ROUTE_UPDATE;
+            _updateTimer.owner = this;
+            _reportTimer.type = STATUS_REPORT;
+            _reportTimer.owner = this;
+        }
 
     ~LB();
 
     bool empty() const { return _hostMap.empty(); }
 
     int getHost(elb::GetHostRsp& rsp);
+    //按key做一致性哈希选取节点：首选节点overload时顺延到下一个idle节点，每probeNum次仍把首选节点给出去试探
+    //节点全部overload时同getHost
+    int getHostByKey(uint64_t key, int policy, int param, elb::GetHostRsp& rsp);
 
     void getRoute(std::vector<HI*>& vec);
 
@@ -70,15 +138,31 @@ public:
     void reportSomeSucc(int ip, int port, unsigned succCnt);
     void reportSomeErr(int ip, int port, unsigned errCnt);
 
-    void update(elb::GetRouteRsp& rsp);
+    //返回节点集合是否确实发生了变化
+    bool update(elb::GetRouteRsp& rsp);
 
     void pull();
+    //标记为正在拉取，拉取请求由调用者发出
+    void markPulling();
 
-    void persist(FILE* fp);
+    //将此模块的节点追加到hosts，用于静态路由落地
+    void persist(std::vector<BackupHost>& hosts);
 
-    void report2Rpter();
+    //force: 本周期没有收到调用结果也上报，用于节点状态发生了转换
+    void report2Rpter(bool force = false);
 
     bool hasOvHost() const { return !_downList.empty(); }
+    uint32_t downCnt() const { return _downList.size(); }
+
+    //取出所有overload节点，供主动探测
+    void getDownHosts(std::vector<std::pair<uint32_t, int> >& hosts);
+
+    //API访问此模块时调用：路由有效期已过则重拉取，否则只记下被访问过
+    void access();
+    //拉取被中断（dss client断开），下次被访问时重拉
+    void resetPulling();
+    //时间轮上挂着的定时器到期
+    void onTimer(WheelNode* node);
 
     enum STATUS
     {
@@ -86,12 +170,39 @@ public:
         ISNEW
     };
 
-    long effectData;//used to repull, last pull timestamp
-    long lstRptTime;//last report timestamp
+    enum TIMER
+    {
+        HOST_WINDOW,  //idle节点的统计窗口到期
+        HOST_OVERLOAD,//overload节点的过载时长到达ovldWaitLim
+        ROUTE_UPDATE, //路由有效期到期
+        STATUS_REPORT //向reporter上报的周期到达
+    };
+
+    long effectData;//used to repull, last pull timestamp (monotonic)
+    long lstRptTime;//last report timestamp (monotonic)
     STATUS status;
     long version;//route version
+    uint32_t downVer;//overload节点集合的版本：有节点进入或离开overload即递增，供API cache比对
+    uint32_t ovldCnt;//累计有多少次节点被判为overload，导出为运行指标
+    uint64_t succCostSum;//累计成功调用的耗时之和(ms)，只计api带了耗时的，导出为运行指标
+    uint64_t succCostCnt;//累计带了耗时的成功调用个数
 
 private:
+    void hostOverload(HI* hi, int reason);
+    void hostIdle(HI* hi, int reason);
+    //记入所属RouteLB本周期的状态转换，只做计数，不格式化、不写日志
+    void recordTrans(HI* hi, bool overload, int reason);
+    void armWindow(HI* hi);
+    //节点进出overload（含删除overload节点）时更新所属RouteLB的overload节点集合
+    void trackDown(HI* hi, bool down);
+    //节点进出空闲队列，同时维护按位置划分的空闲队列
+    void addIdle(HI* hi);
+    void rmIdle(HI* hi);
+    //节点位置变化（含新增、删除）时更新各位置的节点计数
+    void countHost(HI* hi, int delta);
+    //取出下一个idle节点：优先同机架、同机房，近处的idle节点太少或过载比例太高时逐级放宽
+    HI* nextIdle();
+
     typedef __gnu_cxx::hash_map<uint64_t, HI*> HostMap;
     typedef __gnu_cxx::hash_map<uint64_t, HI*>::iterator HostMapIt;
 
@@ -101,6 +212,56 @@ private:
     HostMap _hostMap;
     std::list<HI*> _runningList, _downList;
     typedef std::list<HI*>::iterator ListIt;
+    //_localList[t]: 位置不远于t的idle节点，_localHosts[t]: 位置不远于t的全部节点个数；未配置[locality]时为空
+    std::list<HI*> _localList[LOC_REMOTE];
+    uint32_t _localHosts[LOC_REMOTE];
+    //所属RouteLB的时间轮，窗口重置、过载超时、路由重拉、状态上报都由它按时驱动
+    TimerWheel* _wheel;
+    //所属RouteLB本周期的节点状态转换
+    TransMap* _trans;
+    //所属RouteLB的overload节点集合，未开启主动探测时为NULL
+    DownMap* _downs;
+    //一致性哈希表，首次按key获取节点时建立，节点集合变化时作废；_chashHosts与_chash.hosts()下标对应
+    ConsistentHash _chash;
+    std::vector<HI*> _chashHosts;
+    bool _chashValid;
+    WheelNode _updateTimer, _reportTimer;
+    bool _accessed;//本次路由有效期内是否被API访问过
+    bool _pullDue;//路由有效期已过但尚未被访问，下次访问时重拉
+    bool _hasRpt;//本上报周期内是否收到过调用结果
+};
+
+//UDP线程暂存的一段调用结果：同一[modid,cmdid]下同一节点连续cnt次成功或失败
+//按游程记录，保证同一节点成功、失败的先后顺序在合并进LB算法时不被打乱
+struct PendingRun
+{
+    uint64_t mod;//modid << 32 + cmdid
+    int ip;
+    int port;
+    bool succ;
+    uint32_t cnt;
+    uint64_t costSum;//成功游程中带了耗时的调用的耗时之和(ms)
+    uint32_t costCnt;//成功游程中带了耗时的调用个数
+};
+
+//主动探测的目标：[modid,cmdid]下的一个overload节点
+struct ProbeTarget
+{
+    int modid;
+    int cmdid;
+    uint32_t ip;
+    int port;
+};
+
+//一个模块的运行指标
+struct ModStat
+{
+    int modid;
+    int cmdid;
+    uint32_t overloads;//累计被判为overload的节点次数
+    uint32_t downs;//当前overload节点个数
+    uint64_t succCostSum;//累计成功调用耗时之和(ms)
+    uint64_t succCostCnt;//累计带了耗时的成功调用个数
 };
 
 class RouteLB
@@ -108,22 +269,64 @@ class RouteLB
 public:
     RouteLB(int id);
 
-    int getHost(int modid, int cmdid, elb::GetHostRsp& rsp);
+    //byKey: 按key做一致性哈希选取节点，策略见[hash]配置
+    int getHost(int modid, int cmdid, elb::GetHostRsp& rsp, bool byKey = false, uint64_t reqKey = 0);
 
     void report(elb::ReportReq& req);
+    //tcost: 调用耗时(ms)，未知时为0；失败调用按耗时放大失败次数，成功调用只计入耗时统计
+    void report(int modid, int cmdid, int ip, int port, int retcode, uint32_t tcost);
     void batchReport(elb::CacheBatchRptReq& req);
 
+    //将暂存的调用结果合并进LB算法，由所属UDP线程周期性调用
+    void foldPending();
+    //推进时间轮，处理到期的定时器，由所属UDP线程每秒调用
+    void tick();
+    //暂存调用结果的合并周期，毫秒；0表示不暂存，上报即合并
+    int foldInterval() const;
+
+    //是否开启了对overload节点的主动探测
+    bool activeProbe() const;
+    //取出所有overload节点：只遍历增量维护的overload节点集合，不遍历全部模块
+    void getProbeTargets(std::vector<ProbeTarget>& targets);
+    //主动探测的结果，与API上报的调用结果一样暂存后合并进LB算法
+    void probeResult(int modid, int cmdid, int ip, int port, bool ok);
+
     void getRoute(int modid, int cmdid, elb::GetRouteRsp& rsp);
-    void cacheGetRoute(int modid, int cmdid, long version, elb::CacheGetRouteRsp& rsp);
+    //subport > 0时同时为api订阅此mod的变化
+    void cacheGetRoute(int modid, int cmdid, long version, int subport, elb::CacheGetRouteRsp& rsp);
+    //设置推送订阅通知所用的fd，即所属UDP Server的fd：api的socket是connect过的，只收得到从它发出的包
+    void setNotifyFd(int fd);
 
     void update(int modid, int cmdid, elb::GetRouteRsp& rsp);
 
     //清除任何标记为：正在拉取 的[modid,cmdid]状态，当dss client网络断开后需要调用之
     void clearPulling();
 
+    //将路由落地：只有路由变化过才写盘，变化的模块追加到journal，journal过长时全量重写
     void persistRoute();
 
+    //启动时用上次落地的路由预热：模块立即可用，状态为ISPULLING，等待与dnsserver连接后批量刷新
+    void loadBackup();
+    //取出预热后尚未刷新的模块，标记为正在拉取并加入批量拉取请求
+    void pullWarm(elb::GetRouteBatchReq& req);
+
+    //追加各模块的运行指标
+    void getModStats(std::vector<ModStat>& mods);
+
 private:
+    //加_mutex，未能立即加锁时记录等待耗时
+    void lock();
+    //costSum/costCnt: 成功调用中带了耗时的部分的耗时之和、个数
+    void addPending(int modid, int cmdid, int ip, int port, bool succ, uint32_t cnt, uint64_t costSum = 0, uint32_t costCnt = 0);
+    //记录或续订api对此mod的订阅，返回此mod已推送到的序号；调用者持有_mutex
+    uint32_t subscribe(uint64_t key, int port, LB* lb);
+    //此mod的版本或overload节点集合与上次告知订阅者的不同，则推送给所有订阅者；调用者持有_mutex
+    void notifySubs(uint64_t key);
+    //告知API cache的试探周期
+    int cacheProbeNum() const;
+    //每trans_log_interval秒输出一次聚合后的节点状态转换日志，并让有转换的模块立即上报reporter；由tick调用，调用者持有_mutex，返回时已解锁
+    void flushTrans(long ts);
+
     typedef __gnu_cxx::hash_map<uint64_t, LB*> RouteMap;
     typedef __gnu_cxx::hash_map<uint64_t, LB*>::iterator RouteMapIt;
     RouteMap _routeMap;
@@ -131,6 +334,36 @@ private:
     pthread_mutex_t _mutex;
     //标识自己是第几个RouteLB
     int _id;
+    //上报只由本RouteLB所属的UDP线程处理，故暂存的调用结果无需加锁，合并时才持有_mutex
+    std::vector<PendingRun> _pending;
+    //节点ip << 32 + port -> 此节点最后一段游程在_pending中的下标
+    __gnu_cxx::hash_map<uint64_t, size_t> _lastRun;
+    TimerWheel _wheel;
+    //上次落地后路由发生变化（含删除）的模块
+    __gnu_cxx::hash_set<uint64_t> _dirty;
+    //当前全量文件的generation，及其journal中已追加的记录数
+    uint32_t _backupGen;
+    int _journalCnt;
+    //下次落地须全量重写（尚未写过全量文件，或上次写盘失败）
+    bool _needFull;
+    //由落地路由预热、尚未从dnsserver刷新的模块
+    std::vector<uint64_t> _warmMods;
+    //API cache对某mod的订阅：最近一次告知订阅者的版本、overload节点集合的版本、推送序号，及各订阅者端口的订阅到期时刻
+    struct CacheSub
+    {
+        long version;
+        uint32_t downVer;
+        uint32_t pushSeq;
+        __gnu_cxx::hash_map<int, long> ports;
+    };
+    typedef __gnu_cxx::hash_map<uint64_t, CacheSub> CacheSubMap;
+    CacheSubMap _cacheSubs;
+    int _notifyFd;
+    //本周期的节点状态转换，及下次输出的时刻
+    TransMap _trans;
+    long _transTs;
+    //开启主动探测时各模块的overload节点
+    DownMap _downs;
 };
 
 #endif
@@ -0,0 +1,66 @@
+#ifndef __TIMER_WHEEL_H__
+#define __TIMER_WHEEL_H__
+
+#include <stddef.h>
+
+//挂在时间轮上的定时器节点，嵌入到使用者（HI、LB）中，取消定时器只需O(1)摘链
+struct WheelNode
+{
+    WheelNode(): prev(NULL), next(NULL), expire(0), type(0), owner(NULL), arg(NULL) { }
+    ~WheelNode() { unlink(); }
+
+    bool linked() const { return next != NULL; }
+
+    void unlink()
+    {
+        if (next)
+        {
+            prev->next = next;
+            next->prev = prev;
+            prev = next = NULL;
+        }
+    }
+
+    WheelNode* prev;
+    WheelNode* next;
+    long expire;//到期时刻,秒
+    int type;//定时器类型，由使用者解释
+    void* owner;
+    void* arg;
+};
+
+//秒级分层时间轮：3层，每层64个槽，分别覆盖64s、64*64s、64*64*64s，更远的到期时刻暂挂在最高层，逐层下移
+class TimerWheel
+{
+public:
+    TimerWheel(long now);
+
+    //添加定时器，expire不晚于当前时刻的将在下一次推进时到期；node已在轮上时先摘下
+    void add(WheelNode* node, long expire);
+
+    void del(WheelNode* node) { node->unlink(); }
+
+    //推进到now，所有已到期的节点按到期先后挂到expired链表（expired作为哨兵，需为空）
+    void advance(long now, WheelNode& expired);
+
+    //将sentinel初始化为空的哨兵链表
+    static void initList(WheelNode& sentinel) { sentinel.prev = sentinel.next = &sentinel; }
+
+private:
+    enum
+    {
+        SLOT_BITS = 6,
+        SLOTS = 1 << SLOT_BITS,
+        SLOT_MASK = SLOTS - 1,
+        LEVELS = 3
+    };
+
+    void place(WheelNode* node);
+    void cascade(int level);
+    static void append(WheelNode& list, WheelNode* node);
+
+    long _now;//已经推进到的时刻
+    WheelNode _slots[LEVELS][SLOTS];
+};
+
+#endif
@@ -2,10 +2,36 @@
 #include "log.h"
 #include "elb.pb.h"
 #include "Server.h"
+#include "Prober.h"
+#include "AgentStats.h"
+#include "fixedWire.h"
 #include "easy_reactor.h"
 
+//是否允许api使用定长编码收发GetHost/Report消息
+static bool fixedCodecOn = true;
+
+//记录一个请求的处理耗时
+static void statRequest(int msg, uint64_t begin)
+{
+    ThreadStats* stats = myStats();
+    statAdd(stats->msgs[msg]);
+    stats->msgUs[msg].record(statNowUs() - begin);
+}
+
+static void statGetHost(int retcode)
+{
+    ThreadStats* stats = myStats();
+    if (retcode == SUCCESS)
+        statAdd(stats->hostSucc);
+    else if (retcode == OVERLOAD)
+        statAdd(stats->hostOverload);
+    else
+        statAdd(stats->hostNoexist);
+}
+
 static void getHost(const char* data, uint32_t len, int msgid, net_commu* commu, void* usrData)
 {
+    uint64_t begin = statNowUs();
     elb::GetHostReq req;
     req.ParseFromArray(data, len);//解包，data[0:len)保证是一个完整包
     int modid = req.modid();
@@ -17,23 +43,95 @@ static void getHost(const char* data, uint32_t len, int msgid, net_commu* commu,
     rsp.set_cmdid(cmdid);
     //get host from route lb metadata
     RouteLB* ptrRouteLB = (RouteLB*)usrData;
-    ptrRouteLB->getHost(modid, cmdid, rsp);
+    ptrRouteLB->getHost(modid, cmdid, rsp, req.has_hashkey(), req.hashkey());
     std::string rspStr;
     rsp.SerializeToString(&rspStr);
     commu->send_data(rspStr.c_str(), rspStr.size(), elb::GetHostRspId);//回复消息
+    statGetHost(rsp.retcode());
+    statRequest(STAT_GET_HOST, begin);
 }
 
 static void reportStatus(const char* data, uint32_t len, int msgid, net_commu* commu, void* usrData)
 {
+    uint64_t begin = statNowUs();
     elb::ReportReq req;
     req.ParseFromArray(data, len);//解包，data[0:len)保证是一个完整包
     //report to route lb metadata
     RouteLB* ptrRouteLB = (RouteLB*)usrData;
     ptrRouteLB->report(req);
+    statRequest(STAT_REPORT, begin);
+}
+
+static void wireNego(const char* data, uint32_t len, int msgid, net_commu* commu, void* usrData)
+{
+    uint64_t begin = statNowUs();
+    FixWireNego req, rsp;
+    if (!fixedDecode(data, len, req))
+        return ;
+    //回复双方都支持的定长编码版本，0表示api只能使用protobuf
+    rsp.version = 0;
+    if (fixedCodecOn)
+        rsp.version = req.version < FIXED_WIRE_VERSION? req.version: FIXED_WIRE_VERSION;
+    commu->send_data((const char*)&rsp, sizeof rsp, elb::WireNegoRspId);//回复消息
+    statRequest(STAT_OTHER_MSG, begin);
+}
+
+//以定长编码回复FixGetHostReq、FixGetHostKeyReq
+static void replyHostFixed(uint32_t seq, int modid, int cmdid, const elb::GetHostRsp& rsp, net_commu* commu, uint64_t begin)
+{
+    FixGetHostRsp fixRsp;
+    fixRsp.seq = seq;
+    fixRsp.modid = modid;
+    fixRsp.cmdid = cmdid;
+    fixRsp.retcode = rsp.retcode();
+    fixRsp.ip = rsp.has_host()? rsp.host().ip(): 0;
+    fixRsp.port = rsp.has_host()? rsp.host().port(): 0;
+    commu->send_data((const char*)&fixRsp, sizeof fixRsp, elb::FixGetHostRspId);//回复消息
+    statGetHost(fixRsp.retcode);
+    statRequest(STAT_GET_HOST, begin);
+}
+
+static void getHostFixed(const char* data, uint32_t len, int msgid, net_commu* commu, void* usrData)
+{
+    uint64_t begin = statNowUs();
+    FixGetHostReq req;
+    if (!fixedDecode(data, len, req))
+        return ;
+    elb::GetHostRsp rsp;
+    //get host from route lb metadata
+    RouteLB* ptrRouteLB = (RouteLB*)usrData;
+    ptrRouteLB->getHost(req.modid, req.cmdid, rsp);
+    replyHostFixed(req.seq, req.modid, req.cmdid, rsp, commu, begin);
+}
+
+static void getHostKeyFixed(const char* data, uint32_t len, int msgid, net_commu* commu, void* usrData)
+{
+    uint64_t begin = statNowUs();
+    FixGetHostKeyReq req;
+    if (!fixedDecode(data, len, req))
+        return ;
+    elb::GetHostRsp rsp;
+    //按key从route lb metadata选取节点
+    RouteLB* ptrRouteLB = (RouteLB*)usrData;
+    ptrRouteLB->getHost(req.modid, req.cmdid, rsp, true, ((uint64_t)req.keyHigh << 32) | req.keyLow);
+    replyHostFixed(req.seq, req.modid, req.cmdid, rsp, commu, begin);
+}
+
+static void reportStatusFixed(const char* data, uint32_t len, int msgid, net_commu* commu, void* usrData)
+{
+    uint64_t begin = statNowUs();
+    FixReportReq req;
+    if (!fixedDecode(data, len, req))
+        return ;
+    //report to route lb metadata
+    RouteLB* ptrRouteLB = (RouteLB*)usrData;
+    ptrRouteLB->report(req.modid, req.cmdid, req.ip, req.port, req.retcode, req.tcost);
+    statRequest(STAT_REPORT, begin);
 }
 
 static void getRouteByTool(const char* data, uint32_t len, int msgid, net_commu* commu, void* usrData)
 {
+    uint64_t begin = statNowUs();
     elb::GetRouteReq req;
     req.ParseFromArray(data, len);//解包，data[0:len)保证是一个完整包
     //report to route lb metadata
@@ -45,10 +143,12 @@ static void getRouteByTool(const char* data, uint32_t len, int msgid, net_commu*
     std::string rspStr;
     rsp.SerializeToString(&rspStr);
     commu->send_data(rspStr.c_str(), rspStr.size(), elb::GetRouteByToolRspId);//回复消息
+    statRequest(STAT_TOOL_ROUTE, begin);
 }
 
 static void cacheGetRoute(const char* data, uint32_t len, int msgid, net_commu* commu, void* usrData)
 {
+    uint64_t begin = statNowUs();
     elb::CacheGetRouteReq req;
     req.ParseFromArray(data, len);//解包，data[0:len)保证是一个完整包
     //report to route lb metadata
@@ -57,19 +157,54 @@ static void cacheGetRoute(const char* data, uint32_t len, int msgid, net_commu*
     rsp.set_modid(req.modid());
     rsp.set_cmdid(req.cmdid());
     long version = req.version();
-    ptrRouteLB->cacheGetRoute(req.modid(), req.cmdid(), version, rsp);
+    ptrRouteLB->cacheGetRoute(req.modid(), req.cmdid(), version, req.subport(), rsp);
     std::string rspStr;
     rsp.SerializeToString(&rspStr);
     commu->send_data(rspStr.c_str(), rspStr.size(), elb::CacheGetRouteRspId);//回复消息
+    //版本未变：api的缓存仍有效，应答中不带路由
+    if (rsp.version() != -1 && rsp.version() == version)
+        statAdd(myStats()->cacheHit);
+    else
+        statAdd(myStats()->cacheMiss);
+    statRequest(STAT_CACHE_ROUTE, begin);
 }
 
 static void batchReport(const char* data, uint32_t len, int msgid, net_commu* commu, void* usrData)
 {
+    uint64_t begin = statNowUs();
     elb::CacheBatchRptReq req;
     req.ParseFromArray(data, len);//解包，data[0:len)保证是一个完整包
     //report to route
     RouteLB* ptrRouteLB = (RouteLB*)usrData;
     ptrRouteLB->batchReport(req);
+    statRequest(STAT_BATCH_REPORT, begin);
+}
+
+static void agentStats(const char* data, uint32_t len, int msgid, net_commu* commu, void* usrData)
+{
+    uint64_t begin = statNowUs();
+    std::string text;
+    dumpStats(text, MSG_LENGTH_LIMIT);
+    commu->send_data(text.data(), text.size(), elb::AgentStatsRspId);//回复消息
+    statRequest(STAT_OTHER_MSG, begin);
+}
+
+static void foldReport(event_loop* loop, void* usrData)
+{
+    RouteLB* ptrRouteLB = (RouteLB*)usrData;
+    ptrRouteLB->foldPending();
+}
+
+static void lbTick(event_loop* loop, void* usrData)
+{
+    RouteLB* ptrRouteLB = (RouteLB*)usrData;
+    ptrRouteLB->tick();
+}
+
+static void probeTick(event_loop* loop, void* usrData)
+{
+    Prober* prober = (Prober*)usrData;
+    prober->tick();
 }
 
 static void persistRoute(event_loop* loop, void* usrData)
@@ -81,6 +216,7 @@ static void persistRoute(event_loop* loop, void* usrData)
 static void* initUDPServerIns(void* portPtr)
 {
     short port = *((short*)portPtr);
+    bindStats(STAT_UDP0 + port - 8888);
     event_loop loop;
     udp_server server(&loop, "127.0.0.1", port);//创建UDP服务器
 
@@ -89,15 +225,33 @@ static void* initUDPServerIns(void* portPtr)
     server.add_msg_cb(elb::GetRouteByToolReqId, getRouteByTool, routeLB[port - 8888]);//设置：当收到消息id = GetRouteByToolReqId的消息调用的回调函数getRouteByTool
     server.add_msg_cb(elb::CacheGetRouteReqId, cacheGetRoute, routeLB[port - 8888]);//设置：当收到消息id = CacheGetRouteReqId的消息调用的回调函数cacheGetRoute
     server.add_msg_cb(elb::CacheBatchRptReqId, batchReport, routeLB[port - 8888]);//设置：当收到消息id = CacheBatchRptReqId的消息调用的回调函数batchReport
+    server.add_msg_cb(elb::WireNegoReqId, wireNego, routeLB[port - 8888]);//设置：当收到消息id = WireNegoReqId的消息调用的回调函数wireNego
+    server.add_msg_cb(elb::FixGetHostReqId, getHostFixed, routeLB[port - 8888]);//设置：当收到消息id = FixGetHostReqId的消息调用的回调函数getHostFixed
+    server.add_msg_cb(elb::FixGetHostKeyReqId, getHostKeyFixed, routeLB[port - 8888]);//设置：当收到消息id = FixGetHostKeyReqId的消息调用的回调函数getHostKeyFixed
+    server.add_msg_cb(elb::FixReportReqId, reportStatusFixed, routeLB[port - 8888]);//设置：当收到消息id = FixReportReqId的消息调用的回调函数reportStatusFixed
+    server.add_msg_cb(elb::AgentStatsReqId, agentStats, routeLB[port - 8888]);//设置：当收到消息id = AgentStatsReqId的消息调用的回调函数agentStats
+    routeLB[port - 8888]->setNotifyFd(server.get_fd());//设置：订阅了路由变化的api从此fd收到推送
 
     loop.run_every(persistRoute, routeLB[port - 8888], 60);//设置：每隔60s将本地已拉到的路由持久化到磁盘
+    loop.run_every(lbTick, routeLB[port - 8888], 1);//设置：每秒推进一次LB时间轮
+    int foldMs = routeLB[port - 8888]->foldInterval();
+    if (foldMs > 0)
+        loop.run_every(foldReport, routeLB[port - 8888], foldMs / 1000, foldMs % 1000);//设置：周期性将暂存的调用结果合并进LB算法
+    Prober* prober = NULL;
+    if (routeLB[port - 8888]->activeProbe())
+    {
+        prober = new Prober(&loop, routeLB[port - 8888]);
+        loop.run_every(probeTick, prober, 0, 100);//设置：每100ms检查一次主动探测的超时与探测周期
+    }
 
     loop.process_evs();
+    delete prober;
     return NULL;
 }
 
 void initUDPServers()
 {
+    fixedCodecOn = config_reader::ins()->GetNumber("wire", "fixed_codec", 1) != 0;
     static short ports[3] = {8888, 8889, 8890};
     for (int i = 0;i < 3; ++i)
     {
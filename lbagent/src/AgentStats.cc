@@ -0,0 +1,202 @@
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+#include <algorithm>
+#include "log.h"
+#include "Server.h"
+#include "AgentStats.h"
+#include "easy_reactor.h"
+
+ThreadStats threadStats[STAT_THREADS];
+__thread ThreadStats* curStats = NULL;
+
+static std::string dumpFile;
+static long startTs = 0;
+
+static const char* threadNames[STAT_THREADS] = {"udp0", "udp1", "udp2", "dss", "rpt", "other"};
+static const char* msgNames[STAT_MSG_TYPES] = {"get_host", "report", "batch_report", "cache_route", "tool_route", "other"};
+
+void initStats()
+{
+    dumpFile = config_reader::ins()->GetString("stats", "dump_file", "");
+    startTs = MONO_SEC();
+}
+
+void bindStats(int thread)
+{
+    curStats = &threadStats[thread];
+}
+
+//每个线程一行的计数器
+static void appendPerThread(StatText& out, const char* name, const char* help, uint64_t ThreadStats::*field)
+{
+    out.head(name, "counter", help);
+    for (int t = 0;t < STAT_THREADS; ++t)
+        out.line("%s{thread=\"%s\"} %lu\n", name, threadNames[t], (unsigned long)statLoad(threadStats[t].*field));
+}
+
+static uint64_t sumAll(uint64_t ThreadStats::*field)
+{
+    uint64_t sum = 0;
+    for (int t = 0;t < STAT_THREADS; ++t)
+        sum += statLoad(threadStats[t].*field);
+    return sum;
+}
+
+static bool modStatGreater(const ModStat& a, const ModStat& b)
+{
+    return a.overloads > b.overloads;
+}
+
+void dumpStats(std::string& text, size_t limit)
+{
+    text.clear();
+    StatText out(text);
+    out.head("elb_agent_uptime_seconds", "gauge", "Seconds since the agent started");
+    out.line("elb_agent_uptime_seconds %ld\n", MONO_SEC() - startTs);
+    out.head("elb_agent_log_dropped_total", "counter", "Log messages dropped because a log buffer was full");
+    out.line("elb_agent_log_dropped_total %lu\n", _log_dropped_());
+
+    out.head("elb_agent_requests_total", "counter", "Requests handled by the UDP servers");
+    for (int t = STAT_UDP0;t <= STAT_UDP2; ++t)
+    {
+        for (int m = 0;m < STAT_MSG_TYPES; ++m)
+            out.line("elb_agent_requests_total{thread=\"%s\",msg=\"%s\"} %lu\n", threadNames[t], msgNames[m],
+                (unsigned long)statLoad(threadStats[t].msgs[m]));
+    }
+    //处理耗时按消息类型汇总所有UDP线程，控制导出的行数
+    out.head("elb_agent_request_seconds", "histogram", "Time spent handling a request in the UDP server");
+    for (int m = 0;m < STAT_MSG_TYPES; ++m)
+    {
+        StatHist hist;
+        ::memset(&hist, 0, sizeof hist);
+        for (int t = STAT_UDP0;t <= STAT_UDP2; ++t)
+            hist.merge(threadStats[t].msgUs[m]);
+        char labels[64];
+        snprintf(labels, sizeof labels, "msg=\"%s\"", msgNames[m]);
+        out.hist("elb_agent_request_seconds", labels, hist);
+    }
+
+    out.head("elb_agent_get_host_total", "counter", "GetHost results: success, all hosts overloaded, module not cached locally");
+    for (int t = STAT_UDP0;t <= STAT_UDP2; ++t)
+    {
+        out.line("elb_agent_get_host_total{thread=\"%s\",ret=\"success\"} %lu\n", threadNames[t], (unsigned long)statLoad(threadStats[t].hostSucc));
+        out.line("elb_agent_get_host_total{thread=\"%s\",ret=\"overload\"} %lu\n", threadNames[t], (unsigned long)statLoad(threadStats[t].hostOverload));
+        out.line("elb_agent_get_host_total{thread=\"%s\",ret=\"noexist\"} %lu\n", threadNames[t], (unsigned long)statLoad(threadStats[t].hostNoexist));
+    }
+    out.head("elb_agent_cache_route_total", "counter", "API cache route requests: version unchanged (hit) or full route sent (miss)");
+    for (int t = STAT_UDP0;t <= STAT_UDP2; ++t)
+    {
+        out.line("elb_agent_cache_route_total{thread=\"%s\",result=\"hit\"} %lu\n", threadNames[t], (unsigned long)statLoad(threadStats[t].cacheHit));
+        out.line("elb_agent_cache_route_total{thread=\"%s\",result=\"miss\"} %lu\n", threadNames[t], (unsigned long)statLoad(threadStats[t].cacheMiss));
+    }
+
+    appendPerThread(out, "elb_agent_lock_contended_total", "RouteLB mutex acquisitions that had to wait", &ThreadStats::lockContended);
+    out.head("elb_agent_lock_wait_seconds", "histogram", "Time spent waiting for a contended RouteLB mutex");
+    for (int t = 0;t < STAT_THREADS; ++t)
+    {
+        char labels[64];
+        snprintf(labels, sizeof labels, "thread=\"%s\"", threadNames[t]);
+        out.hist("elb_agent_lock_wait_seconds", labels, threadStats[t].lockWaitUs);
+    }
+    appendPerThread(out, "elb_agent_fold_runs_total", "Pending call result runs folded into the LB state", &ThreadStats::foldRuns);
+    appendPerThread(out, "elb_agent_host_overload_total", "Host transitions from idle to overload", &ThreadStats::toOverload);
+    appendPerThread(out, "elb_agent_host_idle_total", "Host transitions from overload to idle", &ThreadStats::toIdle);
+
+    //位置命中率：rack、idc占全部的比例
+    static const char* localityNames[STAT_LOCALITIES] = {"rack", "idc", "remote"};
+    out.head("elb_agent_locality_picks_total", "counter", "Idle hosts handed out by the agent, by host locality relative to this agent");
+    for (int l = 0;l < STAT_LOCALITIES; ++l)
+    {
+        uint64_t n = 0;
+        for (int t = 0;t < STAT_THREADS; ++t)
+            n += statLoad(threadStats[t].localPicks[l]);
+        out.line("elb_agent_locality_picks_total{locality=\"%s\"} %lu\n", localityNames[l], (unsigned long)n);
+    }
+    out.head("elb_agent_locality_calls_total", "counter", "Reported call results, including API cache traffic, by host locality");
+    for (int l = 0;l < STAT_LOCALITIES; ++l)
+    {
+        uint64_t n = 0;
+        for (int t = 0;t < STAT_THREADS; ++t)
+            n += statLoad(threadStats[t].localCalls[l]);
+        out.line("elb_agent_locality_calls_total{locality=\"%s\"} %lu\n", localityNames[l], (unsigned long)n);
+    }
+    out.head("elb_agent_locality_spills_total", "counter", "Picks that spilled to a wider locality because nearer idle hosts were too few or overloaded");
+    out.line("elb_agent_locality_spills_total %lu\n", (unsigned long)sumAll(&ThreadStats::localSpills));
+
+    //生产者、消费者各自计数，读到的两个值不是同一时刻的，差值可能短暂为负
+    uint64_t pullEnq = sumAll(&ThreadStats::pullEnq), pullDeq = sumAll(&ThreadStats::pullDeq);
+    uint64_t reptEnq = sumAll(&ThreadStats::reptEnq), reptDeq = sumAll(&ThreadStats::reptDeq);
+    out.head("elb_agent_queue_enqueued_total", "counter", "Messages put into the inter-thread queues");
+    out.line("elb_agent_queue_enqueued_total{queue=\"pull\"} %lu\n", (unsigned long)pullEnq);
+    out.line("elb_agent_queue_enqueued_total{queue=\"report\"} %lu\n", (unsigned long)reptEnq);
+    out.head("elb_agent_queue_depth", "gauge", "Messages waiting in the inter-thread queues");
+    out.line("elb_agent_queue_depth{queue=\"pull\"} %lu\n", (unsigned long)(pullEnq > pullDeq? pullEnq - pullDeq: 0));
+    out.line("elb_agent_queue_depth{queue=\"report\"} %lu\n", (unsigned long)(reptEnq > reptDeq? reptEnq - reptDeq: 0));
+
+    out.head("elb_agent_dss_connects_total", "counter", "Connections (and reconnections) to dnsserver");
+    out.line("elb_agent_dss_connects_total %lu\n", (unsigned long)sumAll(&ThreadStats::dssConnects));
+    out.head("elb_agent_dss_routes_total", "counter", "Module routes received from dnsserver");
+    out.line("elb_agent_dss_routes_total %lu\n", (unsigned long)sumAll(&ThreadStats::dssRoutes));
+    out.head("elb_agent_dss_hosts_total", "counter", "Hosts received from dnsserver");
+    out.line("elb_agent_dss_hosts_total %lu\n", (unsigned long)sumAll(&ThreadStats::dssHosts));
+    out.head("elb_agent_subset_skipped_hosts_total", "counter", "Hosts received from dnsserver but left out of this agent's subset of a large module");
+    out.line("elb_agent_subset_skipped_hosts_total %lu\n", (unsigned long)sumAll(&ThreadStats::subsetSkipped));
+    out.head("elb_agent_reporter_reqs_total", "counter", "Status reports sent to reporter");
+    out.line("elb_agent_reporter_reqs_total %lu\n", (unsigned long)sumAll(&ThreadStats::rptReqs));
+    out.head("elb_agent_reporter_results_total", "counter", "Host call results sent to reporter");
+    out.line("elb_agent_reporter_results_total %lu\n", (unsigned long)sumAll(&ThreadStats::rptResults));
+
+    //模块明细放在最后：只导出累计过载次数最多的STAT_TOP_MODS个
+    std::vector<ModStat> mods;
+    for (int i = 0;i < 3; ++i)
+    {
+        if (routeLB[i])
+            routeLB[i]->getModStats(mods);
+    }
+    size_t top = std::min(mods.size(), (size_t)STAT_TOP_MODS);
+    std::partial_sort(mods.begin(), mods.begin() + top, mods.end(), modStatGreater);
+    out.head("elb_agent_modules", "gauge", "Modules cached by the agent");
+    out.line("elb_agent_modules %lu\n", (unsigned long)mods.size());
+    out.head("elb_agent_module_overload_total", "counter", "Host overload transitions of a module (top modules only)");
+    for (size_t i = 0;i < top && mods[i].overloads; ++i)
+        out.line("elb_agent_module_overload_total{modid=\"%d\",cmdid=\"%d\"} %u\n", mods[i].modid, mods[i].cmdid, mods[i].overloads);
+    out.head("elb_agent_module_down_hosts", "gauge", "Hosts currently overloaded in a module (top modules only)");
+    for (size_t i = 0;i < top && mods[i].overloads; ++i)
+        out.line("elb_agent_module_down_hosts{modid=\"%d\",cmdid=\"%d\"} %u\n", mods[i].modid, mods[i].cmdid, mods[i].downs);
+    out.head("elb_agent_module_succ_cost_ms_sum", "counter", "Total latency of successful calls that carried a cost (top modules only)");
+    for (size_t i = 0;i < top; ++i)
+        if (mods[i].succCostCnt)
+            out.line("elb_agent_module_succ_cost_ms_sum{modid=\"%d\",cmdid=\"%d\"} %lu\n", mods[i].modid, mods[i].cmdid, (unsigned long)mods[i].succCostSum);
+    out.head("elb_agent_module_succ_cost_count", "counter", "Successful calls that carried a cost (top modules only)");
+    for (size_t i = 0;i < top; ++i)
+        if (mods[i].succCostCnt)
+            out.line("elb_agent_module_succ_cost_count{modid=\"%d\",cmdid=\"%d\"} %lu\n", mods[i].modid, mods[i].cmdid, (unsigned long)mods[i].succCostCnt);
+
+    if (limit)
+        out.truncate(limit);
+}
+
+void dumpStatsFile()
+{
+    if (dumpFile.empty())
+        return ;
+    std::string text;
+    dumpStats(text);
+    std::string tmp = dumpFile + ".tmp";
+    FILE* fp = ::fopen(tmp.c_str(), "w");
+    if (!fp)
+    {
+        log_error("open %s failed: %s", tmp.c_str(), strerror(errno));
+        return ;
+    }
+    bool ok = ::fwrite(text.data(), 1, text.size(), fp) == text.size();
+    ok = ::fclose(fp) == 0 && ok;
+    if (!ok || ::rename(tmp.c_str(), dumpFile.c_str()) == -1)
+    {
+        log_error("write %s failed: %s", dumpFile.c_str(), strerror(errno));
+        ::unlink(tmp.c_str());
+    }
+}
@@ -2,6 +2,7 @@
 #include <queue>
 #include "elb.pb.h"
 #include "Server.h"
+#include "AgentStats.h"
 #include "easy_reactor.h"
 
 static void recvRoute(const char* data, uint32_t len, int msgid, net_commu* commu, void* usr_data)
@@ -11,6 +12,8 @@ static void recvRoute(const char* data, uint32_t len, int msgid, net_commu* comm
     int modid = rsp.modid();
     int cmdid = rsp.cmdid();
     int index = (modid + cmdid) % 3;
+    statAdd(myStats()->dssRoutes);
+    statAdd(myStats()->dssHosts, rsp.hosts_size());
     //update metadata
     routeLB[index]->update(modid, cmdid, rsp);
 }
@@ -20,6 +23,7 @@ static void newPullReq(event_loop* loop, int fd, void *args)
     tcp_client* cli = (tcp_client*)args;
     std::queue<elb::GetRouteReq> msgs;
     pullQueue->recv_msg(msgs);
+    statAdd(myStats()->pullDeq, msgs.size());
     while (!msgs.empty())
     {
         elb::GetRouteReq req = msgs.front();
@@ -30,16 +34,46 @@ static void newPullReq(event_loop* loop, int fd, void *args)
     }
 }
 
+//单个批量拉取请求序列化后的长度上限，留出余量保证不超过消息长度上限
+#define PULL_BATCH_BYTES (MSG_LENGTH_LIMIT - 1024)
+
 static void whenConnected(tcp_client* client, void* args)
 {
+    statAdd(myStats()->dssConnects);
     for (int i = 0;i < 3; ++i)
         routeLB[i]->clearPulling();
+    //启动时用落地路由预热的mod，连上dnsserver后批量刷新
+    elb::GetRouteBatchReq warm;
+    for (int i = 0;i < 3; ++i)
+        routeLB[i]->pullWarm(warm);
+    //按累计的序列化长度分批：负数的modid/cmdid编码为10字节varint，单个mod的长度不固定
+    int begin = 0;
+    while (begin < warm.reqs_size())
+    {
+        elb::GetRouteBatchReq batch;
+        int bytes = 0;
+        for (;begin < warm.reqs_size(); ++begin)
+        {
+            //每个元素另有1字节tag与至多5字节的长度前缀
+            int itemBytes = warm.reqs(begin).ByteSize() + 6;
+            if (batch.reqs_size() && bytes + itemBytes > PULL_BATCH_BYTES)
+                break;
+            batch.add_reqs()->CopyFrom(warm.reqs(begin));
+            bytes += itemBytes;
+        }
+        std::string reqStr;
+        batch.SerializeToString(&reqStr);
+        client->send_data(reqStr.c_str(), reqStr.size(), elb::GetRouteBatchByAgentReqId);//发送消息
+    }
+    if (warm.reqs_size())
+        log_info("pull %d warm started mods from dnsserver", warm.reqs_size());
 }
 
 void dssConnectorDomain(event_loop& loop)
 {
     const char* dssIp = config_reader::ins()->GetString("dnsserver", "ip", "").c_str();
     short dssPort = config_reader::ins()->GetNumber("dnsserver", "port", 0);
+    bindStats(STAT_DSS);
     tcp_client client(&loop, dssIp, dssPort, "dnsserver");//创建TCP客户端
 
     //设置：当收到消息id=1的消息时的回调函数
@@ -0,0 +1,139 @@
+#include <set>
+#include <errno.h>
+#include <fcntl.h>
+#include <algorithm>
+#include <unistd.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include "log.h"
+#include "Prober.h"
+#include "coarseClock.h"
+
+Prober::Prober(event_loop* loop, RouteLB* routeLB):
+    _loop(loop),
+    _routeLB(routeLB),
+    _lstRound(0)
+{
+    ::memset(&_cursor, 0, sizeof _cursor);
+    _interval    = config_reader::ins()->GetNumber("probe", "interval", 1000);
+    _timeout     = config_reader::ins()->GetNumber("probe", "timeout", 300);
+    _maxInflight = config_reader::ins()->GetNumber("probe", "max_inflight", 256);
+    if (_interval <= 0)
+        _interval = 1000;
+    //保证新一轮开始前上一轮的探测都已结束，同一节点不会同时有两个探测
+    if (_timeout <= 0 || _timeout > _interval)
+        _timeout = _interval;
+}
+
+void Prober::tick()
+{
+    uint64_t now = MONO_MSEC();
+    //超时未连上的按失败处理
+    std::vector<int> expired;
+    for (__gnu_cxx::hash_map<int, Probe>::iterator it = _inflight.begin();it != _inflight.end(); ++it)
+    {
+        if (it->second.deadline <= now)
+            expired.push_back(it->first);
+    }
+    for (size_t i = 0;i < expired.size(); ++i)
+        finish(expired[i], false);
+
+    if (now - _lstRound >= (uint64_t)_interval)
+    {
+        _lstRound = now;
+        startRound();
+    }
+}
+
+//探测目标的全序：先模块后节点
+static std::pair<uint64_t, uint64_t> targetKey(const ProbeTarget& t)
+{
+    return std::make_pair(((uint64_t)(uint32_t)t.modid << 32) + (uint32_t)t.cmdid, ((uint64_t)t.ip << 32) + (uint32_t)t.port);
+}
+
+static bool targetLess(const ProbeTarget& a, const ProbeTarget& b)
+{
+    return targetKey(a) < targetKey(b);
+}
+
+void Prober::startRound()
+{
+    std::vector<ProbeTarget> targets;
+    _routeLB->getProbeTargets(targets);
+    if (targets.empty())
+        return ;
+    //按全序排列，从上一轮最后探测的目标之后接着轮转：overload节点多于max_inflight时每轮探测不同的一批，都能轮到
+    std::sort(targets.begin(), targets.end(), targetLess);
+    size_t start = std::upper_bound(targets.begin(), targets.end(), _cursor, targetLess) - targets.begin();
+    //仍在进行中的探测不重复发起
+    std::set<std::pair<uint64_t, uint64_t> > busy;
+    for (__gnu_cxx::hash_map<int, Probe>::iterator it = _inflight.begin();it != _inflight.end(); ++it)
+        busy.insert(targetKey(it->second.target));
+    uint64_t now = MONO_MSEC();
+    for (size_t i = 0;i < targets.size() && (int)_inflight.size() < _maxInflight; ++i)
+    {
+        const ProbeTarget& target = targets[(start + i) % targets.size()];
+        if (busy.count(targetKey(target)))
+            continue;
+        _cursor = target;
+        startProbe(target, now);
+    }
+}
+
+void Prober::startProbe(const ProbeTarget& target, uint64_t now)
+{
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_TCP);
+    if (fd == -1)
+    {
+        log_error("probe socket() error: %s", strerror(errno));
+        return ;
+    }
+    struct sockaddr_in addr;
+    ::memset(&addr, 0, sizeof addr);
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = target.ip;//与API一致，ip即网络序的s_addr
+    addr.sin_port = htons(target.port);
+
+    Probe probe;
+    probe.target = target;
+    probe.deadline = now + _timeout;
+    _inflight[fd] = probe;
+
+    int ret = ::connect(fd, (const struct sockaddr*)&addr, sizeof addr);
+    if (ret == 0)
+    {
+        finish(fd, true);
+    }
+    else if (errno == EINPROGRESS)
+    {
+        //连接建立或失败时可写，在onWritable中取结果
+        _loop->add_ioev(fd, onWritable, EPOLLOUT, this);
+    }
+    else
+    {
+        finish(fd, false);
+    }
+}
+
+void Prober::onWritable(event_loop* loop, int fd, void* args)
+{
+    Prober* prober = (Prober*)args;
+    int err = 0;
+    socklen_t len = sizeof err;
+    if (::getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) == -1)
+        err = errno;
+    prober->finish(fd, err == 0);
+}
+
+void Prober::finish(int fd, bool ok)
+{
+    __gnu_cxx::hash_map<int, Probe>::iterator it = _inflight.find(fd);
+    if (it == _inflight.end())
+        return ;
+    ProbeTarget target = it->second.target;
+    _inflight.erase(it);
+    _loop->del_ioev(fd);
+    ::close(fd);
+    _routeLB->probeResult(target.modid, target.cmdid, target.ip, target.port, ok);
+}
@@ -0,0 +1,129 @@
+#include <errno.h>
+#include <stdio.h>
+#include <time.h>
+#include <sys/uio.h>
+#include "log.h"
+#include "RouteBackup.h"
+
+static bool writeAll(int fd, const void* data, size_t len)
+{
+    const char* p = (const char*)data;
+    while (len > 0)
+    {
+        ssize_t n = ::write(fd, p, len);
+        if (n == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+//写tmp文件后rename为path
+static bool writeFileAtomic(const char* path, const struct iovec* iov, int iovcnt)
+{
+    char tmpPath[256];
+    snprintf(tmpPath, sizeof tmpPath, "%s.tmp", path);
+    int fd = ::open(tmpPath, O_CREAT | O_TRUNC | O_WRONLY, 0666);
+    if (fd == -1)
+    {
+        log_error("open %s error: %s", tmpPath, strerror(errno));
+        return false;
+    }
+    bool ok = true;
+    for (int i = 0;i < iovcnt && ok; ++i)
+        ok = writeAll(fd, iov[i].iov_base, iov[i].iov_len);
+    ::close(fd);
+    if (!ok)
+    {
+        log_error("write %s error: %s", tmpPath, strerror(errno));
+        ::unlink(tmpPath);
+        return false;
+    }
+    if (::rename(tmpPath, path) == -1)
+    {
+        log_error("rename %s to %s error: %s", tmpPath, path, strerror(errno));
+        ::unlink(tmpPath);
+        return false;
+    }
+    return true;
+}
+
+bool writeRouteBackup(const char* path, uint32_t generation, const std::vector<BackupModule>& modules,
+    const std::vector<BackupHost>& hosts)
+{
+    BackupHeader hdr;
+    ::memset(&hdr, 0, sizeof hdr);
+    hdr.magic = BACKUP_MAGIC;
+    hdr.version = BACKUP_VERSION;
+    hdr.modCnt = modules.size();
+    hdr.hostCnt = hosts.size();
+    hdr.generation = generation;
+    hdr.ts = time(NULL);
+    uint32_t sum = 2166136261u;
+    if (!modules.empty())
+        sum = backupChecksum(&modules[0], modules.size() * sizeof(BackupModule), sum);
+    if (!hosts.empty())
+        sum = backupChecksum(&hosts[0], hosts.size() * sizeof(BackupHost), sum);
+    hdr.checksum = sum;
+
+    struct iovec iov[3];
+    iov[0].iov_base = &hdr;
+    iov[0].iov_len = sizeof hdr;
+    iov[1].iov_base = modules.empty()? NULL: (void*)&modules[0];
+    iov[1].iov_len = modules.size() * sizeof(BackupModule);
+    iov[2].iov_base = hosts.empty()? NULL: (void*)&hosts[0];
+    iov[2].iov_len = hosts.size() * sizeof(BackupHost);
+    if (!writeFileAtomic(path, iov, 3))
+        return false;
+
+    //新generation的空journal；在它替换旧journal之前，旧journal因generation不符而被读者忽略
+    JournalHeader jhdr;
+    ::memset(&jhdr, 0, sizeof jhdr);
+    jhdr.magic = BACKUP_MAGIC;
+    jhdr.version = BACKUP_VERSION;
+    jhdr.generation = generation;
+    std::string jpath = std::string(path) + JOURNAL_SUFFIX;
+    iov[0].iov_base = &jhdr;
+    iov[0].iov_len = sizeof jhdr;
+    return writeFileAtomic(jpath.c_str(), iov, 1);
+}
+
+bool appendRouteJournal(const char* path, const std::vector<BackupModule>& modules,
+    const std::vector<BackupHost>& hosts)
+{
+    std::string buf;
+    for (size_t i = 0;i < modules.size(); ++i)
+    {
+        const BackupModule& mod = modules[i];
+        JournalRecord rec;
+        ::memset(&rec, 0, sizeof rec);
+        rec.key = mod.key;
+        rec.version = mod.version;
+        rec.count = mod.count;
+        const BackupHost* recHosts = mod.count? &hosts[mod.first]: NULL;
+        rec.checksum = journalChecksum(&rec, recHosts);
+        buf.append((const char*)&rec, sizeof rec);
+        if (mod.count)
+            buf.append((const char*)recHosts, mod.count * sizeof(BackupHost));
+    }
+    if (buf.empty())
+        return true;
+
+    std::string jpath = std::string(path) + JOURNAL_SUFFIX;
+    int fd = ::open(jpath.c_str(), O_WRONLY | O_APPEND);
+    if (fd == -1)
+    {
+        log_error("open %s error: %s", jpath.c_str(), strerror(errno));
+        return false;
+    }
+    bool ok = writeAll(fd, buf.data(), buf.size());
+    if (!ok)
+        log_error("append %s error: %s", jpath.c_str(), strerror(errno));
+    ::close(fd);
+    return ok;
+}
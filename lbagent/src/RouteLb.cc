@@ -1,13 +1,19 @@
 #include <set>
+#include <algorithm>
+#include <functional>
 #include <stdio.h>
 #include <netdb.h>
 #include <assert.h>
 #include <stdlib.h>
 #include <arpa/inet.h>
+#include <sys/socket.h>
 #include "log.h"
 #include "Server.h"
 #include "RouteLb.h"
+#include "AgentStats.h"
+#include "RouteBackup.h"
 #include "easy_reactor.h"
+#include "coarseClock.h"
 
 struct LbConfigure
 {
@@ -24,10 +30,181 @@ struct LbConfigure
     float errRate;     //当idle节点（虚拟）失败率高于此值，节点变overload
     float windErrRate; //整个窗口的真实失败率阈值
     int windErrLim;    //连续N个窗口真实失败率高于windErrRate, 如果N>=windErrLim，强行认为节点过载
+    int foldInterval;  //UDP线程暂存的调用结果多久合并进LB算法一次,ms; 0表示不暂存
+    int foldPendLim;   //暂存的游程个数达到此值时立即合并
+    bool activeProbe;  //是否由agent主动探测overload节点；开启后不再拿API请求试探overload节点
+    int journalCompactLim;//路由落地journal的记录数超过此值时全量重写
+    bool warmStart;    //启动时是否用上次落地的路由预热
+    long cacheSubLease;//API cache对某mod的订阅多久不续订即失效,s
+    long transLogInterval;//节点状态转换按周期聚合输出日志、上报reporter,s
+    int transLogLimit; //每个周期至多输出多少个节点的状态转换日志，其余只输出汇总
+    int hashPolicy;    //未在[hash] mods中单独配置的模块按key获取节点时的一致性哈希策略，默认none：按key路由由模块单独开启
+    int ringVnodes;    //哈希环每节点的虚节点数
+    int maglevSize;    //Maglev查找表大小
+    uint32_t myIdc;    //本agent所在机房、机架的编号，myIdc为0表示不按位置偏好选取节点
+    uint32_t myRack;
+    int localMin;      //同机架、同机房的idle节点至少有几个才只在其中轮询
+    int spillPct;      //同机架、同机房的idle节点占其全部节点的百分比低于此值时放宽到更大范围
+    int subsetSize;    //节点多于此值的模块只跟踪其中此数目的节点（子集），0表示不划分子集
+    uint32_t subsetSeed;//选取子集的种子，各agent须不同，0表示用本机ip
 } LbConfig;
 
 static uint32_t MyIp = 0;
 
+//告知API cache的overload节点个数上限：每个节点序列化后至多约20字节（负数ip为10字节varint），保证消息不超过MSG_LENGTH_LIMIT
+#define CACHE_DOWNS_LIMIT 2048
+
+//modid << 32 + cmdid -> 单独配置的一致性哈希策略
+static __gnu_cxx::hash_map<uint64_t, int> hashMods;
+
+//策略名 -> HASH_POLICY，不认识的返回-1
+static int parseHashPolicy(const std::string& name)
+{
+    if (name == "maglev")
+        return HASH_MAGLEV;
+    if (name == "ring")
+        return HASH_RING;
+    if (name == "none")
+        return HASH_NONE;
+    return -1;
+}
+
+//解析[hash] mods：逗号分隔的modid:cmdid:policy
+static void loadHashMods(const std::string& conf)
+{
+    size_t begin = 0;
+    while (begin < conf.size())
+    {
+        size_t end = conf.find(',', begin);
+        if (end == std::string::npos)
+            end = conf.size();
+        std::string item = conf.substr(begin, end - begin);
+        begin = end + 1;
+        int modid, cmdid;
+        char name[32];
+        if (::sscanf(item.c_str(), " %d:%d:%31[a-z]", &modid, &cmdid, name) != 3 || parseHashPolicy(name) < 0)
+        {
+            if (item.find_first_not_of(" \t") != std::string::npos)
+                log_error("[hash] mods: bad item \"%s\", ignored", item.c_str());
+            continue;
+        }
+        hashMods[((uint64_t)modid << 32) + cmdid] = parseHashPolicy(name);
+    }
+}
+
+//此模块按key获取节点时的策略及其参数
+static int hashPolicyOf(uint64_t mod, int& param)
+{
+    int policy = LbConfig.hashPolicy;
+    __gnu_cxx::hash_map<uint64_t, int>::iterator it = hashMods.find(mod);
+    if (it != hashMods.end())
+        policy = it->second;
+    param = policy == HASH_RING? LbConfig.ringVnodes: LbConfig.maglevSize;
+    return policy;
+}
+
+//modid << 32 + cmdid -> 单独配置的子集大小
+static __gnu_cxx::hash_map<uint64_t, int> subsetMods;
+
+//解析[subset] mods：逗号分隔的modid:cmdid:size，size为0表示此模块不划分子集
+static void loadSubsetMods(const std::string& conf)
+{
+    size_t begin = 0;
+    while (begin < conf.size())
+    {
+        size_t end = conf.find(',', begin);
+        if (end == std::string::npos)
+            end = conf.size();
+        std::string item = conf.substr(begin, end - begin);
+        begin = end + 1;
+        int modid, cmdid, size;
+        if (::sscanf(item.c_str(), " %d:%d:%d", &modid, &cmdid, &size) != 3 || size < 0)
+        {
+            if (item.find_first_not_of(" \t") != std::string::npos)
+                log_error("[subset] mods: bad item \"%s\", ignored", item.c_str());
+            continue;
+        }
+        int param;
+        uint64_t mod = ((uint64_t)modid << 32) + cmdid;
+        if (size > 0 && hashPolicyOf(mod, param) != HASH_NONE)
+            log_error("[subset] mods: %d:%d is routed by key (hash policy not none), not subsetted", modid, cmdid);
+        subsetMods[mod] = size;
+    }
+}
+
+//此模块的子集大小，0表示跟踪全部节点
+//按key获取节点的模块（一致性哈希策略不为none，包括未单独配置、按[hash] policy的模块）一律不划分子集：
+//各agent的子集不同，同一key会落到不同节点
+static int subsetSizeOf(uint64_t mod)
+{
+    int param;
+    if (hashPolicyOf(mod, param) != HASH_NONE)
+        return 0;
+    __gnu_cxx::hash_map<uint64_t, int>::iterator it = subsetMods.find(mod);
+    if (it != subsetMods.end())
+        return it->second;
+    return LbConfig.subsetSize;
+}
+
+//从路由中选出本agent跟踪的节点：rendezvous hashing，每个节点与本机ip一起打分，取分数最高的size个
+//同一agent每次选出的子集相同；节点增删时只有被删的、或分数挤进前size的新节点进出子集，其余不变
+//各agent的种子（[subset] seed或本机ip）不同，每个节点被约size/n的agent选中
+static void subsetHosts(uint64_t mod, const elb::GetRouteRsp& rsp, std::vector<const elb::HostAddr*>& hosts)
+{
+    int n = rsp.hosts_size();
+    int size = subsetSizeOf(mod);
+    hosts.clear();
+    if (size <= 0 || n <= size)
+    {
+        hosts.reserve(n);
+        for (int i = 0;i < n; ++i)
+            hosts.push_back(&rsp.hosts(i));
+        return ;
+    }
+    uint64_t seed = hashMix((uint64_t)LbConfig.subsetSeed ^ 0x7375627365740000ULL);
+    std::vector<std::pair<uint64_t, int> > scores(n);
+    for (int i = 0;i < n; ++i)
+    {
+        const elb::HostAddr& h = rsp.hosts(i);
+        scores[i] = std::make_pair(hashMix((((uint64_t)h.ip() << 32) + h.port()) ^ seed), i);
+    }
+    std::nth_element(scores.begin(), scores.begin() + size, scores.end(), std::greater<std::pair<uint64_t, int> >());
+    hosts.reserve(size);
+    for (int i = 0;i < size; ++i)
+        hosts.push_back(&rsp.hosts(scores[i].second));
+    statAdd(myStats()->subsetSkipped, n - size);
+}
+
+//节点相对本agent的位置
+static int hostLocality(const elb::HostAddr& h)
+{
+    if (!LbConfig.myIdc || h.idc() != LbConfig.myIdc)
+        return LOC_REMOTE;
+    if (LbConfig.myRack && h.rack() == LbConfig.myRack)
+        return LOC_RACK;
+    return LOC_IDC;
+}
+
+typedef char LocTiersCheck[LOC_TIERS == STAT_LOCALITIES? 1: -1];
+
+//在CacheGetRouteRsp或CacheRouteNotify中给出各节点状态（overload节点及试探周期）
+//overload节点过多时不给出：api视为agent未提供节点状态，此模块有节点过载期间走网络获取节点
+template <typename Msg>
+static void fillHostState(LB* lb, int probeNum, Msg& msg)
+{
+    if (lb->downCnt() > CACHE_DOWNS_LIMIT)
+        return ;
+    msg.set_probenum(probeNum);
+    std::vector<std::pair<uint32_t, int> > downs;
+    lb->getDownHosts(downs);
+    for (size_t i = 0;i < downs.size(); ++i)
+    {
+        elb::HostAddr* host = msg.add_downs();
+        host->set_ip(downs[i].first);
+        host->set_port(downs[i].second);
+    }
+}
+
 static pthread_once_t onceLoad = PTHREAD_ONCE_INIT;
 
 static void initLbEnviro()
@@ -47,6 +224,38 @@ static void initLbEnviro()
 
     LbConfig.windErrRate   = config_reader::ins()->GetFloat("lb", "wind_err_rate", 0.7);
     LbConfig.windErrLim    = config_reader::ins()->GetNumber("lb", "wind_err_limit", 2);
+    LbConfig.foldInterval  = config_reader::ins()->GetNumber("lb", "fold_interval", 10);
+    LbConfig.foldPendLim   = config_reader::ins()->GetNumber("lb", "fold_pending_limit", 4096);
+    LbConfig.activeProbe   = config_reader::ins()->GetNumber("probe", "enable", 0) != 0;
+    LbConfig.journalCompactLim = config_reader::ins()->GetNumber("lb", "journal_compact_limit", 4096);
+    LbConfig.warmStart     = config_reader::ins()->GetNumber("lb", "warm_start", 1) != 0;
+    LbConfig.cacheSubLease = config_reader::ins()->GetNumber("lb", "cache_sub_lease", 180);
+    LbConfig.transLogInterval = config_reader::ins()->GetNumber("lb", "trans_log_interval", 10);
+    if (LbConfig.transLogInterval <= 0)
+        LbConfig.transLogInterval = 1;
+    LbConfig.transLogLimit = config_reader::ins()->GetNumber("lb", "trans_log_limit", 20);
+    std::string policy = config_reader::ins()->GetString("hash", "policy", "none");
+    LbConfig.hashPolicy = parseHashPolicy(policy);
+    if (LbConfig.hashPolicy < 0)
+    {
+        log_error("[hash] policy: unknown \"%s\", use none", policy.c_str());
+        LbConfig.hashPolicy = HASH_NONE;
+    }
+    LbConfig.ringVnodes    = config_reader::ins()->GetNumber("hash", "ring_vnodes", RING_DEFAULT_VNODES);
+    LbConfig.maglevSize    = config_reader::ins()->GetNumber("hash", "maglev_size", MAGLEV_DEFAULT_SIZE);
+    loadHashMods(config_reader::ins()->GetString("hash", "mods", ""));
+    LbConfig.myIdc         = config_reader::ins()->GetNumber("locality", "idc", 0);
+    LbConfig.myRack        = config_reader::ins()->GetNumber("locality", "rack", 0);
+    LbConfig.localMin      = config_reader::ins()->GetNumber("locality", "min_hosts", 2);
+    if (LbConfig.localMin <= 0)
+        LbConfig.localMin = 1;
+    LbConfig.spillPct      = config_reader::ins()->GetNumber("locality", "spill_pct", 50);
+    LbConfig.subsetSize    = config_reader::ins()->GetNumber("subset", "size", 0);
+    if (LbConfig.subsetSize < 0)
+        LbConfig.subsetSize = 0;
+    loadSubsetMods(config_reader::ins()->GetString("subset", "mods", ""));
+    if (LbConfig.subsetSize && LbConfig.hashPolicy != HASH_NONE)
+        log_error("[subset] size: [hash] policy is \"%s\", only modules set to none in [hash] mods are subsetted", policy.c_str());
 
     //get local IP
     char myhostname[1024];
@@ -66,6 +275,20 @@ static void initLbEnviro()
         ::inet_aton("127.0.0.1", &inaddr);
         MyIp = ntohl(inaddr.s_addr);
     }
+
+    //子集的种子：未配置时用本机ip；本机ip解析为回环地址（127.0.0.1、127.0.1.1等）时各agent的种子相同、
+    //选出同样的子集，整个模块的负载会集中在这几个节点上，此时不划分子集
+    LbConfig.subsetSeed    = config_reader::ins()->GetNumber("subset", "seed", 0);
+    if (!LbConfig.subsetSeed)
+    {
+        LbConfig.subsetSeed = MyIp;
+        if ((MyIp >> 24) == 127 && (LbConfig.subsetSize || !subsetMods.empty()))
+        {
+            log_error("[subset] local ip resolves to loopback and no seed is configured, subset disabled");
+            LbConfig.subsetSize = 0;
+            subsetMods.clear();
+        }
+    }
 }
 
 /**
@@ -94,7 +317,7 @@ void HI::resetIdle(uint32_t initSucc)
     continSucc = 0;
     continErr = 0;
     overload = false;
-    windowTs = time(NULL);//重置窗口时间
+    windowTs = MONO_SEC();//重置窗口时间
     overloadTs = 0;
     //windErrCnt = windErrCnt;保持不变即可
 }
@@ -108,12 +331,14 @@ void HI::setOverload(uint32_t overloadErr)
     continSucc = 0;
     continErr = 0;
     overload = true;
-    overloadTs = time(NULL);//设置被判定为overload的时刻
+    overloadTs = MONO_SEC();//设置被判定为overload的时刻
     windErrCnt = 0;
 }
 
 LB::~LB()
 {
+    if (_downs)
+        _downs->erase(((uint64_t)_modid << 32) + _cmdid);
     for (HostMapIt it = _hostMap.begin();it != _hostMap.end(); ++it)
     {
         HI* hi = it->second;
@@ -125,8 +350,8 @@ int LB::getHost(elb::GetHostRsp& rsp)
 {
     if (_runningList.empty())//此[modid, cmdid]已经过载了，即所有节点都已经过载
     {
-        //访问次数超过了probeNum，于是决定试探一次overload节点
-        if (_accessCnt >= LbConfig.probeNum)
+        //访问次数超过了probeNum，于是决定试探一次overload节点；开启主动探测时由agent自己探测，不再让API试探
+        if (!LbConfig.activeProbe && _accessCnt >= LbConfig.probeNum)
         {
             _accessCnt = 0;
             //选择一个overload节点
@@ -146,16 +371,14 @@ int LB::getHost(elb::GetHostRsp& rsp)
     }
     else
     {
-        if (_downList.empty())//此[modid, cmdid]完全正常
+        if (_downList.empty() || LbConfig.activeProbe)//此[modid, cmdid]完全正常，或overload节点交给主动探测
         {
             _accessCnt = 0;//重置访问次数，仅在有节点过载时才记录
             //选择一个idle节点
-            HI* hi = _runningList.front();
+            HI* hi = nextIdle();
             elb::HostAddr* hp = rsp.mutable_host();
             hp->set_ip(hi->ip);
             hp->set_port(hi->port);
-            _runningList.pop_front();
-            _runningList.push_back(hi);
         }
         else//有部分节点过载了
         {
@@ -175,18 +398,120 @@ int LB::getHost(elb::GetHostRsp& rsp)
             {
                 ++_accessCnt;
                 //选择一个idle节点
-                HI* hi = _runningList.front();
+                HI* hi = nextIdle();
                 elb::HostAddr* hp = rsp.mutable_host();
                 hp->set_ip(hi->ip);
                 hp->set_port(hi->port);
-                _runningList.pop_front();
-                _runningList.push_back(hi);
             }
         }
     }
     return SUCCESS;
 }
 
+HI* LB::nextIdle()
+{
+    std::list<HI*>* idle = &_runningList;
+    int tier = LOC_REMOTE, nearest = LOC_REMOTE;
+    for (int t = LOC_RACK;LbConfig.myIdc && t < LOC_REMOTE; ++t)
+    {
+        if (!_localHosts[t])
+            continue;
+        if (nearest == LOC_REMOTE)
+            nearest = t;
+        size_t n = _localList[t].size();
+        if ((int)n >= LbConfig.localMin && n * 100 >= (size_t)_localHosts[t] * LbConfig.spillPct)
+        {
+            idle = &_localList[t];
+            tier = t;
+            break;
+        }
+    }
+    HI* hi = idle->front();
+    idle->pop_front();
+    idle->push_back(hi);
+    ThreadStats* stats = myStats();
+    statAdd(stats->localPicks[hi->locality]);
+    //有近处的节点，但它们太少或过载太多，放宽到了更大范围
+    if (tier > nearest)
+        statAdd(stats->localSpills);
+    return hi;
+}
+
+void LB::addIdle(HI* hi)
+{
+    _runningList.push_back(hi);
+    for (int t = hi->locality;t < LOC_REMOTE; ++t)
+        _localList[t].push_back(hi);
+}
+
+void LB::rmIdle(HI* hi)
+{
+    _runningList.remove(hi);
+    for (int t = hi->locality;t < LOC_REMOTE; ++t)
+        _localList[t].remove(hi);
+}
+
+void LB::countHost(HI* hi, int delta)
+{
+    for (int t = hi->locality;t < LOC_REMOTE; ++t)
+        _localHosts[t] += delta;
+}
+
+//跳过overload节点
+struct IdleHI
+{
+    IdleHI(const std::vector<HI*>& hosts): _hosts(hosts) { }
+    bool operator()(int idx) const { return !_hosts[idx]->overload; }
+    const std::vector<HI*>& _hosts;
+};
+
+int LB::getHostByKey(uint64_t key, int policy, int param, elb::GetHostRsp& rsp)
+{
+    //节点全部overload时不论key，与轮询一样按probeNum试探或回复过载
+    if (_runningList.empty())
+        return getHost(rsp);
+    if (!_chashValid || _chash.policy() != policy || _chash.param() != param)
+    {
+        std::vector<uint64_t> hosts;
+        for (HostMapIt it = _hostMap.begin();it != _hostMap.end(); ++it)
+            hosts.push_back(it->first);
+        _chash.build(policy, param, hosts);
+        if (_chash.ringFallback())
+            log_error("mod %d:%d has %lu hosts, too many for maglev, use ring", _modid, _cmdid, hosts.size());
+        _chashHosts.clear();
+        for (size_t i = 0;i < _chash.hosts().size(); ++i)
+            _chashHosts.push_back(_hostMap[_chash.hosts()[i]]);
+        _chashValid = true;
+    }
+    IdleHI usable(_chashHosts);
+    int primary;
+    int idx = _chash.pick(key, usable, primary);
+    if (idx != primary)
+    {
+        //首选节点overload：每probeNum次把首选节点给出去试探，只影响落在它上面的key；开启主动探测时由agent自己探测
+        if (!LbConfig.activeProbe && _accessCnt >= LbConfig.probeNum)
+        {
+            _accessCnt = 0;
+            idx = primary;
+        }
+        else
+        {
+            ++_accessCnt;
+        }
+    }
+    HI* hi = _chashHosts[idx];
+    elb::HostAddr* hp = rsp.mutable_host();
+    hp->set_ip(hi->ip);
+    hp->set_port(hi->port);
+    return SUCCESS;
+}
+
+void LB::getDownHosts(std::vector<std::pair<uint32_t, int> >& hosts)
+{
+    for (ListIt it = _downList.begin();it != _downList.end(); ++it)
+        hosts.push_back(std::make_pair((*it)->ip, (*it)->port));
+}
+
 void LB::getRoute(std::vector<HI*>& vec)
 {
     for (HostMapIt it = _hostMap.begin();it != _hostMap.end(); ++it)
@@ -196,12 +521,15 @@ void LB::getRoute(std::vector<HI*>& vec)
     }
 }
 
-void LB::persist(FILE* fp)
+void LB::persist(std::vector<BackupHost>& hosts)
 {
     for (HostMapIt it = _hostMap.begin();it != _hostMap.end(); ++it)
     {
         HI* hi = it->second;
-        fprintf(fp, "%d %d %d %d\n", _modid, _cmdid, hi->ip, hi->port);
+        BackupHost host;
+        host.ip = hi->ip;
+        host.port = hi->port;
+        hosts.push_back(host);
     }
 }
 
@@ -211,6 +539,8 @@ void LB::report(int ip, int port, int retcode)
     if (_hostMap.find(key) == _hostMap.end())
         return ;
     HI* hi = _hostMap[key];
+    _hasRpt = true;
+    statAdd(myStats()->localCalls[hi->locality]);
     if (retcode == 0)
     {
         //更新虚拟成功、真实成功次数
@@ -229,12 +559,12 @@ void LB::report(int ip, int port, int retcode)
         hi->continSucc = 0;
         hi->continErr++;
     }
-    long currenTs = time(NULL);
     //检查idle节点是否满足overload条件;或者overload节点是否满足idle条件
     //如果是idle节点，则只有调用失败才有必要判断是否达到overload条件
     if (!hi->overload && retcode != 0)
     {
         bool ifOverload = false;
+        int reason = TRANS_ERR_RATE;
         //idle节点,检查是否达到判定为overload状态的条件
         //[1].计算失败率,如果大于预设失败率，则认为overload
         double errRate = hi->err * 1.0 / (hi->succ + hi->err);
@@ -242,25 +572,21 @@ void LB::report(int ip, int port, int retcode)
             ifOverload = true;
         //[2].连续失败次数达到阈值，认为overload
         if (!ifOverload && hi->continErr >= (uint32_t)LbConfig.continErrLim)
+        {
             ifOverload = true;
+            reason = TRANS_CONTIN_ERR;
+        }
         //判定为overload了
         if (ifOverload)
         {
-            struct in_addr saddr;
-            saddr.s_addr = htonl(hi->ip);
-            log_error("[%d, %d] host %s:%d suffer overload, succ %u err %u",
-                _modid, _cmdid, ::inet_ntoa(saddr), hi->port, hi->succ, hi->err);
-            //重置hi为overload状态
-            hi->setOverload(LbConfig.ovldErrCnt);
-            //移除出runingList,放入downList
-            _runningList.remove(hi);
-            _downList.push_back(hi);
-            return ;
+            //重置hi为overload状态,移除出runingList,放入downList
+            hostOverload(hi, reason);
         }
     }
     else if (hi->overload && retcode == 0)//如果是overload节点，则只有调用成功才有必要判断是否达到idle条件
     {
         bool ifIdle = false;
+        int reason = TRANS_SUCC_RATE;
         //overload节点,检查是否达到回到idle状态的条件
         //[1].计算成功率,如果大于预设成功率，则认为idle
         double succRate = hi->succ * 1.0 / (hi->succ + hi->err);
@@ -268,290 +594,286 @@ void LB::report(int ip, int port, int retcode)
             ifIdle = true;
         //[2].连续成功次数达到阈值，认为idle
         if (!ifIdle && hi->continSucc >= (uint32_t)LbConfig.continSuccLim)
+        {
             ifIdle = true;
+            reason = TRANS_CONTIN_SUCC;
+        }
         //判定为idle了
         if (ifIdle)
         {
-            struct in_addr saddr;
-            saddr.s_addr = htonl(hi->ip);
-            log_error("[%d, %d] host %s:%d recover to idle, succ %u err %u",
-                _modid, _cmdid, ::inet_ntoa(saddr), hi->port, hi->succ, hi->err);
-            //重置hi为idle状态
-            hi->resetIdle(LbConfig.initSuccCnt);
-            //移除出downList,重新放入runingList            
-            _downList.remove(hi);
-            _runningList.push_back(hi);
-            return ;
+            //重置hi为idle状态,移除出downList,重新放入runingList
+            hostIdle(hi, reason);
         }
     }
+    //idle时间窗口到达、overload超时均由时间轮驱动，见LB::onTimer
+}
 
-    //检查idle时间窗口是否到达，若到达，重置;或者检查overload节点是否处于overload状态的时长已经超时了
-    if (!hi->overload)
-    {
-        //节点是idle状态，检查是否时间窗口到达
-        if (currenTs - hi->windowTs >= LbConfig.clearTimo)
-        {
-            //时间窗口到达
-            if (hi->checkWindow()) {
-                //说明连续N个窗口失败率都高于M
-                //将此节点打为过载
-                struct in_addr saddr;
-                saddr.s_addr = htonl(hi->ip);
-                log_error("[%d, %d] host %s:%d suffer overload because of continuous windows error rate too high, real succ %u real err %u",
-                    _modid, _cmdid, ::inet_ntoa(saddr), hi->port, hi->rSucc, hi->rErr);
-                //重置hi为overload状态
-                hi->setOverload(LbConfig.ovldErrCnt);
-                //移除出runingList,放入downList
-                _runningList.remove(hi);
-                _downList.push_back(hi);
-            }
-            else {
-                //新窗口
-                hi->resetIdle(LbConfig.initSuccCnt);
-            }
-        }
-    }
-    else
-    {
-        //检查overload节点是否处于overload状态的时长已经超时了
-        if (currenTs - hi->overloadTs >= LbConfig.ovldWaitLim)
-        {
-            struct in_addr saddr;
-            saddr.s_addr = htonl(hi->ip);
-            log_error("[%d, %d] host %s:%d recover to idle, succ %u err %u",
-                _modid, _cmdid, ::inet_ntoa(saddr), hi->port, hi->succ, hi->err);
-            //处于overload状态的时长已经超时了
-            hi->resetIdle(LbConfig.initSuccCnt);
-            //重新把节点放入runningList
-            _downList.remove(hi);
-            _runningList.push_back(hi);
-        }
-    }
+//累计一段连续的调用结果：与逐次上报时每次调用的计数更新相同
+static void addSucc(HI* hi, unsigned cnt)
+{
+    hi->succ += cnt;
+    hi->rSucc += cnt;
+    hi->continSucc += cnt;
+    hi->continErr = 0;
+}
+
+static void addErr(HI* hi, unsigned cnt)
+{
+    hi->err += cnt;
+    hi->rErr += cnt;
+    hi->continErr += cnt;
+    hi->continSucc = 0;
 }
 
+//比例上达到阈值还需要几次调用：count/(count + other)超过rate时的count，减去已有的count，至少为1（逐次上报时先计数再判断）
+static unsigned needToExceed(double rate, uint32_t count, uint32_t other)
+{
+    unsigned total = rate * other / (1 - rate);
+    if (total * 1.0 / (total + other) <= rate)
+        ++total;
+    return total > count? total - count: 1;
+}
+
+//连续次数达到阈值还需要几次调用，至少为1
+static unsigned needToReach(int limit, uint32_t contin)
+{
+    return (uint32_t)limit > contin? limit - contin: 1;
+}
+
+//合并上报一段连续成功：算出第几次成功时满足overload节点回到idle的条件（成功率或连续成功），
+//已累计的虚拟成功、失败数都计入，判定与逐次调用report()相同；其余的成功在状态转换后继续累计
 void LB::reportSomeSucc(int ip, int port, unsigned succCnt)
 {
     uint64_t key = ((uint64_t)ip << 32) + port;
     if (_hostMap.find(key) == _hostMap.end())
         return ;
     HI* hi = _hostMap[key];
-    //更新真实成功次数
-    hi->rSucc += succCnt;
-    //更新连续成功、连续失败个数
-    hi->continSucc += succCnt;
-    hi->continErr = 0;
-    long currenTs = time(NULL);
-    //如果是idle节点，则在调用状态上报后，肯定还是idle，仅需更新虚拟成功个数、连续成功个数
-    if (!hi->overload)
-    {
-        hi->succ += succCnt;
-    }
-    else
-    {
-        //否则，检查此overload节点是否满足回到idle的条件
-        bool ifIdle = false;
-        unsigned leftSuccCnt = succCnt;
-        //[1].连续成功次数达到阈值，认为idle
-        if (hi->continSucc >= (uint32_t)LbConfig.continSuccLim)
-        {
-            leftSuccCnt = hi->continSucc - LbConfig.continSuccLim;
-            ifIdle = true;
-        }
-        //[2].计算成功率,如果大于预设成功率，则认为idle
-        if (!ifIdle)
-        {
-            unsigned needSucc = LbConfig.succRate * hi->err / (1 - LbConfig.succRate);
-            if (needSucc * 1.0 / (needSucc + hi->err) < LbConfig.succRate)
-                ++needSucc;
-            //如果成功个数超过所需成功个数，则认为idle
-            if (succCnt >= needSucc)
-            {
-                leftSuccCnt = succCnt - needSucc;
-                ifIdle = true;
-            }
-        }
-        hi->succ += succCnt - leftSuccCnt;
-        //判定为idle了
-        if (ifIdle)
-        {
-            struct in_addr saddr;
-            saddr.s_addr = htonl(hi->ip);
-            log_error("after report some, [%d, %d] host %s:%d recover to idle, succ %u err %u",
-                _modid, _cmdid, ::inet_ntoa(saddr), hi->port, hi->succ, hi->err);
-            //重置hi为idle状态
-            hi->resetIdle(LbConfig.initSuccCnt);
-            //移除出downList,重新放入runingList
-            _downList.remove(hi);
-            _runningList.push_back(hi);
-        }
-        //继续把剩下的成功个数加上
-        hi->succ += leftSuccCnt;
-    }
-
-    //检查idle时间窗口是否到达，若到达，重置;或者检查overload节点是否处于overload状态的时长已经超时了
+    _hasRpt = true;
+    statAdd(myStats()->localCalls[hi->locality], succCnt);
+    //如果是idle节点，则在调用状态上报后，肯定还是idle
     if (!hi->overload)
     {
-        //节点是idle状态，检查是否时间窗口到达
-        if (currenTs - hi->windowTs >= LbConfig.clearTimo)
-        {
-            //时间窗口到达
-            if (hi->checkWindow()) {
-                //说明连续N个窗口失败率都高于M
-                //将此节点打为过载
-                struct in_addr saddr;
-                saddr.s_addr = htonl(hi->ip);
-                log_error("[%d, %d] host %s:%d suffer overload because of continuous windows error rate too high, real succ %u real err %u",
-                    _modid, _cmdid, ::inet_ntoa(saddr), hi->port, hi->rSucc, hi->rErr);
-                //重置hi为overload状态
-                hi->setOverload(LbConfig.ovldErrCnt);
-                //移除出runingList,放入downList
-                _runningList.remove(hi);
-                _downList.push_back(hi);
-            }
-            else {
-                //新窗口
-                hi->resetIdle(LbConfig.initSuccCnt);
-            }
-        }
+        addSucc(hi, succCnt);
+        return ;
     }
-    else
+    //[1].成功率大于预设成功率；[2].连续成功次数达到阈值。同时满足时按成功率（与report()的判断顺序一致）
+    unsigned rateAt = needToExceed(LbConfig.succRate, hi->succ, hi->err);
+    unsigned continAt = needToReach(LbConfig.continSuccLim, hi->continSucc);
+    unsigned idleAt = std::min(rateAt, continAt);
+    if (idleAt > succCnt)
     {
-        //检查overload节点是否处于overload状态的时长已经超时了
-        if (currenTs - hi->overloadTs >= LbConfig.ovldWaitLim)
-        {
-            struct in_addr saddr;
-            saddr.s_addr = htonl(hi->ip);
-            log_error("[%d, %d] host %s:%d recover to idle, succ %u err %u",
-                _modid, _cmdid, ::inet_ntoa(saddr), hi->port, hi->succ, hi->err);
-            //处于overload状态的时长已经超时了
-            hi->resetIdle(LbConfig.initSuccCnt);
-            //重新把节点放入runningList
-            _downList.remove(hi);
-            _runningList.push_back(hi);
-        }
+        addSucc(hi, succCnt);
+        return ;
     }
+    addSucc(hi, idleAt);
+    //重置hi为idle状态,移除出downList,重新放入runingList
+    hostIdle(hi, rateAt <= continAt? TRANS_SUCC_RATE: TRANS_CONTIN_SUCC);
+    //继续把剩下的成功个数加上
+    addSucc(hi, succCnt - idleAt);
 }
 
+//合并上报一段连续失败，与reportSomeSucc对称
 void LB::reportSomeErr(int ip, int port, unsigned errCnt)
 {
-    printf("DEBUG: tell error count is %u\n", errCnt);
     uint64_t key = ((uint64_t)ip << 32) + port;
     if (_hostMap.find(key) == _hostMap.end())
         return ;
     HI* hi = _hostMap[key];
-    //更新真实失败次数
-    hi->rErr += errCnt;
-    //更新连续成功、连续失败个数
-    hi->continSucc = 0;
-    hi->continErr += errCnt;
-    long currenTs = time(NULL);
-    //如果是overload节点，则在调用状态上报后，肯定还是overload，仅需更新虚拟失败个数
+    _hasRpt = true;
+    statAdd(myStats()->localCalls[hi->locality], errCnt);
+    //如果是overload节点，则在调用状态上报后，肯定还是overload
     if (hi->overload)
     {
-        hi->err += errCnt;
+        addErr(hi, errCnt);
+        return ;
+    }
+    //[1].失败率大于预设失败率；[2].连续失败次数达到阈值。同时满足时按失败率（与report()的判断顺序一致）
+    unsigned rateAt = needToExceed(LbConfig.errRate, hi->err, hi->succ);
+    unsigned continAt = needToReach(LbConfig.continErrLim, hi->continErr);
+    unsigned ovldAt = std::min(rateAt, continAt);
+    if (ovldAt > errCnt)
+    {
+        addErr(hi, errCnt);
+        return ;
     }
+    addErr(hi, ovldAt);
+    //重置hi为overload状态,移除出runingList,放入downList
+    hostOverload(hi, rateAt <= continAt? TRANS_ERR_RATE: TRANS_CONTIN_ERR);
+    addErr(hi, errCnt - ovldAt);
+}
+
+void LB::recordTrans(HI* hi, bool overload, int reason)
+{
+    uint64_t mod = ((uint64_t)_modid << 32) + _cmdid;
+    uint64_t host = ((uint64_t)hi->ip << 32) + hi->port;
+    HostTransMap& hosts = (*_trans)[mod];
+    HostTransMap::iterator it = hosts.find(host);
+    if (it == hosts.end())
+    {
+        HostTrans init = {0, 0, false, 0, 0, 0};
+        it = hosts.insert(std::make_pair(host, init)).first;
+    }
+    HostTrans& trans = it->second;
+    if (overload)
+        ++trans.toOverload;
     else
+        ++trans.toIdle;
+    trans.overload = overload;
+    trans.reason = reason;
+    trans.succ = reason == TRANS_WINDOW? hi->rSucc: hi->succ;
+    trans.err = reason == TRANS_WINDOW? hi->rErr: hi->err;
+}
+
+void LB::hostOverload(HI* hi, int reason)
+{
+    recordTrans(hi, true, reason);
+    hi->setOverload(LbConfig.ovldErrCnt);
+    rmIdle(hi);
+    _downList.push_back(hi);
+    trackDown(hi, true);
+    ++downVer;
+    ++ovldCnt;
+    statAdd(myStats()->toOverload);
+    //处于overload状态的时长超过ovldWaitLim后强制恢复
+    hi->timer.type = HOST_OVERLOAD;
+    _wheel->add(&hi->timer, hi->overloadTs + LbConfig.ovldWaitLim);
+}
+
+void LB::hostIdle(HI* hi, int reason)
+{
+    recordTrans(hi, false, reason);
+    hi->resetIdle(LbConfig.initSuccCnt);
+    _downList.remove(hi);
+    trackDown(hi, false);
+    addIdle(hi);
+    ++downVer;
+    statAdd(myStats()->toIdle);
+    armWindow(hi);
+}
+
+void LB::trackDown(HI* hi, bool down)
+{
+    if (!_downs)
+        return ;
+    uint64_t mod = ((uint64_t)_modid << 32) + _cmdid;
+    uint64_t host = ((uint64_t)hi->ip << 32) + hi->port;
+    if (down)
     {
-        //否则，检查此idle节点是否满足回到overload的条件
-        bool ifOverload = false;
-        unsigned leftErrCnt = errCnt;
-        //[1].连续失败次数达到阈值，认为overload
-        if (hi->continErr >= (uint32_t)LbConfig.continErrLim)
-        {
-            leftErrCnt = hi->continErr - LbConfig.continErrLim;
-            ifOverload = true;
-        }
-        //[2].计算失败率,如果大于预设失败率，则认为overload
-        if (!ifOverload)
-        {
-            unsigned needErr = LbConfig.errRate * hi->succ / (1 - LbConfig.errRate);
-            if (needErr * 1.0 / (needErr + hi->succ) < LbConfig.errRate)
-                ++needErr;
-            //如果失败个数超过所需失败个数，则认为idle
-            if (errCnt >= needErr)
-            {
-                leftErrCnt = errCnt - needErr;
-                ifOverload = true;
-            }
-        }
-        hi->err += errCnt - leftErrCnt;
-        //判定为overload了
-        if (ifOverload)
-        {
-            struct in_addr saddr;
-            saddr.s_addr = htonl(hi->ip);
-            log_error("[%d, %d] host %s:%d suffer overload, succ %u err %u",
-                _modid, _cmdid, ::inet_ntoa(saddr), hi->port, hi->succ, hi->err);
-            //重置hi为overload状态
-            hi->setOverload(LbConfig.ovldErrCnt);
-            //移除出runingList,放入downList
-            _runningList.remove(hi);
-            _downList.push_back(hi);
-        }
-        hi->err += leftErrCnt;
+        (*_downs)[mod].insert(host);
+        return ;
     }
+    DownMap::iterator it = _downs->find(mod);
+    if (it == _downs->end())
+        return ;
+    it->second.erase(host);
+    if (it->second.empty())
+        _downs->erase(it);
+}
 
-    //检查idle时间窗口是否到达，若到达，重置;或者检查overload节点是否处于overload状态的时长已经超时了
-    if (!hi->overload)
+void LB::armWindow(HI* hi)
+{
+    hi->timer.type = HOST_WINDOW;
+    _wheel->add(&hi->timer, hi->windowTs + LbConfig.clearTimo);
+}
+
+void LB::onTimer(WheelNode* node)
+{
+    switch (node->type)
     {
-        //节点是idle状态，检查是否时间窗口到达
-        if (currenTs - hi->windowTs >= LbConfig.clearTimo)
+        case HOST_WINDOW:
         {
-            //时间窗口到达
-            if (hi->checkWindow()) {
+            //idle节点的时间窗口到达
+            HI* hi = (HI*)node->arg;
+            if (hi->checkWindow())
+            {
                 //说明连续N个窗口失败率都高于M
                 //将此节点打为过载
-                struct in_addr saddr;
-                saddr.s_addr = htonl(hi->ip);
-                log_error("[%d, %d] host %s:%d suffer overload because of continuous windows error rate too high, real succ %u real err %u",
-                    _modid, _cmdid, ::inet_ntoa(saddr), hi->port, hi->rSucc, hi->rErr);
-                //重置hi为overload状态
-                hi->setOverload(LbConfig.ovldErrCnt);
-                //移除出runingList,放入downList
-                _runningList.remove(hi);
-                _downList.push_back(hi);
+                hostOverload(hi, TRANS_WINDOW);
             }
-            else {
+            else
+            {
                 //新窗口
                 hi->resetIdle(LbConfig.initSuccCnt);
+                armWindow(hi);
             }
+            break;
         }
-    }
-    else
-    {
-        //检查overload节点是否处于overload状态的时长已经超时了
-        if (currenTs - hi->overloadTs >= LbConfig.ovldWaitLim)
+        case HOST_OVERLOAD:
         {
-            struct in_addr saddr;
-            saddr.s_addr = htonl(hi->ip);
-            log_error("[%d, %d] host %s:%d recover to idle, succ %u err %u",
-                _modid, _cmdid, ::inet_ntoa(saddr), hi->port, hi->succ, hi->err);
-            //处于overload状态的时长已经超时了
-            hi->resetIdle(LbConfig.initSuccCnt);
+            //overload节点处于overload状态的时长已经超时了
+            HI* hi = (HI*)node->arg;
             //重新把节点放入runningList
-            _downList.remove(hi);
-            _runningList.push_back(hi);
+            hostIdle(hi, TRANS_TIMEOUT);
+            break;
         }
+        case ROUTE_UPDATE:
+            //路由有效期到了：有效期内被访问过则重拉取，否则等到下次被访问时再拉取
+            if (status == ISNEW)
+            {
+                if (_accessed)
+                    pull();
+                else
+                    _pullDue = true;
+            }
+            break;
+        case STATUS_REPORT:
+            report2Rpter();
+            break;
+    }
+}
+
+void LB::access()
+{
+    if (_pullDue)
+        pull();
+    else
+        _accessed = true;
+}
+
+void LB::resetPulling()
+{
+    if (status == ISPULLING)
+    {
+        status = ISNEW;
+        _pullDue = true;
     }
 }
 
-void LB::update(elb::GetRouteRsp& rsp)
+bool LB::update(elb::GetRouteRsp& rsp)
 {
     assert(rsp.hosts_size() != 0);
     //如果是第一次拉过来，则重置lstRptTime，防止第一次api上报状态就触发lbagent给reporter上报
     bool resetRptTime = _hostMap.empty();
     bool updated = false;
-    long currenTs = time(NULL);
+    long currenTs = MONO_SEC();
     //hosts who need to delete
     std::set<uint64_t> remote;
     std::set<uint64_t> todel;
-    for (int i = 0;i < rsp.hosts_size(); ++i)
+    //大模块只跟踪本agent的子集，子集外的节点视同不在路由中
+    std::vector<const elb::HostAddr*> hosts;
+    subsetHosts(((uint64_t)_modid << 32) + _cmdid, rsp, hosts);
+    for (size_t i = 0;i < hosts.size(); ++i)
     {
-        const elb::HostAddr& h = rsp.hosts(i);
+        const elb::HostAddr& h = *hosts[i];
         uint64_t key = ((uint64_t)h.ip() << 32) + h.port();
         remote.insert(key);
+        int locality = hostLocality(h);
 
-        if (_hostMap.find(key) == _hostMap.end())
+        HostMapIt ht = _hostMap.find(key);
+        if (ht != _hostMap.end() && ht->second->locality != locality)
+        {
+            //节点的位置标签变了，重新归入对应位置的队列；版本号随之变化，API cache据此更新
+            updated = true;
+            HI* hi = ht->second;
+            if (!hi->overload)
+                rmIdle(hi);
+            countHost(hi, -1);
+            hi->locality = locality;
+            countHost(hi, 1);
+            if (!hi->overload)
+                addIdle(hi);
+        }
+        else if (ht == _hostMap.end())
         {
             updated = true;
             //it is new
@@ -563,7 +885,12 @@ void LB::update(elb::GetRouteRsp& rsp)
             }
             _hostMap[key] = hi;
             //add to running list
-            _runningList.push_back(hi);
+            hi->locality = locality;
+            countHost(hi, 1);
+            addIdle(hi);
+            hi->timer.owner = this;
+            hi->timer.arg = hi;
+            armWindow(hi);
         }
     }
     for (HostMapIt it = _hostMap.begin();it != _hostMap.end(); ++it)
@@ -578,19 +905,35 @@ void LB::update(elb::GetRouteRsp& rsp)
         HI* hi = _hostMap[key];
 
         if (hi->overload)
+        {
             _downList.remove(hi);
+            trackDown(hi, false);
+            ++downVer;
+        }
         else
-            _runningList.remove(hi);
+            rmIdle(hi);
+        countHost(hi, -1);
         _hostMap.erase(*it);
         delete hi;
     }
     //重置effectData,表明路由更新时间\有效期开始
     effectData = currenTs;
     status = ISNEW;
+    _pullDue = false;
+    _wheel->add(&_updateTimer, currenTs + LbConfig.updateTimo + 1);
     if (resetRptTime)
+    {
         lstRptTime = currenTs;
-    if (updated)//确实发生了路由更新，于是更新版本号
-        version = currenTs;
+        _wheel->add(&_reportTimer, currenTs + LbConfig.reportTimo);
+    }
+    if (updated)//确实发生了路由更新，于是更新版本号；版本号会发给API比对，用绝对时间
+    {
+        version = time(NULL);
+        //节点集合变化，下次按key获取时重建一致性哈希表
+        _chashValid = false;
+        _chashHosts.clear();
+    }
+    return updated;
 }
 
 void LB::pull()
@@ -599,18 +942,27 @@ void LB::pull()
     pullReq.set_modid(_modid);
     pullReq.set_cmdid(_cmdid);
     pullQueue->send_msg(pullReq);
+    statAdd(myStats()->pullEnq);
+    markPulling();
+}
+
+void LB::markPulling()
+{
     //标记:路由正在拉取
     status = LB::ISPULLING;
+    _pullDue = false;
+    _accessed = false;
 }
 
-void LB::report2Rpter()
+void LB::report2Rpter(bool force)
 {
-    if (empty())
-        return ;
-    long currenTs = time(NULL);
-    if (currenTs - lstRptTime < LbConfig.reportTimo)
-        return ;
+    long currenTs = MONO_SEC();
     lstRptTime = currenTs;
+    _wheel->add(&_reportTimer, currenTs + LbConfig.reportTimo);
+    //上个周期没有收到任何调用结果则不必上报；有节点状态转换（如过载超时恢复）时仍须上报
+    if (empty() || (!_hasRpt && !force))
+        return ;
+    _hasRpt = false;
 
     elb::ReportStatusReq req;
     req.set_modid(_modid);
@@ -641,18 +993,35 @@ void LB::report2Rpter()
         req.add_results()->CopyFrom(callRes);
     }
     reptQueue->send_msg(req);
+    statAdd(myStats()->reptEnq);
 }
 
-RouteLB::RouteLB(int id): _id(id)
+RouteLB::RouteLB(int id): _id(id), _wheel(MONO_SEC()), _backupGen(0), _journalCnt(0), _needFull(true), _notifyFd(-1), _transTs(0)
 {
     ::pthread_once(&onceLoad, initLbEnviro);
     ::pthread_mutex_init(&_mutex, NULL);
+    _transTs = MONO_SEC() + LbConfig.transLogInterval;
 }
 
-int RouteLB::getHost(int modid, int cmdid, elb::GetHostRsp& rsp)
+void RouteLB::lock()
 {
-    uint64_t key = ((uint64_t)modid << 32) + cmdid;
+    //不争用时只多一次trylock，争用时才读时钟
+    if (::pthread_mutex_trylock(&_mutex) == 0)
+        return ;
+    uint64_t begin = statNowUs();
     ::pthread_mutex_lock(&_mutex);
+    ThreadStats* stats = myStats();
+    statAdd(stats->lockContended);
+    stats->lockWaitUs.record(statNowUs() - begin);
+}
+
+int RouteLB::getHost(int modid, int cmdid, elb::GetHostRsp& rsp, bool byKey, uint64_t reqKey)
+{
+    uint64_t key = ((uint64_t)modid << 32) + cmdid;
+    int param = 0, policy = HASH_NONE;
+    if (byKey)
+        policy = hashPolicyOf(key, param);
+    lock();
     if (_routeMap.find(key) != _routeMap.end())
     {
         LB* lb = _routeMap[key];
@@ -664,20 +1033,16 @@ int RouteLB::getHost(int modid, int cmdid, elb::GetHostRsp& rsp)
         }
         else
         {
-            int ret = lb->getHost(rsp);
+            int ret = policy == HASH_NONE? lb->getHost(rsp): lb->getHostByKey(reqKey, policy, param, rsp);
             rsp.set_retcode(ret);
-            //检查是否需要重拉路由
-            //若路由并没有正在拉取，且有效期至今已超时，则重拉取
-            if (lb->status == LB::ISNEW && time(NULL) - lb->effectData > LbConfig.updateTimo)
-            {
-                lb->pull();
-            }
+            //路由有效期已过则重拉取
+            lb->access();
         }
         ::pthread_mutex_unlock(&_mutex);
     }
     else
     {
-        LB* lb = new LB(modid, cmdid);
+        LB* lb = new LB(modid, cmdid, &_wheel, &_trans, LbConfig.activeProbe? &_downs: NULL);
         if (!lb)
         {
             fprintf(stderr, "no more space to new LB\n");
@@ -695,78 +1060,267 @@ int RouteLB::getHost(int modid, int cmdid, elb::GetHostRsp& rsp)
 
 void RouteLB::report(elb::ReportReq& req)
 {
-    int modid = req.modid();
-    int cmdid = req.cmdid();
-    int retcode = req.retcode();
-    int ip = req.host().ip();
-    int port = req.host().port();
+    //新版本api只在失败调用上带tcost（老版本agent收到带tcost的成功上报会断言失败）
+    report(req.modid(), req.cmdid(), req.host().ip(), req.host().port(), req.retcode(), req.has_tcost()? req.tcost(): 0);
+}
+
+void RouteLB::report(int modid, int cmdid, int ip, int port, int retcode, uint32_t tcost)
+{
     uint32_t errcnt = 1;
-    if (req.has_tcost())
+    if (retcode != 0 && tcost)
     {
-        assert(req.retcode() != 0);
         //100ms视为一次err
-        errcnt = req.tcost() / 100;
+        errcnt = tcost / 100;
         if (errcnt == 0)
             errcnt = 1;
         else if (errcnt > 50)
             errcnt = 50;
     }
 
-    uint64_t key = ((uint64_t)modid << 32) + cmdid;
-    ::pthread_mutex_lock(&_mutex);
-    if (_routeMap.find(key) != _routeMap.end())
+    //先暂存，由foldPending合并进LB算法
+    if (retcode == 0)
+        addPending(modid, cmdid, ip, port, true, 1, tcost, tcost? 1: 0);
+    else
+        addPending(modid, cmdid, ip, port, false, errcnt);
+}
+
+void RouteLB::batchReport(elb::CacheBatchRptReq& req)
+{
+    int modid = req.modid();
+    int cmdid = req.cmdid();
+    for (int i = 0;i < req.results_size(); ++i)
     {
-        LB* lb = _routeMap[key];
-        
-        if (errcnt == 1)
-            lb->report(ip, port, retcode);
+        const elb::HostBatchCallRes& cr = req.results(i);
+        if (cr.succcnt())
+            addPending(modid, cmdid, cr.ip(), cr.port(), true, cr.succcnt(), cr.costsum(), cr.costcnt());
+    }
+}
+
+void RouteLB::addPending(int modid, int cmdid, int ip, int port, bool succ, uint32_t cnt, uint64_t costSum, uint32_t costCnt)
+{
+    uint64_t mod = ((uint64_t)modid << 32) + cmdid;
+    uint64_t hostKey = ((uint64_t)ip << 32) + port;
+    PendingRun* run = NULL;
+    __gnu_cxx::hash_map<uint64_t, size_t>::iterator it = _lastRun.find(hostKey);
+    if (it != _lastRun.end())
+    {
+        PendingRun& last = _pending[it->second];
+        //与此节点上一段游程同类，直接累加
+        if (last.mod == mod && last.succ == succ)
+            run = &last;
+    }
+    if (run)
+    {
+        run->cnt += cnt;
+        run->costSum += costSum;
+        run->costCnt += costCnt;
+    }
+    else
+    {
+        PendingRun newRun;
+        newRun.mod = mod;
+        newRun.ip = ip;
+        newRun.port = port;
+        newRun.succ = succ;
+        newRun.cnt = cnt;
+        newRun.costSum = costSum;
+        newRun.costCnt = costCnt;
+        _lastRun[hostKey] = _pending.size();
+        _pending.push_back(newRun);
+        run = &_pending.back();
+    }
+    //连续失败已够判定过载，则不再等待合并周期，保证过载发现不被推迟
+    if (LbConfig.foldInterval == 0 ||
+        (!succ && run->cnt >= (uint32_t)LbConfig.continErrLim) ||
+        (int)_pending.size() >= LbConfig.foldPendLim)
+    {
+        foldPending();
+    }
+}
+
+void RouteLB::foldPending()
+{
+    if (_pending.empty())
+        return ;
+    LB* lb = NULL;
+    uint64_t lbKey = 0;
+    lock();
+    for (std::vector<PendingRun>::iterator it = _pending.begin();it != _pending.end(); ++it)
+    {
+        if (!lb || it->mod != lbKey)
+        {
+            //上一个模块的调用结果已合并完，过载状态有变化则推送给订阅者
+            if (lb)
+                notifySubs(lbKey);
+            lbKey = it->mod;
+            RouteMapIt rit = _routeMap.find(lbKey);
+            lb = rit != _routeMap.end()? rit->second: NULL;
+            if (!lb)
+                continue;
+        }
+        if (it->cnt == 1)
+            lb->report(it->ip, it->port, it->succ? 0: 1);
+        else if (it->succ)
+            lb->reportSomeSucc(it->ip, it->port, it->cnt);
         else
-            lb->reportSomeErr(ip, port, errcnt);
-        //try to report to reporter
-        lb->report2Rpter();
+            lb->reportSomeErr(it->ip, it->port, it->cnt);
+        if (it->costCnt)
+        {
+            lb->succCostSum += it->costSum;
+            lb->succCostCnt += it->costCnt;
+        }
     }
+    if (lb)
+        notifySubs(lbKey);
     ::pthread_mutex_unlock(&_mutex);
+    statAdd(myStats()->foldRuns, _pending.size());
+    _pending.clear();
+    _lastRun.clear();
 }
 
-void RouteLB::batchReport(elb::CacheBatchRptReq& req)
+void RouteLB::tick()
 {
-    int modid = req.modid();
-    int cmdid = req.cmdid();
-    uint64_t key = ((uint64_t)modid << 32) + cmdid;
-    ::pthread_mutex_lock(&_mutex);
-    if (_routeMap.find(key) != _routeMap.end())
+    WheelNode expired;
+    long ts = MONO_SEC();
+    lock();
+    _wheel.advance(ts, expired);
+    while (expired.next != &expired)
     {
-        LB* lb = _routeMap[key];
-        for (int i = 0;i < req.results_size(); ++i)
+        WheelNode* node = expired.next;
+        node->unlink();
+        LB* lb = (LB*)node->owner;
+        lb->onTimer(node);
+    }
+    //过载超时等定时器可能改变了过载状态；同时清理到期未续订的订阅
+    for (CacheSubMap::iterator it = _cacheSubs.begin();it != _cacheSubs.end(); )
+    {
+        CacheSub& sub = it->second;
+        for (__gnu_cxx::hash_map<int, long>::iterator pit = sub.ports.begin();pit != sub.ports.end(); )
+        {
+            if (pit->second <= ts)
+                sub.ports.erase(pit++);
+            else
+                ++pit;
+        }
+        if (sub.ports.empty())
+        {
+            _cacheSubs.erase(it++);
+        }
+        else
         {
-            const elb::HostBatchCallRes& cr = req.results(i);
-            int ip = cr.ip();
-            int port = cr.port();
-            unsigned succCnt = cr.succcnt();
-            lb->reportSomeSucc(ip, port, succCnt);
+            //有订阅者的模块视为一直被访问：订阅者不再频繁来获取路由，但路由仍需按有效期重拉
+            uint64_t key = it->first;
+            RouteMapIt rit = _routeMap.find(key);
+            if (rit != _routeMap.end() && !rit->second->empty())
+                rit->second->access();
+            //notifySubs可能删除此订阅，先移到下一个
+            ++it;
+            notifySubs(key);
         }
-        //try to report to reporter
-        lb->report2Rpter();
+    }
+    flushTrans(ts);
+}
+
+static const char* transReasons[] = {"err rate", "continuous err", "window err rate", "succ rate", "continuous succ", "overload timeout"};
+
+void RouteLB::flushTrans(long ts)
+{
+    if (ts < _transTs || _trans.empty())
+    {
+        ::pthread_mutex_unlock(&_mutex);
+        return ;
+    }
+    long interval = LbConfig.transLogInterval + ts - _transTs;
+    _transTs = ts + LbConfig.transLogInterval;
+    TransMap trans;
+    trans.swap(_trans);
+    //有节点状态转换的模块立即上报一次，reporter不必等到下个上报周期才看到overload变化
+    for (TransMap::iterator it = trans.begin();it != trans.end(); ++it)
+    {
+        RouteMapIt rit = _routeMap.find(it->first);
+        if (rit != _routeMap.end())
+            rit->second->report2Rpter(true);
     }
     ::pthread_mutex_unlock(&_mutex);
+
+    //格式化、写日志都在锁外；每个周期至多输出transLogLimit个节点，其余只输出汇总
+    int logged = 0, suppressed = 0;
+    uint32_t suppOverloads = 0, suppIdles = 0;
+    for (TransMap::iterator it = trans.begin();it != trans.end(); ++it)
+    {
+        int modid = (int)(it->first >> 32);
+        int cmdid = (int)it->first;
+        for (HostTransMap::iterator hit = it->second.begin();hit != it->second.end(); ++hit)
+        {
+            const HostTrans& t = hit->second;
+            if (logged >= LbConfig.transLogLimit)
+            {
+                ++suppressed;
+                suppOverloads += t.toOverload;
+                suppIdles += t.toIdle;
+                continue;
+            }
+            ++logged;
+            struct in_addr saddr;
+            saddr.s_addr = htonl((uint32_t)(hit->first >> 32));
+            char ipStr[INET_ADDRSTRLEN];
+            ::inet_ntop(AF_INET, &saddr, ipStr, sizeof ipStr);
+            log_error("[%d, %d] host %s:%d overload %u times, recover %u times in %lds, now %s because of %s, succ %u err %u",
+                modid, cmdid, ipStr, (int)(uint32_t)hit->first, t.toOverload, t.toIdle, interval,
+                t.overload? "overload": "idle", transReasons[t.reason], t.succ, t.err);
+        }
+    }
+    if (suppressed)
+        log_error("RouteLB %d: %d more hosts changed state in %lds (overload %u times, recover %u times), logs suppressed",
+            _id, suppressed, interval, suppOverloads, suppIdles);
+}
+
+int RouteLB::foldInterval() const
+{
+    return LbConfig.foldInterval;
+}
+
+bool RouteLB::activeProbe() const
+{
+    return LbConfig.activeProbe;
+}
+
+void RouteLB::getProbeTargets(std::vector<ProbeTarget>& targets)
+{
+    lock();
+    for (DownMap::iterator it = _downs.begin();it != _downs.end(); ++it)
+    {
+        for (__gnu_cxx::hash_set<uint64_t>::iterator ht = it->second.begin();ht != it->second.end(); ++ht)
+        {
+            ProbeTarget target;
+            target.modid = (int)(it->first >> 32);
+            target.cmdid = (int)(it->first & 0xffffffff);
+            target.ip = (uint32_t)(*ht >> 32);
+            target.port = (int)(*ht & 0xffffffff);
+            targets.push_back(target);
+        }
+    }
+    ::pthread_mutex_unlock(&_mutex);
+}
+
+void RouteLB::probeResult(int modid, int cmdid, int ip, int port, bool ok)
+{
+    //TCP connect成功只说明节点还在监听，应用层可能仍然过载，只按一次成功调用计；连续成功达到contin_succ_lim才按原有逻辑恢复为idle
+    addPending(modid, cmdid, ip, port, ok, 1);
 }
 
 void RouteLB::getRoute(int modid, int cmdid, elb::GetRouteRsp& rsp)
 {
     uint64_t key = ((uint64_t)modid << 32) + cmdid;
-    ::pthread_mutex_lock(&_mutex);
+    lock();
     if (_routeMap.find(key) != _routeMap.end())
     {
         LB* lb = _routeMap[key];
         std::vector<HI*> vec;
         lb->getRoute(vec);
 
-        //检查是否需要重拉路由
-        //若路由并没有正在拉取，且有效期至今已超时，则重拉取
-        if (lb->status == LB::ISNEW && time(NULL) - lb->effectData > LbConfig.updateTimo)
-        {
-            lb->pull();
-        }
+        //路由有效期已过则重拉取
+        lb->access();
         ::pthread_mutex_unlock(&_mutex);
 
         for (std::vector<HI*>::iterator it = vec.begin();it != vec.end(); ++it)
@@ -779,7 +1333,7 @@ void RouteLB::getRoute(int modid, int cmdid, elb::GetRouteRsp& rsp)
     }
     else
     {
-        LB* lb = new LB(modid, cmdid);
+        LB* lb = new LB(modid, cmdid, &_wheel, &_trans, LbConfig.activeProbe? &_downs: NULL);
         if (!lb)
         {
             fprintf(stderr, "no more space to new LB\n");
@@ -792,10 +1346,10 @@ void RouteLB::getRoute(int modid, int cmdid, elb::GetRouteRsp& rsp)
     }
 }
 
-void RouteLB::cacheGetRoute(int modid, int cmdid, long version, elb::CacheGetRouteRsp& rsp)
+void RouteLB::cacheGetRoute(int modid, int cmdid, long version, int subport, elb::CacheGetRouteRsp& rsp)
 {
     uint64_t key = ((uint64_t)modid << 32) + cmdid;
-    ::pthread_mutex_lock(&_mutex);
+    lock();
     if (_routeMap.find(key) != _routeMap.end())
     {
         LB* lb = _routeMap[key];
@@ -810,18 +1364,29 @@ void RouteLB::cacheGetRoute(int modid, int cmdid, long version, elb::CacheGetRou
         {
             rsp.set_overload(lb->hasOvHost());
             rsp.set_version(lb->version);
+            //给出各节点状态，api在idle节点中自行轮询，不必因个别节点过载就全部走网络
+            fillHostState(lb, cacheProbeNum(), rsp);
+            //api按key获取节点时用同样的策略、参数建表，与agent选出同一节点
+            int param;
+            int policy = hashPolicyOf(key, param);
+            if (policy != HASH_NONE)
+            {
+                rsp.set_hashpolicy(policy);
+                rsp.set_hashparam(param);
+            }
+            if (subport > 0 && _notifyFd != -1)
+            {
+                rsp.set_pushseq(subscribe(key, subport, lb));
+                rsp.set_pushed(true);
+            }
 
             std::vector<HI*> vec;
             if (lb->version != version)//路由有变化，需要更新
             {
                 lb->getRoute(vec);
             }
-            //检查是否需要重拉路由
-            //若路由并没有正在拉取，且有效期至今已超时，则重拉取
-            if (lb->status == LB::ISNEW && time(NULL) - lb->effectData > LbConfig.updateTimo)
-            {
-                lb->pull();
-            }
+            //路由有效期已过则重拉取
+            lb->access();
             ::pthread_mutex_unlock(&_mutex);
 
             for (std::vector<HI*>::iterator it = vec.begin();it != vec.end(); ++it)
@@ -830,6 +1395,14 @@ void RouteLB::cacheGetRoute(int modid, int cmdid, long version, elb::CacheGetRou
                 host.set_ip((*it)->ip);
                 host.set_port((*it)->port);
                 rsp.add_route()->CopyFrom(host);
+                //api按同样的位置偏好轮询
+                if (LbConfig.myIdc)
+                    rsp.add_localities((*it)->locality);
+            }
+            if (LbConfig.myIdc && !vec.empty())
+            {
+                rsp.set_localmin(LbConfig.localMin);
+                rsp.set_spillpct(LbConfig.spillPct);
             }
         }
     }
@@ -837,7 +1410,7 @@ void RouteLB::cacheGetRoute(int modid, int cmdid, long version, elb::CacheGetRou
     {
         //no exist
         rsp.set_version(-1);
-        LB* lb = new LB(modid, cmdid);
+        LB* lb = new LB(modid, cmdid, &_wheel, &_trans, LbConfig.activeProbe? &_downs: NULL);
         if (!lb)
         {
             fprintf(stderr, "no more space to new LB\n");
@@ -853,7 +1426,7 @@ void RouteLB::cacheGetRoute(int modid, int cmdid, long version, elb::CacheGetRou
 void RouteLB::update(int modid, int cmdid, elb::GetRouteRsp& rsp)
 {
     uint64_t key = ((uint64_t)modid << 32) + cmdid;
-    ::pthread_mutex_lock(&_mutex);
+    lock();
     if (_routeMap.find(key) != _routeMap.end())
     {
         LB* lb = _routeMap[key];
@@ -862,52 +1435,275 @@ void RouteLB::update(int modid, int cmdid, elb::GetRouteRsp& rsp)
             //delete this[modid,cmdid]
             delete lb;
             _routeMap.erase(key);
+            _dirty.insert(key);
         }
-        else
+        else if (lb->update(rsp))
         {
-            lb->update(rsp);
+            _dirty.insert(key);
         }
+        notifySubs(key);
     }
     ::pthread_mutex_unlock(&_mutex);
 }
 
+int RouteLB::cacheProbeNum() const
+{
+    //开启主动探测时由agent自己探测，api不再试探overload节点
+    return LbConfig.activeProbe? 0: LbConfig.probeNum;
+}
+
+void RouteLB::setNotifyFd(int fd)
+{
+    _notifyFd = fd;
+}
+
+uint32_t RouteLB::subscribe(uint64_t key, int port, LB* lb)
+{
+    CacheSubMap::iterator it = _cacheSubs.find(key);
+    if (it == _cacheSubs.end())
+    {
+        it = _cacheSubs.insert(std::make_pair(key, CacheSub())).first;
+    }
+    else if (it->second.version != lb->version || it->second.downVer != lb->downVer)
+    {
+        //此前的订阅者还没被告知最新状态，先推送，再以最新状态为基准
+        notifySubs(key);
+    }
+    CacheSub& sub = it->second;
+    sub.version = lb->version;
+    sub.downVer = lb->downVer;
+    sub.ports[port] = MONO_SEC() + LbConfig.cacheSubLease;
+    return sub.pushSeq;
+}
+
+void RouteLB::notifySubs(uint64_t key)
+{
+    if (_cacheSubs.empty())
+        return ;
+    CacheSubMap::iterator it = _cacheSubs.find(key);
+    if (it == _cacheSubs.end())
+        return ;
+    CacheSub& sub = it->second;
+    RouteMapIt rit = _routeMap.find(key);
+    LB* lb = rit != _routeMap.end()? rit->second: NULL;
+    long version = lb && !lb->empty()? lb->version: -1;
+    uint32_t downVer = lb? lb->downVer: 0;
+    if (version == sub.version && downVer == sub.downVer)
+        return ;
+    sub.version = version;
+    sub.downVer = downVer;
+
+    elb::CacheRouteNotify notify;
+    notify.set_modid((int)(key >> 32));
+    notify.set_cmdid((int)(key & 0xffffffff));
+    notify.set_version(version);
+    notify.set_overload(lb && lb->hasOvHost());
+    //推送是不可靠的UDP，序号让api发现丢失
+    notify.set_pushseq(++sub.pushSeq);
+    if (lb)
+        fillHostState(lb, cacheProbeNum(), notify);
+    //按消息实际长度分配，overload节点已限制在CACHE_DOWNS_LIMIT个以内
+    std::string body;
+    notify.SerializeToString(&body);
+    if (body.size() > MSG_LENGTH_LIMIT)
+    {
+        log_error("notify [%d,%d] too long: %lu bytes, not pushed", notify.modid(), notify.cmdid(), body.size());
+        return ;
+    }
+    commu_head head;
+    head.cmdid = elb::CacheRouteNotifyId;
+    head.length = body.size();
+    std::string wbuf((const char*)&head, COMMU_HEAD_LENGTH);
+    wbuf.append(body);
+
+    struct sockaddr_in addr;
+    ::memset(&addr, 0, sizeof addr);
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    for (__gnu_cxx::hash_map<int, long>::iterator pit = sub.ports.begin();pit != sub.ports.end(); ++pit)
+    {
+        addr.sin_port = htons(pit->first);
+        ::sendto(_notifyFd, wbuf.data(), wbuf.size(), 0, (struct sockaddr*)&addr, sizeof addr);
+    }
+    //模块已删除，订阅随之结束，api重新获取时再订阅
+    if (version == -1)
+        _cacheSubs.erase(it);
+}
+
 void RouteLB::clearPulling()
 {
-    ::pthread_mutex_lock(&_mutex);
+    lock();
     for (RouteMapIt it = _routeMap.begin();
         it != _routeMap.end(); ++it)
     {
         LB* lb = it->second;
-        if (lb->status == LB::ISPULLING)
-            lb->status = LB::ISNEW;
+        lb->resetPulling();
     }
     ::pthread_mutex_unlock(&_mutex);
 }
 
+static bool backupModLess(const BackupModule& a, const BackupModule& b)
+{
+    return a.key < b.key;
+}
+
 void RouteLB::persistRoute()
 {
-    FILE* fp = NULL;
-    switch (_id)
+    std::vector<BackupModule> modules;
+    std::vector<BackupHost> hosts;
+    //持锁时只拷贝变化的模块（或全量快照），排序与写文件都在锁外完成
+    lock();
+    //没有变化的模块则不落地；上次写盘失败时_needFull仍为true，即使没有新变化也重试全量重写
+    //启动后还没有落地过（_backupGen为0）时不因_needFull写盘，以免用空快照覆盖API静态路由所读的文件
+    if (_dirty.empty() && !(_needFull && _backupGen))
     {
-        case 1:
-            fp = fopen("/tmp/backupRoute.dat.1", "w");
-            break;
-        case 2:
-            fp = fopen("/tmp/backupRoute.dat.2", "w");
-            break;
-        case 3:
-            fp = fopen("/tmp/backupRoute.dat.3", "w");
+        ::pthread_mutex_unlock(&_mutex);
+        return ;
     }
-    if (fp)
+    bool full = _needFull || _journalCnt + (int)_dirty.size() > LbConfig.journalCompactLim;
+    if (full)
     {
-        ::pthread_mutex_lock(&_mutex);
+        modules.reserve(_routeMap.size());
         for (RouteMapIt it = _routeMap.begin();
             it != _routeMap.end(); ++it)
         {
             LB* lb = it->second;
-            lb->persist(fp);
+            if (lb->empty())
+                continue;
+            BackupModule mod;
+            mod.key = it->first;
+            mod.version = lb->version;
+            mod.first = hosts.size();
+            lb->persist(hosts);
+            mod.count = hosts.size() - mod.first;
+            modules.push_back(mod);
+        }
+        _journalCnt = 0;
+    }
+    else
+    {
+        for (__gnu_cxx::hash_set<uint64_t>::iterator it = _dirty.begin();it != _dirty.end(); ++it)
+        {
+            BackupModule mod;
+            mod.key = *it;
+            mod.version = 0;
+            mod.first = hosts.size();
+            RouteMapIt rit = _routeMap.find(*it);
+            //已删除或尚无节点的模块记为count = 0
+            if (rit != _routeMap.end() && !rit->second->empty())
+            {
+                mod.version = rit->second->version;
+                rit->second->persist(hosts);
+            }
+            mod.count = hosts.size() - mod.first;
+            modules.push_back(mod);
         }
+        _journalCnt += modules.size();
+    }
+    _dirty.clear();
+    _needFull = false;
+    ::pthread_mutex_unlock(&_mutex);
+
+    char path[64];
+    snprintf(path, sizeof path, BACKUP_FILE_PREFIX "%d", _id);
+    bool ok;
+    if (full)
+    {
+        std::sort(modules.begin(), modules.end(), backupModLess);
+        _backupGen = _backupGen? _backupGen + 1: (uint32_t)time(NULL);
+        ok = writeRouteBackup(path, _backupGen, modules, hosts);
+    }
+    else
+    {
+        ok = appendRouteJournal(path, modules, hosts);
+    }
+    if (!ok)
+    {
+        //写盘失败，下次全量重写
+        lock();
+        _needFull = true;
         ::pthread_mutex_unlock(&_mutex);
-        fclose(fp);
     }
-}
\ No newline at end of file
+}
+
+void RouteLB::loadBackup()
+{
+    if (!LbConfig.warmStart)
+        return ;
+    char path[64];
+    snprintf(path, sizeof path, BACKUP_FILE_PREFIX "%d", _id);
+    BackupView view;
+    if (!view.map(path))
+        return ;
+    std::vector<std::pair<uint64_t, int64_t> > mods;
+    view.getModules(mods);
+
+    lock();
+    for (size_t i = 0;i < mods.size(); ++i)
+    {
+        uint64_t key = mods[i].first;
+        uint32_t count = 0;
+        const BackupHost* hosts = view.find(key, count);
+        if (!hosts || !count || _routeMap.find(key) != _routeMap.end())
+            continue;
+        int modid = (int)(key >> 32), cmdid = (int)(key & 0xffffffff);
+        elb::GetRouteRsp rsp;
+        rsp.set_modid(modid);
+        rsp.set_cmdid(cmdid);
+        for (uint32_t j = 0;j < count; ++j)
+        {
+            elb::HostAddr* host = rsp.add_hosts();
+            host->set_ip(hosts[j].ip);
+            host->set_port(hosts[j].port);
+        }
+        LB* lb = new LB(modid, cmdid, &_wheel, &_trans, LbConfig.activeProbe? &_downs: NULL);
+        if (!lb)
+        {
+            fprintf(stderr, "no more space to new LB\n");
+            ::exit(1);
+        }
+        _routeMap[key] = lb;
+        lb->update(rsp);
+        //沿用落地时的版本号，API cache中已有的路由不必因为agent重启而重新获取
+        lb->version = mods[i].second;
+        lb->markPulling();
+        _warmMods.push_back(key);
+    }
+    ::pthread_mutex_unlock(&_mutex);
+    if (!_warmMods.empty())
+        log_info("RouteLB %d warm started %lu mods from %s", _id, _warmMods.size(), path);
+}
+
+void RouteLB::pullWarm(elb::GetRouteBatchReq& req)
+{
+    lock();
+    for (size_t i = 0;i < _warmMods.size(); ++i)
+    {
+        RouteMapIt it = _routeMap.find(_warmMods[i]);
+        if (it == _routeMap.end())
+            continue;
+        it->second->markPulling();
+        elb::GetRouteReq* pullReq = req.add_reqs();
+        pullReq->set_modid((int)(_warmMods[i] >> 32));
+        pullReq->set_cmdid((int)(_warmMods[i] & 0xffffffff));
+    }
+    _warmMods.clear();
+    ::pthread_mutex_unlock(&_mutex);
+}
+
+void RouteLB::getModStats(std::vector<ModStat>& mods)
+{
+    lock();
+    for (RouteMapIt it = _routeMap.begin();it != _routeMap.end(); ++it)
+    {
+        ModStat mod;
+        mod.modid = (int)(it->first >> 32);
+        mod.cmdid = (int)(it->first & 0xffffffff);
+        mod.overloads = it->second->ovldCnt;
+        mod.downs = it->second->downCnt();
+        mod.succCostSum = it->second->succCostSum;
+        mod.succCostCnt = it->second->succCostCnt;
+        mods.push_back(mod);
+    }
+    ::pthread_mutex_unlock(&_mutex);
+}
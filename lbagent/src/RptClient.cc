@@ -2,6 +2,7 @@
 #include <queue>
 #include "elb.pb.h"
 #include "Server.h"
+#include "AgentStats.h"
 #include <pthread.h>
 #include "easy_reactor.h"
 
@@ -10,6 +11,8 @@ static void newReportReq(event_loop* loop, int fd, void *args)
     tcp_client* cli = (tcp_client*)args;
     std::queue<elb::ReportStatusReq> msgs;
     reptQueue->recv_msg(msgs);
+    ThreadStats* stats = myStats();
+    statAdd(stats->reptDeq, msgs.size());
     while (!msgs.empty())
     {
         elb::ReportStatusReq req = msgs.front();
@@ -17,6 +20,8 @@ static void newReportReq(event_loop* loop, int fd, void *args)
         std::string reqStr;
         req.SerializeToString(&reqStr);
         cli->send_data(reqStr.c_str(), reqStr.size(), elb::ReportStatusReqId);//发送消息
+        statAdd(stats->rptReqs);
+        statAdd(stats->rptResults, req.results_size());
     }
 }
 
@@ -24,6 +29,7 @@ static void* initRptCliIns(void* args)
 {
     const char* rptIp = config_reader::ins()->GetString("reporter", "ip", "").c_str();
     short rptPort = config_reader::ins()->GetNumber("reporter", "port", 0);
+    bindStats(STAT_RPT);
     event_loop loop;
     tcp_client client(&loop, rptIp, rptPort, "reporter");//创建TCP客户端
     //loop install message queue's messge coming event
@@ -3,6 +3,7 @@
 #include "elb.pb.h"
 #include "Server.h"
 #include "HeartBeat.h"
+#include "AgentStats.h"
 #include <pthread.h>
 #include "easy_reactor.h"
 
@@ -18,6 +19,12 @@ static void recordTs(event_loop* loop, void* usrData)
     hb->recordTs();
 }
 
+//timeout event 2: dump agent stats to [stats] dump_file
+static void dumpStatsTimer(event_loop* loop, void* usrData)
+{
+    dumpStatsFile();
+}
+
 int main(int argc, const char** argv)
 {
     if (argc != 2)
@@ -28,6 +35,7 @@ int main(int argc, const char** argv)
     dispLogo();
     
     config_reader::setPath(argv[1]);
+    initStats();
 
     for (int i = 0;i < 3; ++i)
     {
@@ -44,6 +52,10 @@ int main(int argc, const char** argv)
     int log_level = config_reader::ins()->GetNumber("log", "level", 3);
     _set_log_level_(log_level);
 
+    //用上次落地的路由预热，agent重启后模块立即可用，与dnsserver连接后再批量刷新
+    for (int i = 0;i < 3; ++i)
+        routeLB[i]->loadBackup();
+
     pullQueue = new thread_queue<elb::GetRouteReq>();
     if (!pullQueue)
     {
@@ -67,6 +79,10 @@ int main(int argc, const char** argv)
     //install timeout event 1: record current time in shared memory, 1 second 1 do
     HeartBeat hb(true);
     mainLoop.run_every(recordTs, &hb, 1);
+    //install timeout event 2: dump agent stats to file, every [stats] dump_interval seconds
+    int dumpInterval = config_reader::ins()->GetNumber("stats", "dump_interval", 10);
+    if (!config_reader::ins()->GetString("stats", "dump_file", "").empty() && dumpInterval > 0)
+        mainLoop.run_every(dumpStatsTimer, NULL, dumpInterval);
     //init connector who connects to dns server, and run in loop [main thread]
     dssConnectorDomain(mainLoop);
     return 0;
@@ -0,0 +1,73 @@
+#include "TimerWheel.h"
+
+TimerWheel::TimerWheel(long now): _now(now)
+{
+    for (int i = 0;i < LEVELS; ++i)
+        for (int j = 0;j < SLOTS; ++j)
+            initList(_slots[i][j]);
+}
+
+void TimerWheel::append(WheelNode& list, WheelNode* node)
+{
+    node->prev = list.prev;
+    node->next = &list;
+    list.prev->next = node;
+    list.prev = node;
+}
+
+void TimerWheel::add(WheelNode* node, long expire)
+{
+    node->unlink();
+    //当前时刻的槽已经处理过了，不晚于当前时刻的定时器放到下一秒
+    node->expire = expire > _now? expire: _now + 1;
+    place(node);
+}
+
+void TimerWheel::place(WheelNode* node)
+{
+    long delta = node->expire - _now;
+    long slotTs = node->expire;
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (1L << (SLOT_BITS * (level + 1))))
+        ++level;
+    //超出最高层覆盖范围的，先挂在最高层最远的槽上，下移时会重新计算位置
+    long span = 1L << (SLOT_BITS * LEVELS);
+    if (delta >= span)
+        slotTs = _now + span - 1;
+    int idx = (slotTs >> (SLOT_BITS * level)) & SLOT_MASK;
+    append(_slots[level][idx], node);
+}
+
+void TimerWheel::cascade(int level)
+{
+    WheelNode& list = _slots[level][(_now >> (SLOT_BITS * level)) & SLOT_MASK];
+    while (list.next != &list)
+    {
+        WheelNode* node = list.next;
+        node->unlink();
+        place(node);
+    }
+}
+
+void TimerWheel::advance(long now, WheelNode& expired)
+{
+    initList(expired);
+    while (_now < now)
+    {
+        ++_now;
+        //进入高层的新一格时，把那一格的定时器下移到低层；须从高层往低层下移，
+        //否则从高层下移到低层当前格的定时器会错过本轮
+        int top = 0;
+        while (top + 1 < LEVELS && !(_now & ((1L << (SLOT_BITS * (top + 1))) - 1)))
+            ++top;
+        for (int level = top;level > 0; --level)
+            cascade(level);
+        WheelNode& list = _slots[0][_now & SLOT_MASK];
+        while (list.next != &list)
+        {
+            WheelNode* node = list.next;
+            node->unlink();
+            append(expired, node);
+        }
+    }
+}
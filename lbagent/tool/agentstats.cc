@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include "elb.pb.h"
+#include "easy_reactor.h"
+
+static void usage()
+{
+    printf("./agentstats [port(8888~8890)]\n");
+    printf("./agentstats -t port(dnsserver 12315, reporter 12316)\n");
+    exit(1);
+}
+
+static int connectLocal(int type, int proto, int port)
+{
+    int fd = ::socket(AF_INET, type | SOCK_CLOEXEC, proto);
+    if (fd == -1)
+    {
+        perror("socket");
+        exit(1);
+    }
+    struct sockaddr_in servaddr;
+    ::memset(&servaddr, 0, sizeof servaddr);
+    servaddr.sin_family = AF_INET;
+    servaddr.sin_port = htons(port);
+    ::inet_aton("127.0.0.1", &servaddr.sin_addr);
+    if (::connect(fd, (const struct sockaddr*)&servaddr, sizeof servaddr) == -1)
+    {
+        perror("connect");
+        exit(1);
+    }
+    struct timeval tv;
+    tv.tv_sec = 1;
+    tv.tv_usec = 0;
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return fd;
+}
+
+static void sendReq(int fd, int cmdid)
+{
+    commu_head head;
+    head.cmdid = cmdid;
+    head.length = 0;
+    if (::send(fd, &head, COMMU_HEAD_LENGTH, 0) == -1)
+    {
+        perror("send");
+        exit(1);
+    }
+}
+
+//TCP上读满len字节
+static void recvAll(int fd, char* buf, int len)
+{
+    int got = 0;
+    while (got < len)
+    {
+        int n = ::recv(fd, buf + got, len - got, 0);
+        if (n <= 0)
+        {
+            if (n == 0)
+                fprintf(stderr, "connection closed by peer\n");
+            else
+                perror("recv");
+            exit(1);
+        }
+        got += n;
+    }
+}
+
+//向本机agent获取运行指标，输出Prometheus文本格式
+//三个UDP线程共享同一份指标，向任一端口获取即可
+//-t：经TCP向本机dnsserver或reporter获取，它们只应答本机连接
+int main(int argc, char const *argv[])
+{
+    static char rbuf[COMMU_HEAD_LENGTH + MSG_LENGTH_LIMIT];
+    commu_head head;
+    int bodyLen = 0;
+
+    if (argc > 1 && !strcmp(argv[1], "-t"))
+    {
+        int port = argc > 2? atoi(argv[2]): 0;
+        if (port <= 0 || port > 65535)
+            usage();
+        int fd = connectLocal(SOCK_STREAM, IPPROTO_TCP, port);
+        sendReq(fd, elb::ServerStatsReqId);
+        recvAll(fd, rbuf, COMMU_HEAD_LENGTH);
+        ::memcpy(&head, rbuf, COMMU_HEAD_LENGTH);
+        if (head.cmdid != elb::ServerStatsRspId || head.length < 0 || head.length > MSG_LENGTH_LIMIT)
+        {
+            fprintf(stderr, "unexpected message id %d length %d\n", head.cmdid, head.length);
+            exit(1);
+        }
+        bodyLen = head.length;
+        recvAll(fd, rbuf + COMMU_HEAD_LENGTH, bodyLen);
+        ::close(fd);
+    }
+    else
+    {
+        int port = argc > 1? atoi(argv[1]): 8888;
+        if (port < 8888 || port > 8890)
+            usage();
+        int fd = connectLocal(SOCK_DGRAM, IPPROTO_UDP, port);
+        sendReq(fd, elb::AgentStatsReqId);
+        int pkgLen = ::recv(fd, rbuf, sizeof rbuf, 0);
+        if (pkgLen < COMMU_HEAD_LENGTH)
+        {
+            perror("recv");
+            exit(1);
+        }
+        ::memcpy(&head, rbuf, COMMU_HEAD_LENGTH);
+        if (head.cmdid != elb::AgentStatsRspId)
+        {
+            fprintf(stderr, "unexpected message id %d\n", head.cmdid);
+            exit(1);
+        }
+        bodyLen = pkgLen - COMMU_HEAD_LENGTH;
+        ::close(fd);
+    }
+    ::fwrite(rbuf + COMMU_HEAD_LENGTH, 1, bodyLen, stdout);
+    return 0;
+}
@@ -7,7 +7,8 @@
 class CallStatis
 {
 public:
-    CallStatis();
+    //worker: 写MySQL线程的序号，用于记录运行指标
+    CallStatis(int worker);
     //no need to implement destructor
     //~CallStatis();
     void report(elb::ReportStatusReq& req);
@@ -16,6 +17,7 @@ public:
     static void libraryInit() { mysql_library_init(0, NULL, NULL); }
 private:
     MYSQL _dbConn;
+    int _worker;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef __RPT_STATS_H__
+#define __RPT_STATS_H__
+
+#include <string>
+#include <stdint.h>
+#include "statsBase.h"
+
+//reporter的运行指标（见common/base/include/statsBase.h），经ServerStatsReqId消息以Prometheus文本导出
+
+#define RPT_STAT_SLOTS 64  //reactor线程池的线程数上限，超出的线程共用最后一个槽
+#define RPT_STAT_WORKERS 64//写MySQL线程（[mysql] thread_cnt）的个数上限，超出的线程共用最后一个
+
+//reactor各线程（reportStatus分发）的指标，线程首次处理消息时领取
+struct __attribute__((aligned(64))) RptDispatchStats
+{
+    uint64_t reqs;                  //ReportStatusReqId
+    uint64_t results;               //请求中的调用结果条数
+    uint64_t decodeErrs;
+    uint64_t enq[RPT_STAT_WORKERS]; //分发给各写MySQL线程的请求数
+};
+
+//写MySQL线程的指标，按线程序号
+struct __attribute__((aligned(64))) RptWorkerStats
+{
+    uint64_t deq;      //从队列取出的请求数，与各分发线程的enq之和相减即为队列深度
+    uint64_t rows;     //执行的INSERT条数
+    uint64_t rowErrs;  //其中执行失败的
+    StatHist mysqlUs;  //一条INSERT的耗时
+    StatHist reqUs;    //一个请求（所有调用结果）的耗时
+};
+
+extern StatSlots<RptDispatchStats, RPT_STAT_SLOTS> dispatchStats;
+extern RptWorkerStats workerStats[RPT_STAT_WORKERS];
+
+static inline RptWorkerStats* workerStat(int worker)
+{
+    return &workerStats[worker < RPT_STAT_WORKERS? worker: RPT_STAT_WORKERS - 1];
+}
+
+//导出为Prometheus文本格式；limit > 0时截断到limit字节以内
+void dumpStats(std::string& text, size_t limit = 0);
+
+#endif
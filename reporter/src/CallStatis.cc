@@ -1,4 +1,6 @@
 #include "log.h"
+#include "Server.h"
+#include "RptStats.h"
 #include "CallStatis.h"
 #include "easy_reactor.h"
 #include "config_reader.h"
@@ -8,7 +10,7 @@
 #include <unistd.h>
 #include <string.h>
 
-CallStatis::CallStatis()
+CallStatis::CallStatis(int worker): _worker(worker)
 {
     //connection DBconn
     const char* dbHost   = config_reader::ins()->GetString("mysql", "db_host", "127.0.0.1").c_str();
@@ -33,6 +35,8 @@ CallStatis::CallStatis()
 
 void CallStatis::report(elb::ReportStatusReq& req)
 {
+    RptWorkerStats* stats = workerStat(_worker);
+    uint64_t startUs = statNowUs();
     for (int i = 0;i < req.results_size(); ++i)
     {
         const elb::HostCallResult& result = req.results(i);
@@ -46,25 +50,32 @@ void CallStatis::report(elb::ReportStatusReq& req)
             result.succ(), result.err(), req.ts(), overload,
             result.succ(), result.err(), req.ts(), overload);
 
+        uint64_t queryUs = statNowUs();
         mysql_ping(&_dbConn);//if close down, auto reconnect
         int ret = mysql_real_query(&_dbConn, sql, strlen(sql));
+        stats->mysqlUs.record(statNowUs() - queryUs);
+        statAdd(stats->rows);
         if (ret)
         {
             log_error("Failed to find any records and caused an error: %s\n", mysql_error(&_dbConn));
+            statAdd(stats->rowErrs);
         }
     }
+    stats->reqUs.record(statNowUs() - startUs);
 }
 
 struct Args
 {
     thread_queue<elb::ReportStatusReq>* arg1;
     CallStatis* arg2;
+    int worker;
 };
 
 static void newReportReq(event_loop* loop, int fd, void *args)
 {
     thread_queue<elb::ReportStatusReq>* rptQueue = ((Args*)args)->arg1;
     CallStatis* callStat = ((Args*)args)->arg2;
+    RptWorkerStats* stats = workerStat(((Args*)args)->worker);
 
     std::queue<elb::ReportStatusReq> msgs;
     rptQueue->recv_msg(msgs);
@@ -72,6 +83,7 @@ static void newReportReq(event_loop* loop, int fd, void *args)
     {
         elb::ReportStatusReq req = msgs.front();
         msgs.pop();
+        statAdd(stats->deq);
         callStat->report(req);
     }
 }
@@ -79,13 +91,18 @@ static void newReportReq(event_loop* loop, int fd, void *args)
 void* report2MySql(void* args)
 {
     thread_queue<elb::ReportStatusReq>* rptQueue = (thread_queue<elb::ReportStatusReq>*)args;
+    //线程序号即队列在rptQueues中的下标
+    int worker = 0;
+    while (worker < threadCnt && rptQueues[worker] != rptQueue)
+        ++worker;
 
-    CallStatis callStat;
+    CallStatis callStat(worker);
     event_loop loop;
     //loop install message queue's messge coming event
     Args cbArgs;
     cbArgs.arg1 = rptQueue;
     cbArgs.arg2 = &callStat;
+    cbArgs.worker = worker;
     rptQueue->set_loop(&loop, newReportReq, &cbArgs);
     //run loop
     loop.process_evs();
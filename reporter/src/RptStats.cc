@@ -0,0 +1,67 @@
+#include <stdio.h>
+#include <string.h>
+#include "log.h"
+#include "Server.h"
+#include "RptStats.h"
+
+StatSlots<RptDispatchStats, RPT_STAT_SLOTS> dispatchStats;
+RptWorkerStats workerStats[RPT_STAT_WORKERS];
+
+//reactor每个线程一行的计数器
+static void appendPerThread(StatText& out, const char* name, const char* help, uint64_t RptDispatchStats::*field)
+{
+    out.head(name, "counter", help);
+    for (int t = 0;t < dispatchStats.used(); ++t)
+        out.line("%s{thread=\"%d\"} %lu\n", name, t, (unsigned long)statLoad(dispatchStats.at(t).*field));
+}
+
+void dumpStats(std::string& text, size_t limit)
+{
+    text.clear();
+    StatText out(text);
+    int workers = threadCnt < RPT_STAT_WORKERS? threadCnt: RPT_STAT_WORKERS;
+
+    appendPerThread(out, "elb_reporter_requests_total", "ReportStatus requests", &RptDispatchStats::reqs);
+    appendPerThread(out, "elb_reporter_results_total", "Host call results in those requests", &RptDispatchStats::results);
+    appendPerThread(out, "elb_reporter_decode_errors_total", "Requests that failed to decode", &RptDispatchStats::decodeErrs);
+    out.head("elb_reporter_log_dropped_total", "counter", "Log messages dropped because a log buffer was full");
+    out.line("elb_reporter_log_dropped_total %lu\n", _log_dropped_());
+
+    //生产者、消费者各自计数，读到的两个值不是同一时刻的，差值可能短暂为负
+    out.head("elb_reporter_queue_depth", "gauge", "Requests waiting for a MySQL worker");
+    for (int w = 0;w < workers; ++w)
+    {
+        uint64_t enq = 0, deq = statLoad(workerStats[w].deq);
+        for (int t = 0;t < dispatchStats.used(); ++t)
+            enq += statLoad(dispatchStats.at(t).enq[w]);
+        out.line("elb_reporter_queue_depth{worker=\"%d\"} %lu\n", w, (unsigned long)(enq > deq? enq - deq: 0));
+    }
+
+    out.head("elb_reporter_worker_requests_total", "counter", "Requests written by a MySQL worker");
+    for (int w = 0;w < workers; ++w)
+        out.line("elb_reporter_worker_requests_total{worker=\"%d\"} %lu\n", w, (unsigned long)statLoad(workerStats[w].deq));
+    out.head("elb_reporter_rows_total", "counter", "INSERTs executed by a MySQL worker");
+    for (int w = 0;w < workers; ++w)
+        out.line("elb_reporter_rows_total{worker=\"%d\"} %lu\n", w, (unsigned long)statLoad(workerStats[w].rows));
+    out.head("elb_reporter_row_errors_total", "counter", "INSERTs that failed");
+    for (int w = 0;w < workers; ++w)
+        out.line("elb_reporter_row_errors_total{worker=\"%d\"} %lu\n", w, (unsigned long)statLoad(workerStats[w].rowErrs));
+
+    out.head("elb_reporter_mysql_seconds", "histogram", "Time spent on one INSERT");
+    for (int w = 0;w < workers; ++w)
+    {
+        char labels[32];
+        snprintf(labels, sizeof labels, "worker=\"%d\"", w);
+        out.hist("elb_reporter_mysql_seconds", labels, workerStats[w].mysqlUs);
+    }
+    out.head("elb_reporter_request_seconds", "histogram", "Time spent writing all results of one request");
+    for (int w = 0;w < workers; ++w)
+    {
+        char labels[32];
+        snprintf(labels, sizeof labels, "worker=\"%d\"", w);
+        out.hist("elb_reporter_request_seconds", labels, workerStats[w].reqUs);
+    }
+
+    if (limit)
+        out.truncate(limit);
+}
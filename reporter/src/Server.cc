@@ -6,6 +6,7 @@
 #include "util.h"
 #include "Server.h"
 #include "elb.pb.h"
+#include "RptStats.h"
 #include "CallStatis.h"
 #include "easy_reactor.h"
 
@@ -15,20 +16,38 @@ thread_queue<elb::ReportStatusReq>** rptQueues = NULL;
 void reportStatus(const char* data, uint32_t len, int msgid, net_commu* commu, void* usr_data)
 {
     elb::ReportStatusReq req;
+    RptDispatchStats* stats = dispatchStats.mine();
     req.ParseFromArray(data, len);//解包，data[0:len)保证是一个完整包
 
     if (!req.ParseFromArray(data, len))
     {
         log_error("request decode error");
+        statAdd(stats->decodeErrs);
         return ;
     }
     int modid = req.modid();
     int cmdid = req.cmdid();
     uint64_t key = ((uint64_t)modid<<32) + cmdid;
     int index = HASHTO(&key, threadCnt);
+    statAdd(stats->reqs);
+    statAdd(stats->results, req.results_size());
+    statAdd(stats->enq[index < RPT_STAT_WORKERS? index: RPT_STAT_WORKERS - 1]);
     rptQueues[index]->send_msg(req);
 }
 
+//导出运行指标，只回复本机的连接
+void serverStats(const char* data, uint32_t len, int msgid, net_commu* commu, void* usr_data)
+{
+    if (!statPeerLocal(commu->get_fd()))
+    {
+        log_error("stats request from non-local peer, fd %d", commu->get_fd());
+        return ;
+    }
+    std::string text;
+    dumpStats(text, MSG_LENGTH_LIMIT);
+    commu->send_data(text.c_str(), text.size(), elb::ServerStatsRspId);
+}
+
 int main()
 {
     event_loop loop;
@@ -41,6 +60,7 @@ int main()
 
     tcp_server server(&loop, ip.c_str(), port);//创建TCP服务器
     server.add_msg_cb(elb::ReportStatusReqId, reportStatus);//设置：当收到消息id = ReportStatusReqId （即上报调用结果）的消息调用的回调函数
+    server.add_msg_cb(elb::ServerStatsReqId, serverStats);//设置：当收到消息id = ServerStatsReqId （即查询运行指标，仅限本机）的消息调用的回调函数
 
     _init_log_("reporter", ".");
     int log_level = config_reader::ins()->GetNumber("log", "level", 3);